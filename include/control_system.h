@@ -6,6 +6,8 @@
 #pragma once
 #include <Arduino.h>
 #include "motor.h"
+#include "control_tuning.h"
+#include "profiler.h"
 
 Motor driverX(3, 4, 5, 6);
 Motor driverY(7, 8, 9, 10);
@@ -20,15 +22,11 @@ AxisState stateY = SEEKING;
 class ControlSystem
 {
 private:
-    const float Kp_X = 20.0; // Proportional gain for X-axis motor
-    const float Kp_Y = 10;   // Proportional gain for Y-axis motor
+    ControlTuning tuning; // gains, speeds and dead zone, see control_tuning.h
 
     Motor &motorX = driverX;
     Motor &motorY = driverY;
 
-    const uint8_t MAX_MOTOR_SPEED = 180;
-    const uint8_t MIN_MOTOR_SPEED = 75;
-    const float DEAD_ZONE_DEGREES = 0.1;
 
     AxisState manualStateX = SEEKING;
     AxisState manualStateY = SEEKING;
@@ -93,14 +91,18 @@ public:
 
     void runX(float target, float current)
     {
-        pControl(target, current, Kp_X, DEAD_ZONE_DEGREES, motorX, manualStateX, lastTargetX, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
+        PROFILE_SCOPE(PROBE_CONTROL);
+        pControl(target, current, tuning.kpX, tuning.deadZone, motorX, manualStateX, lastTargetX, tuning.minSpeed, tuning.maxSpeed);
     }
 
     void runY(float target, float current)
     {
-        pControl(target, current, Kp_Y, DEAD_ZONE_DEGREES, motorY, manualStateY, lastTargetY, MIN_MOTOR_SPEED, MAX_MOTOR_SPEED);
+        PROFILE_SCOPE(PROBE_CONTROL);
+        pControl(target, current, tuning.kpY, tuning.deadZone, motorY, manualStateY, lastTargetY, tuning.minSpeed, tuning.maxSpeed);
     }
 
+    ControlTuning &getTuning() { return tuning; }
+
     void runManual(float axisX, float axisY, float angleMain, float angleSecond);
     void runAutomatic(float centerVectorX, float centerVectorY);
     void runThreshold(float valueX, float valueY, float threshold);
@@ -119,6 +121,7 @@ ControlSystem::~ControlSystem() {}
 
 void ControlSystem::runManual(float axisX, float axisY, float angleMain, float angleSecond)
 {
+    PROFILE_SCOPE(PROBE_CONTROL);
     float errorX = axisX - angleMain;
     float errorY = axisY - angleSecond;
 
@@ -138,32 +141,32 @@ void ControlSystem::runManual(float axisX, float axisY, float angleMain, float a
     switch (manualStateX)
     {
     case SEEKING:
-        if (abs(errorX) <= DEAD_ZONE_DEGREES)
+        if (abs(errorX) <= tuning.deadZone)
         {
             motorX.stop();
             manualStateX = HOLDING;
         }
         else
         {
-            int motorSpeedX = static_cast<int>(Kp_X * errorX);
-            motorSpeedX = constrain(motorSpeedX, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+            int motorSpeedX = static_cast<int>(tuning.kpX * errorX);
+            motorSpeedX = constrain(motorSpeedX, -tuning.maxSpeed, tuning.maxSpeed);
 
             if (motorSpeedX > 0)
             {
-                if (motorSpeedX < MIN_MOTOR_SPEED)
-                    motorSpeedX = MIN_MOTOR_SPEED;
+                if (motorSpeedX < tuning.minSpeed)
+                    motorSpeedX = tuning.minSpeed;
                 motorX.turnRight(motorSpeedX);
             }
             else if (motorSpeedX < 0)
             {
-                if (abs(motorSpeedX) < MIN_MOTOR_SPEED)
-                    motorSpeedX = -MIN_MOTOR_SPEED;
+                if (abs(motorSpeedX) < tuning.minSpeed)
+                    motorSpeedX = -tuning.minSpeed;
                 motorX.turnLeft(abs(motorSpeedX));
             }
         }
         break;
     case HOLDING:
-        if (abs(errorX) > DEAD_ZONE_DEGREES + 0.2)
+        if (abs(errorX) > tuning.deadZone + 0.2)
         {
             manualStateX = SEEKING;
         }
@@ -178,32 +181,32 @@ void ControlSystem::runManual(float axisX, float axisY, float angleMain, float a
     switch (manualStateY)
     {
     case SEEKING:
-        if (abs(errorY) <= DEAD_ZONE_DEGREES)
+        if (abs(errorY) <= tuning.deadZone)
         {
             motorY.stop();
             manualStateY = HOLDING;
         }
         else
         {
-            int motorSpeedY = static_cast<int>(Kp_Y * errorY);
-            motorSpeedY = constrain(motorSpeedY, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+            int motorSpeedY = static_cast<int>(tuning.kpY * errorY);
+            motorSpeedY = constrain(motorSpeedY, -tuning.maxSpeed, tuning.maxSpeed);
 
             if (motorSpeedY > 0)
             {
-                if (motorSpeedY < MIN_MOTOR_SPEED)
-                    motorSpeedY = MIN_MOTOR_SPEED;
+                if (motorSpeedY < tuning.minSpeed)
+                    motorSpeedY = tuning.minSpeed;
                 motorY.turnRight(motorSpeedY);
             }
             else if (motorSpeedY < 0)
             {
-                if (abs(motorSpeedY) < MIN_MOTOR_SPEED)
-                    motorSpeedY = -MIN_MOTOR_SPEED;
+                if (abs(motorSpeedY) < tuning.minSpeed)
+                    motorSpeedY = -tuning.minSpeed;
                 motorY.turnLeft(abs(motorSpeedY));
             }
         }
         break;
     case HOLDING:
-        if (abs(errorY) > DEAD_ZONE_DEGREES + 0.2)
+        if (abs(errorY) > tuning.deadZone + 0.2)
         {
             manualStateY = SEEKING;
         }
@@ -217,6 +220,7 @@ void ControlSystem::runManual(float axisX, float axisY, float angleMain, float a
 
 void ControlSystem::runAutomatic(float diffMain, float diffSecond)
 {
+    PROFILE_SCOPE(PROBE_CONTROL);
     static AxisState stateX = SEEKING;
     static AxisState stateY = SEEKING;
 
@@ -228,8 +232,8 @@ void ControlSystem::runAutomatic(float diffMain, float diffSecond)
     int controlX = static_cast<int>(Kp_AX * diffMain);
     int controlY = static_cast<int>(Kp_AY * diffSecond);
 
-    controlX = constrain(controlX, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
-    controlY = constrain(controlY, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+    controlX = constrain(controlX, -tuning.maxSpeed, tuning.maxSpeed);
+    controlY = constrain(controlY, -tuning.maxSpeed, tuning.maxSpeed);
 
     // --- X Axis ---
     switch (stateX)
@@ -244,14 +248,14 @@ void ControlSystem::runAutomatic(float diffMain, float diffSecond)
         {
             if (controlX > 0)
             {
-                if (controlX < MIN_MOTOR_SPEED)
-                    controlX = MIN_MOTOR_SPEED;
+                if (controlX < tuning.minSpeed)
+                    controlX = tuning.minSpeed;
                 motorX.turnRight(controlX);
             }
             else if (controlX < 0)
             {
-                if (abs(controlX) < MIN_MOTOR_SPEED)
-                    controlX = -MIN_MOTOR_SPEED;
+                if (abs(controlX) < tuning.minSpeed)
+                    controlX = -tuning.minSpeed;
                 motorX.turnLeft(abs(controlX));
             }
         }
@@ -278,14 +282,14 @@ void ControlSystem::runAutomatic(float diffMain, float diffSecond)
         {
             if (controlY > 0)
             {
-                if (controlY < MIN_MOTOR_SPEED)
-                    controlY = MIN_MOTOR_SPEED;
+                if (controlY < tuning.minSpeed)
+                    controlY = tuning.minSpeed;
                 motorY.turnRight(controlY);
             }
             else if (controlY < 0)
             {
-                if (abs(controlY) < MIN_MOTOR_SPEED)
-                    controlY = -MIN_MOTOR_SPEED;
+                if (abs(controlY) < tuning.minSpeed)
+                    controlY = -tuning.minSpeed;
                 motorY.turnLeft(abs(controlY));
             }
         }
@@ -333,6 +337,7 @@ void ControlSystem::cloudyStrategy(uint32_t nowMilis, byte seeker1, byte seeker2
 
 void ControlSystem::runThreshold(float valueX, float valueY, float threshold)
 {
+    PROFILE_SCOPE(PROBE_CONTROL);
     // --- X Axis Control ---
     if (valueX > threshold)
     {
@@ -370,6 +375,7 @@ void ControlSystem::stop()
 
 void ControlSystem::runRuleBased(int top, int bottom, int left, int right)
 {
+    PROFILE_SCOPE(PROBE_CONTROL);
     const int THRESHOLD = 100; // contoh, sesuaikan dengan kondisi cahaya
     const int SPEED = 80;      // kecepatan default gerak
 
@@ -489,16 +495,16 @@ bool ControlSystem::runFallBackStrategy(byte currentLeft, byte currentRight, byt
     if (!current1Close)
     {
         if (currentLeft > refLeft)
-            motorX.turnRight(MAX_MOTOR_SPEED);
+            motorX.turnRight(tuning.maxSpeed);
         else
-            motorX.turnLeft(MAX_MOTOR_SPEED);
+            motorX.turnLeft(tuning.maxSpeed);
     }
     else if (!current2Close)
     {
         if (currentRight > refRight)
-            motorX.turnRight(MAX_MOTOR_SPEED / 1.5);
+            motorX.turnRight(tuning.maxSpeed / 1.5);
         else
-            motorX.turnLeft(MAX_MOTOR_SPEED / 1.5);
+            motorX.turnLeft(tuning.maxSpeed / 1.5);
     }
     return false;
 }
\ No newline at end of file
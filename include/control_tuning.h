@@ -0,0 +1,201 @@
+#pragma once
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stddef.h>
+#include "eeprom_layout.h"
+#include "crc8.h"
+#include "eeprom_writer.h"
+
+/**
+ * @brief Control loop constants that can be changed at run time.
+ */
+struct ControlTuning
+{
+    float kpX = 20.0;       // proportional gain, X axis
+    float kpY = 10;         // proportional gain, Y axis
+    float deadZone = 0.1;   // deg, error at which an axis stops and holds
+    float minSpeed = 75;    // PWM, below this the motor stalls
+    float maxSpeed = 180;   // PWM
+    float trackWindow = 10; // deg, outside this the P loop drives, inside it the LDRs fine tune
+    float ldrBalance = 0.9; // min/max LDR ratio below which the fine correction steps
+    float ldrStep = 0.25;   // deg per fine correction step
+};
+
+/**
+ * @brief Named, range-checked access to a ControlTuning by parameter id, and its
+ * EEPROM record. Names and limits live in flash.
+ */
+class TuningTable
+{
+public:
+    static const uint8_t NAME_LENGTH = 15;
+
+    TuningTable(ControlTuning &tuning);
+    ~TuningTable();
+
+    /**
+     * @brief Load the saved tuning.
+     * @return false if no valid record was found and the defaults are in use.
+     */
+    bool begin();
+
+    /**
+     * @brief Queue the current tuning for writing in the background.
+     * @return false if the writer has no room; try again later.
+     */
+    bool save(EepromWriter &writer);
+    void defaults() { _tuning = ControlTuning(); }
+
+    uint8_t count() const;
+
+    /**
+     * @return false for an unknown id.
+     */
+    bool get(uint8_t id, float &value) const;
+
+    /**
+     * @brief Set a parameter, clamped to its range and to the parameters it depends
+     * on: min_speed never above max_speed, and the other way round.
+     * @return false for an unknown id or a NaN.
+     */
+    bool set(uint8_t id, float value);
+
+    /**
+     * @param name Receives the name, NUL terminated, at least NAME_LENGTH + 1 bytes.
+     */
+    bool describe(uint8_t id, char *name, float &min, float &max) const;
+
+private:
+    static const uint8_t VERSION = 1;
+
+    struct Param
+    {
+        char name[NAME_LENGTH + 1];
+        uint8_t offset; // into ControlTuning
+        float min;
+        float max;
+    };
+    static const Param PARAMS[];
+
+    // Bytes rather than the struct, so no padding lands in the record on any target
+    struct Record
+    {
+        uint8_t version;
+        uint8_t tuning[sizeof(ControlTuning)];
+        uint8_t crc;
+    };
+
+    ControlTuning &_tuning;
+
+    float *field(uint8_t offset) const { return (float *)((uint8_t *)&_tuning + offset); }
+    bool param(uint8_t id, Param &p) const;
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+const TuningTable::Param TuningTable::PARAMS[] PROGMEM = {
+    {"kp_x", offsetof(ControlTuning, kpX), 0, 200},
+    {"kp_y", offsetof(ControlTuning, kpY), 0, 200},
+    {"dead_zone", offsetof(ControlTuning, deadZone), 0, 5},
+    {"min_speed", offsetof(ControlTuning, minSpeed), 0, 255},
+    {"max_speed", offsetof(ControlTuning, maxSpeed), 0, 255},
+    {"track_window", offsetof(ControlTuning, trackWindow), 0, 45},
+    {"ldr_balance", offsetof(ControlTuning, ldrBalance), 0, 1},
+    {"ldr_step", offsetof(ControlTuning, ldrStep), 0, 5},
+};
+
+TuningTable::TuningTable(ControlTuning &tuning) : _tuning(tuning) {}
+
+TuningTable::~TuningTable() {}
+
+uint8_t TuningTable::count() const
+{
+    return sizeof(PARAMS) / sizeof(PARAMS[0]);
+}
+
+bool TuningTable::param(uint8_t id, Param &p) const
+{
+    if (id >= count())
+        return false;
+    memcpy_P(&p, &PARAMS[id], sizeof(Param));
+    return true;
+}
+
+bool TuningTable::begin()
+{
+    Record r;
+    EEPROM.get(EEPROM_TUNING_ADDR, r);
+    if (r.version != VERSION || crc8((const uint8_t *)&r, sizeof(r) - 1) != r.crc)
+    {
+        defaults();
+        return false;
+    }
+
+    memcpy(&_tuning, r.tuning, sizeof(_tuning));
+    for (uint8_t id = 0; id < count(); id++)
+    {
+        Param p;
+        param(id, p);
+        float value = *field(p.offset);
+        if (isnan(value) || value < p.min || value > p.max)
+        {
+            defaults();
+            return false;
+        }
+    }
+    if (_tuning.minSpeed > _tuning.maxSpeed)
+    {
+        defaults();
+        return false;
+    }
+    return true;
+}
+
+bool TuningTable::save(EepromWriter &writer)
+{
+    Record r;
+    r.version = VERSION;
+    memcpy(r.tuning, &_tuning, sizeof(_tuning));
+    r.crc = crc8((const uint8_t *)&r, sizeof(r) - 1);
+    return writer.write(EEPROM_TUNING_ADDR, &r, sizeof(r));
+}
+
+bool TuningTable::get(uint8_t id, float &value) const
+{
+    Param p;
+    if (!param(id, p))
+        return false;
+    value = *field(p.offset);
+    return true;
+}
+
+bool TuningTable::set(uint8_t id, float value)
+{
+    Param p;
+    if (!param(id, p) || isnan(value))
+        return false;
+    value = constrain(value, p.min, p.max);
+
+    // A motor speed range that inverts would drive past max_speed to reach min_speed
+    if (p.offset == offsetof(ControlTuning, minSpeed))
+        value = min(value, _tuning.maxSpeed);
+    else if (p.offset == offsetof(ControlTuning, maxSpeed))
+        value = max(value, _tuning.minSpeed);
+
+    *field(p.offset) = value;
+    return true;
+}
+
+bool TuningTable::describe(uint8_t id, char *name, float &min, float &max) const
+{
+    Param p;
+    if (!param(id, p))
+        return false;
+    memcpy(name, p.name, sizeof(p.name));
+    min = p.min;
+    max = p.max;
+    return true;
+}
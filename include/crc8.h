@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief CRC-8/MAXIM (poly 0x31 reflected), bitwise so it costs no table in flash.
+ */
+static inline uint8_t crc8(const uint8_t *data, uint16_t len, uint8_t crc = 0)
+{
+    while (len--)
+    {
+        uint8_t in = *data++;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            uint8_t mix = (crc ^ in) & 0x01;
+            crc >>= 1;
+            if (mix)
+                crc ^= 0x8C;
+            in >>= 1;
+        }
+    }
+    return crc;
+}
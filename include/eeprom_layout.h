@@ -0,0 +1,15 @@
+#pragma once
+
+// EEPROM map (ATmega328: 1024 bytes). Keep regions from overlapping when adding one.
+// Bytes 0..4 held the old unversioned StateSave layout (state, selection, inEditMode,
+// xVal, yVal). StateSave converts it into the ring on the first boot and erases it to
+// 0xFF; the bytes are free once every unit has booted this firmware.
+#define EEPROM_STATE_V1_ADDR 0
+#define EEPROM_STATE_V1_SIZE 5
+#define EEPROM_IMU_CAL_ADDR 16   // ImuCalibration record, 18 bytes
+#define EEPROM_RTC_DRIFT_ADDR 40 // RtcDriftEstimator record, 14 bytes (6 in version 1)
+#define EEPROM_STATE_ADDR 64     // StateSave wear-levelled ring
+#define EEPROM_STATE_SIZE 192
+#define EEPROM_TUNING_ADDR 256    // TuningTable record, 34 bytes
+#define EEPROM_TELEMETRY_ADDR 320 // TelemetryLog ring, to the end; a multiple of 8 past the old start so records stay aligned
+#define EEPROM_TELEMETRY_SIZE 704
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "crc8.h"
+#include "eeprom_writer.h"
+
+/**
+ * @brief Wear-levelled store for one small struct: each save goes to the next slot of
+ * a ring of versioned, CRC-checked records, and load picks the newest valid one.
+ *
+ * Saving a value equal to the stored one writes nothing, and a write is queued on an
+ * EepromWriter, which skips cells that already hold the right byte. The slot and
+ * sequence only advance once the writer reports the record written; a reset in the
+ * middle of a save leaves a record with a bad CRC, so the previous one stays current.
+ * With N slots each cell sees 1/N of the writes of a fixed location.
+ */
+template <typename T>
+class EepromRing
+{
+public:
+    /**
+     * @param address First EEPROM byte of the ring.
+     * @param size Bytes reserved for the ring; as many records as fit are used.
+     * @param version Bump when T changes layout, old records are then ignored.
+     */
+    EepromRing(int address, int size, uint8_t version);
+    ~EepromRing();
+
+    /**
+     * @brief Find the newest valid record.
+     * @return false if there is none, value is then left untouched.
+     */
+    bool load(T &value);
+
+    /**
+     * @brief Queue value for the next slot, unless it equals the newest record.
+     * @return true if a write was queued; false if there was nothing to write, a
+     * previous save is still in flight or the writer is full.
+     */
+    bool save(const T &value, EepromWriter &writer);
+
+    /**
+     * @brief true from save() until the writer has written the record.
+     */
+    bool saving() const { return _pendingSlot >= 0; }
+
+    uint8_t getSlots() const { return _slots; }
+    uint16_t getSaves() const { return _saves; }
+
+private:
+    // Packed so the CRC is the last byte on any target, as it is on the AVR
+    struct __attribute__((packed)) Record
+    {
+        uint8_t version;
+        uint8_t sequence;
+        T value;
+        uint8_t crc;
+    };
+
+    int _address;
+    uint8_t _slots;
+    uint8_t _version;
+    int8_t _newest = -1; // slot of the newest valid record, -1 if none
+    uint8_t _sequence = 0;
+    T _current;
+    uint16_t _saves = 0;
+    int8_t _pendingSlot = -1; // slot being written, -1 if none
+    uint8_t _pendingSequence;
+    T _pendingValue;
+
+    int slotAddress(uint8_t slot) const { return _address + slot * (int)sizeof(Record); }
+    bool read(uint8_t slot, Record &r) const;
+    static void onWritten(void *context);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+template <typename T>
+EepromRing<T>::EepromRing(int address, int size, uint8_t version)
+    : _address(address), _slots(size / sizeof(Record)), _version(version) {}
+
+template <typename T>
+EepromRing<T>::~EepromRing() {}
+
+template <typename T>
+bool EepromRing<T>::read(uint8_t slot, Record &r) const
+{
+    EEPROM.get(slotAddress(slot), r);
+    return r.version == _version && crc8((const uint8_t *)&r, sizeof(r) - 1) == r.crc;
+}
+
+template <typename T>
+bool EepromRing<T>::load(T &value)
+{
+    _newest = -1;
+    Record r;
+    for (uint8_t slot = 0; slot < _slots; slot++)
+    {
+        if (!read(slot, r))
+            continue;
+        // Sequence numbers wrap; with fewer than 128 slots the newest is ahead of all others
+        if (_newest < 0 || (int8_t)(r.sequence - _sequence) > 0)
+        {
+            _newest = slot;
+            _sequence = r.sequence;
+            _current = r.value;
+        }
+    }
+
+    if (_newest < 0)
+        return false;
+    value = _current;
+    return true;
+}
+
+template <typename T>
+bool EepromRing<T>::save(const T &value, EepromWriter &writer)
+{
+    if (_slots == 0 || saving())
+        return false;
+    if (_newest >= 0 && memcmp(&value, &_current, sizeof(T)) == 0)
+        return false;
+
+    Record r;
+    r.version = _version;
+    r.sequence = _sequence + 1;
+    r.value = value;
+    r.crc = crc8((const uint8_t *)&r, sizeof(r) - 1);
+
+    uint8_t slot = (_newest < 0) ? 0 : (_newest + 1) % _slots;
+    if (!writer.write(slotAddress(slot), &r, sizeof(r), onWritten, this))
+        return false;
+
+    _pendingSlot = slot;
+    _pendingSequence = r.sequence;
+    _pendingValue = value;
+    return true;
+}
+
+template <typename T>
+void EepromRing<T>::onWritten(void *context)
+{
+    EepromRing<T> *ring = (EepromRing<T> *)context;
+    ring->_newest = ring->_pendingSlot;
+    ring->_sequence = ring->_pendingSequence;
+    ring->_current = ring->_pendingValue;
+    ring->_pendingSlot = -1;
+    ring->_saves++;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+
+/**
+ * @brief Called from service() once the last byte of a record has been written.
+ */
+typedef void (*EepromCallback)(void *context);
+
+/**
+ * @brief Background writer for the small EEPROM records (tuning, calibration, RTC
+ * drift, the state ring), so saving one never waits on the EEPROM from a task or a
+ * serial request.
+ *
+ * write() copies the record into a staging buffer and returns; service() then puts
+ * out one byte per call once the EEPROM is idle, skipping bytes that already hold the
+ * right value, the same way TelemetryLog trickles its ring. A 34-byte record that
+ * EEPROM.put() would spend ~115 ms on thus costs a few µs per loop pass, and the two
+ * writers take turns on eeprom_is_ready() instead of one of them blocking.
+ *
+ * Records are written in the order they were queued. Each carries its own CRC, so a
+ * reset part way through leaves a record its loader rejects.
+ */
+class EepromWriter
+{
+public:
+    static const uint8_t CAPACITY = 64; // staging bytes
+    static const uint8_t MAX_JOBS = 4;
+
+    EepromWriter();
+    ~EepromWriter();
+
+    /**
+     * @brief Queue a copy of length bytes to be written at address.
+     * @param done Optional, called with context when the record is written.
+     * @return false if there is no room; nothing is queued then.
+     */
+    bool write(int address, const void *data, uint8_t length, EepromCallback done = nullptr, void *context = nullptr);
+
+    /**
+     * @brief Write at most one byte if the EEPROM is idle. Call from loop().
+     */
+    void service();
+
+    bool busy() const { return _jobs != 0; }
+
+    /**
+     * @brief true if a record for address is queued or being written.
+     */
+    bool pending(int address) const;
+
+private:
+    struct Job
+    {
+        int address;
+        uint8_t offset; // into _buffer
+        uint8_t length;
+        EepromCallback done;
+        void *context;
+    };
+
+    uint8_t _buffer[CAPACITY];
+    uint8_t _used = 0;
+    Job _job[MAX_JOBS];
+    uint8_t _jobs = 0;
+    uint8_t _head = 0;    // job being written
+    uint8_t _written = 0; // bytes of it done
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+EepromWriter::EepromWriter() {}
+
+EepromWriter::~EepromWriter() {}
+
+bool EepromWriter::write(int address, const void *data, uint8_t length, EepromCallback done, void *context)
+{
+    if (_head + _jobs >= MAX_JOBS || _used + length > CAPACITY)
+        return false;
+
+    Job &job = _job[_head + _jobs];
+    job.address = address;
+    job.offset = _used;
+    job.length = length;
+    job.done = done;
+    job.context = context;
+    memcpy(&_buffer[_used], data, length);
+    _used += length;
+    _jobs++;
+    return true;
+}
+
+bool EepromWriter::pending(int address) const
+{
+    for (uint8_t i = _head; i < _head + _jobs; i++)
+    {
+        if (_job[i].address == address)
+            return true;
+    }
+    return false;
+}
+
+void EepromWriter::service()
+{
+    if (!busy() || !eeprom_is_ready())
+        return;
+
+    // Reads are cheap next to a write: skip ahead to the first byte that differs
+    const Job &job = _job[_head];
+    while (_written < job.length)
+    {
+        uint8_t *cell = (uint8_t *)(uintptr_t)(job.address + _written);
+        uint8_t value = _buffer[job.offset + _written++];
+        if (eeprom_read_byte(cell) != value)
+        {
+            eeprom_write_byte(cell, value); // starts the write and returns
+            break;
+        }
+    }
+
+    if (_written < job.length)
+        return;
+    EepromCallback done = job.done;
+    void *context = job.context;
+    _written = 0;
+    _head++;
+    if (--_jobs == 0)
+    {
+        // Everything is out; the staging buffer starts over
+        _head = 0;
+        _used = 0;
+    }
+    // Last, so the callback may queue the next record
+    if (done)
+        done(context);
+}
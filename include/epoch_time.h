@@ -0,0 +1,125 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Seconds since 2000-01-01 00:00:00 UTC. 32 bits last until 2136.
+ */
+typedef uint32_t epoch_t;
+
+const uint32_t SECONDS_PER_DAY = 86400UL;
+
+/**
+ * @brief Broken-down calendar time, year is 2000-based (25 = 2025).
+ */
+struct timeObject
+{
+    byte second;
+    byte minute;
+    byte hour;
+    byte day;
+    byte month;
+    byte year;
+};
+
+/**
+ * @brief Fixed UTC offset; the trackers run on local standard time without DST.
+ */
+struct TimeZone
+{
+    int16_t offsetMinutes;
+
+    epoch_t toLocal(epoch_t utc) const { return utc + (int32_t)offsetMinutes * 60; }
+    epoch_t toUtc(epoch_t local) const { return local - (int32_t)offsetMinutes * 60; }
+};
+
+/**
+ * @brief Days since 2000-01-01 for a proleptic Gregorian date, O(1)
+ * (H. Hinnant's days_from_civil, shifted to a March-based year).
+ */
+static inline int32_t daysFromCivil(int16_t y, uint8_t m, uint8_t d)
+{
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint16_t yoe = y - era * 400;                               // [0, 399]
+    uint16_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1; // [0, 365]
+    uint32_t doe = yoe * 365UL + yoe / 4 - yoe / 100 + doy;      // [0, 146096]
+    return era * 146097L + (int32_t)doe - 730425L;              // 730425 = 0000-03-01 .. 2000-01-01
+}
+
+/**
+ * @brief Inverse of daysFromCivil().
+ */
+static inline void civilFromDays(int32_t z, int16_t &y, uint8_t &m, uint8_t &d)
+{
+    z += 730425L;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = z - era * 146097L;                                      // [0, 146096]
+    uint16_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    uint16_t doy = doe - (365UL * yoe + yoe / 4 - yoe / 100);             // [0, 365]
+    uint8_t mp = (5 * doy + 2) / 153;                                     // [0, 11]
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+static inline bool isLeapYear(int16_t y)
+{
+    return (y % 4 == 0) && (y % 100 != 0 || y % 400 == 0);
+}
+
+static inline uint8_t daysInMonth(int16_t y, uint8_t m)
+{
+    static const uint8_t DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (m == 2 && isLeapYear(y)) ? 29 : DAYS[m - 1];
+}
+
+/**
+ * @brief true for a real calendar time (2000-2099), false for anything fromCalendar()
+ * would silently wrap into another date.
+ */
+static inline bool isValidCalendar(const timeObject &t)
+{
+    return t.second < 60 && t.minute < 60 && t.hour < 24 && t.year < 100 &&
+           t.month >= 1 && t.month <= 12 && t.day >= 1 && t.day <= daysInMonth(2000 + t.year, t.month);
+}
+
+static inline epoch_t fromCalendar(const timeObject &t)
+{
+    uint32_t days = daysFromCivil(2000 + t.year, t.month, t.day);
+    return days * SECONDS_PER_DAY + (t.hour * 60UL + t.minute) * 60UL + t.second;
+}
+
+static inline timeObject toCalendar(epoch_t epoch)
+{
+    timeObject t;
+    uint32_t days = epoch / SECONDS_PER_DAY;
+    uint32_t secs = epoch % SECONDS_PER_DAY;
+    int16_t y;
+    civilFromDays(days, y, t.month, t.day);
+    t.year = y - 2000;
+    t.hour = secs / 3600;
+    t.minute = (secs / 60) % 60;
+    t.second = secs % 60;
+    return t;
+}
+
+/**
+ * @brief 1-based day of the year of an epoch (in whatever zone it is expressed in).
+ */
+static inline uint16_t dayOfYear(epoch_t epoch)
+{
+    int32_t days = epoch / SECONDS_PER_DAY;
+    int16_t y;
+    uint8_t m, d;
+    civilFromDays(days, y, m, d);
+    return days - daysFromCivil(y, 1, 1) + 1;
+}
+
+/**
+ * @brief Hours since local midnight, with fraction.
+ */
+static inline float fractionalHour(epoch_t epoch)
+{
+    return (epoch % SECONDS_PER_DAY) / 3600.0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Fast 1/sqrt(x) (bit-level initial guess + one Newton step), ~0.2% max
+ * relative error. Good enough for re-normalising vectors and quaternions every step.
+ */
+static inline float fastInvSqrt(float x)
+{
+    float halfx = 0.5f * x;
+    float y = x;
+    uint32_t i;
+    memcpy(&i, &y, sizeof(i));
+    i = 0x5f3759df - (i >> 1);
+    memcpy(&y, &i, sizeof(y));
+    y = y * (1.5f - (halfx * y * y));
+    return y;
+}
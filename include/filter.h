@@ -13,6 +13,17 @@ public:
     LowPassFilter() : _alpha(0.1), _filteredValue(0.0) {}
     ~LowPassFilter() {}
 
+    /**
+     * @brief Start from a known value instead of the first reading (warm start).
+     */
+    void seed(float value)
+    {
+        _filteredValue = value;
+        _hasInitialValue = true;
+    }
+
+    float value() const { return _filteredValue; }
+
     float reading(float newReading)
     {
         if (!_hasInitialValue)
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <Arduino.h>
+#include <util/twi.h>
+#include "i2c_supervisor.h"
+
+/**
+ * @brief Queue priority of an I2C transaction. Higher runs first.
+ */
+enum class I2CPriority : uint8_t
+{
+    BACKGROUND = 0, // LCD traffic
+    NORMAL = 1,     // RTC
+    URGENT = 2      // IMU
+};
+
+/**
+ * @brief Completion callback. status is the Wire.endTransmission() code
+ * (0 = success, 2/3 = NACK, 4 = bus error or lost arbitration, 5 = timeout).
+ */
+typedef void (*I2CCallback)(void *context, uint8_t status);
+
+/**
+ * @brief One queued transfer. For reads, reg is written first and length bytes are
+ * read back into data after a repeated start; for writes, reg followed by length
+ * bytes of data is sent. data must stay valid until the callback runs.
+ */
+struct I2CTransaction
+{
+    uint8_t address;
+    uint8_t reg;
+    uint8_t *data;
+    uint8_t length;
+    bool read;
+    I2CPriority priority;
+    I2CCallback callback;
+    void *context;
+};
+
+/**
+ * @brief Priority queue of I2C transactions, run by stepping the TWI peripheral's
+ * state machine from loop() without ever waiting on it.
+ *
+ * Wire's twi.c owns TWI_vect, so the engine polls TWINT instead of taking the
+ * interrupt: service() advances every step the hardware has finished and returns as
+ * soon as a byte is still on the wire. Writing TWCR without TWIE keeps Wire's ISR
+ * out of our transfers, and Wire re-enables it for its own (blocking) transfers at
+ * setup, which therefore must not overlap a queued one.
+ *
+ * The next transaction is picked when the previous one ends, highest priority first
+ * and FIFO within a priority, so an IMU read waits for at most the one LCD write on
+ * the wire, never for the LCD writes queued behind it.
+ */
+class I2CBus
+{
+public:
+    static const uint8_t QUEUE_SIZE = 8;
+
+    I2CBus();
+    ~I2CBus();
+
+    /**
+     * @param timeoutMicros Longest wait for one bus step (a byte, START or STOP)
+     * before the transfer is aborted with status 5 and the TWI is reset.
+     */
+    void begin(uint32_t timeoutMicros = 25000);
+
+    /**
+     * @brief Queue a transaction.
+     * @return false if the queue is full.
+     */
+    bool submit(const I2CTransaction &transaction);
+
+    /**
+     * @brief Start the next transaction or advance the one on the wire. Never waits.
+     * @return true while a transaction is in flight.
+     */
+    bool service();
+
+    /**
+     * @brief Report every executed transaction to a supervisor for stats and recovery.
+     */
+    void setSupervisor(I2CSupervisor *supervisor) { _supervisor = supervisor; }
+
+    /**
+     * @brief Transactions queued or in flight.
+     */
+    uint8_t pending() const { return _count + (_state != IDLE); }
+    uint8_t available() const { return QUEUE_SIZE - _count; }
+    uint16_t getDropped() const { return _dropped; }
+
+private:
+    enum State : uint8_t
+    {
+        IDLE,
+        START,         // START sent, SLA+W next
+        ADDRESS_WRITE, // SLA+W sent, register next
+        REGISTER,      // register sent, data or repeated START next
+        WRITE_DATA,
+        RESTART, // repeated START sent, SLA+R next
+        ADDRESS_READ,
+        READ_DATA
+    };
+
+    I2CTransaction _queue[QUEUE_SIZE];
+    uint8_t _sequence[QUEUE_SIZE];
+    uint8_t _count = 0;
+    uint8_t _nextSequence = 0;
+    uint16_t _dropped = 0;
+    I2CSupervisor *_supervisor = nullptr;
+
+    I2CTransaction _active;
+    State _state = IDLE;
+    uint8_t _index = 0;
+    uint32_t _startMicros = 0;
+    uint32_t _stepMicros = 0;
+    uint32_t _timeoutMicros = 25000;
+
+    void startNext();
+    void step(uint8_t status);
+    void send(uint8_t value, State next);
+    void stop(uint8_t status);
+    void finish(uint8_t status);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+I2CBus::I2CBus() {}
+
+I2CBus::~I2CBus() {}
+
+void I2CBus::begin(uint32_t timeoutMicros)
+{
+    _timeoutMicros = timeoutMicros;
+}
+
+bool I2CBus::submit(const I2CTransaction &transaction)
+{
+    if (_count >= QUEUE_SIZE)
+    {
+        _dropped++;
+        return false;
+    }
+    _queue[_count] = transaction;
+    _sequence[_count] = _nextSequence++;
+    _count++;
+    return true;
+}
+
+bool I2CBus::service()
+{
+    if (_state == IDLE)
+    {
+        // A STOP is still going out, the next START has to wait for it
+        if (_count == 0 || (TWCR & _BV(TWSTO)))
+            return false;
+        startNext();
+        return true;
+    }
+
+    // Everything the hardware has finished since the last call; a step that just
+    // started a byte returns with TWINT clear
+    while (_state != IDLE && (TWCR & _BV(TWINT)))
+    {
+        _stepMicros = micros();
+        step(TW_STATUS);
+    }
+
+    if (_state != IDLE && micros() - _stepMicros > _timeoutMicros)
+    {
+        // Slave holding SCL, or the TWI lost track: reset it like Wire's timeout does
+        TWCR = 0;
+        TWCR = _BV(TWEN);
+        finish(5);
+    }
+    return _state != IDLE;
+}
+
+void I2CBus::startNext()
+{
+    // Pick highest priority, oldest first; age is relative so the 8-bit sequence may wrap
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < _count; i++)
+    {
+        if (_queue[i].priority > _queue[best].priority ||
+            (_queue[i].priority == _queue[best].priority &&
+             (uint8_t)(_nextSequence - _sequence[i]) > (uint8_t)(_nextSequence - _sequence[best])))
+        {
+            best = i;
+        }
+    }
+
+    _active = _queue[best];
+    _count--;
+    for (uint8_t i = best; i < _count; i++)
+    {
+        _queue[i] = _queue[i + 1];
+        _sequence[i] = _sequence[i + 1];
+    }
+
+    _index = 0;
+    _startMicros = micros();
+    _stepMicros = _startMicros;
+    _state = START;
+    TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN);
+}
+
+void I2CBus::send(uint8_t value, State next)
+{
+    TWDR = value;
+    _state = next;
+    TWCR = _BV(TWINT) | _BV(TWEN);
+}
+
+void I2CBus::step(uint8_t status)
+{
+    switch (_state)
+    {
+    case START:
+        if (status != TW_START)
+            return finish(4);
+        return send(_active.address << 1 | TW_WRITE, ADDRESS_WRITE);
+
+    case ADDRESS_WRITE:
+        if (status != TW_MT_SLA_ACK)
+            return stop(status == TW_MT_SLA_NACK ? 2 : 4);
+        return send(_active.reg, REGISTER);
+
+    case REGISTER:
+    case WRITE_DATA:
+        if (status != TW_MT_DATA_ACK)
+            return stop(status == TW_MT_DATA_NACK ? 3 : 4);
+        if (_active.read)
+        {
+            _state = RESTART;
+            TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN);
+            return;
+        }
+        if (_index < _active.length)
+            return send(_active.data[_index++], WRITE_DATA);
+        return stop(0);
+
+    case RESTART:
+        if (status != TW_REP_START)
+            return finish(4);
+        return send(_active.address << 1 | TW_READ, ADDRESS_READ);
+
+    case ADDRESS_READ:
+        if (status != TW_MR_SLA_ACK)
+            return stop(status == TW_MR_SLA_NACK ? 2 : 4);
+        break;
+
+    case READ_DATA:
+        if (status != TW_MR_DATA_ACK && status != TW_MR_DATA_NACK)
+            return stop(4);
+        _active.data[_index++] = TWDR;
+        if (_index >= _active.length)
+            return stop(0);
+        break;
+
+    default:
+        return;
+    }
+
+    // Receive the next byte, ACK it unless it is the last one
+    _state = READ_DATA;
+    TWCR = _BV(TWINT) | _BV(TWEN) | (_index + 1 < _active.length ? _BV(TWEA) : 0);
+}
+
+void I2CBus::stop(uint8_t status)
+{
+    // TWSTO clears itself once the STOP is out; startNext() waits for that
+    TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+    finish(status);
+}
+
+void I2CBus::finish(uint8_t status)
+{
+    _state = IDLE;
+    // The supervisor may recover the bus, and the callback may queue a follow-up
+    if (_supervisor)
+        _supervisor->record(_active.address, status, _startMicros);
+    if (_active.callback)
+        _active.callback(_active.context, status);
+}
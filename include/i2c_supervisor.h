@@ -0,0 +1,255 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SDA_PIN A4
+#define SCL_PIN A5
+
+/**
+ * @brief Watches I2C health per device address: counts transactions, NACKs and
+ * timeouts, keeps a latency histogram, and runs a clock-pulse bus recovery only
+ * when the bus is actually stuck (SDA held low, or repeated timeouts).
+ *
+ * Transactions are reported either by I2CBus or, for library-owned transfers,
+ * by timing them with start() / observe().
+ */
+class I2CSupervisor
+{
+public:
+    static const uint8_t MAX_DEVICES = 4;
+    static const uint8_t HISTOGRAM_BUCKETS = 8; // <0.5, <1, <2, <4, <8, <16, <32, >=32 ms
+    static const uint8_t TIMEOUTS_BEFORE_RECOVERY = 3;
+
+    struct DeviceStats
+    {
+        uint8_t address;
+        uint16_t transactions;
+        uint16_t nacks;
+        uint16_t timeouts;
+        uint16_t maxMicros;
+        uint16_t histogram[HISTOGRAM_BUCKETS];
+    };
+
+    I2CSupervisor();
+    ~I2CSupervisor();
+
+    /**
+     * @brief Configure the bus; the same settings are restored after a recovery.
+     */
+    void begin(uint32_t clockHz, uint32_t timeoutMicros = 25000);
+
+    uint32_t start() { return micros(); }
+
+    /**
+     * @brief Record a finished transaction with a Wire status code
+     * (0 ok, 2/3 NACK, 5 timeout, other = error) and recover the bus if needed:
+     * after an error or timeout with SDA held low, or repeated timeouts.
+     * A timeout also clears the Wire timeout flag, so it is not counted again by
+     * the next observe().
+     */
+    void record(uint8_t address, uint8_t status, uint32_t startMicros);
+
+    /**
+     * @brief Record a library-owned transfer that only reports success or failure;
+     * a Wire timeout during it is picked up from the Wire timeout flag.
+     */
+    void observe(uint8_t address, uint32_t startMicros, bool ok);
+
+    /**
+     * @brief Clock SCL until the slave releases SDA, then send STOP and restart Wire.
+     * @return true if SDA is released afterwards.
+     */
+    bool recover();
+
+    const DeviceStats *getStats(uint8_t address) const;
+    const DeviceStats *getStatsAt(uint8_t index) const { return index < _deviceCount ? &_devices[index] : nullptr; }
+    uint8_t getDeviceCount() const { return _deviceCount; }
+    uint16_t getRecoveries() const { return _recoveries; }
+
+    /**
+     * @brief Per-device counters and latency histogram as text, one line per device.
+     */
+    void dump(Print &out) const;
+
+private:
+    uint32_t _clockHz = 100000;
+    uint32_t _timeoutMicros = 25000;
+    DeviceStats _devices[MAX_DEVICES];
+    uint8_t _deviceCount = 0;
+    uint8_t _consecutiveTimeouts = 0;
+    uint16_t _recoveries = 0;
+
+    DeviceStats *slot(uint8_t address);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+I2CSupervisor::I2CSupervisor() {}
+
+I2CSupervisor::~I2CSupervisor() {}
+
+void I2CSupervisor::begin(uint32_t clockHz, uint32_t timeoutMicros)
+{
+    _clockHz = clockHz;
+    _timeoutMicros = timeoutMicros;
+    Wire.setClock(clockHz);
+    Wire.setWireTimeout(timeoutMicros, true);
+}
+
+I2CSupervisor::DeviceStats *I2CSupervisor::slot(uint8_t address)
+{
+    for (uint8_t i = 0; i < _deviceCount; i++)
+    {
+        if (_devices[i].address == address)
+            return &_devices[i];
+    }
+    if (_deviceCount >= MAX_DEVICES)
+        return nullptr;
+
+    DeviceStats *d = &_devices[_deviceCount++];
+    memset(d, 0, sizeof(*d));
+    d->address = address;
+    return d;
+}
+
+const I2CSupervisor::DeviceStats *I2CSupervisor::getStats(uint8_t address) const
+{
+    for (uint8_t i = 0; i < _deviceCount; i++)
+    {
+        if (_devices[i].address == address)
+            return &_devices[i];
+    }
+    return nullptr;
+}
+
+void I2CSupervisor::record(uint8_t address, uint8_t status, uint32_t startMicros)
+{
+    uint32_t elapsed = micros() - startMicros;
+
+    DeviceStats *d = slot(address);
+    if (d)
+    {
+        d->transactions++;
+        if (status == 2 || status == 3)
+            d->nacks++;
+        else if (status == 5)
+            d->timeouts++;
+
+        if (elapsed > d->maxMicros)
+            d->maxMicros = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+
+        uint8_t bucket = 0;
+        uint32_t t = elapsed >> 9;
+        while (t && bucket < HISTOGRAM_BUCKETS - 1)
+        {
+            t >>= 1;
+            bucket++;
+        }
+        d->histogram[bucket]++;
+    }
+
+    if (status == 0)
+    {
+        _consecutiveTimeouts = 0;
+        return;
+    }
+
+    if (status == 5)
+    {
+        Wire.clearWireTimeoutFlag();
+        _consecutiveTimeouts++;
+    }
+
+    // A NACK alone is the device's problem; only touch the shared bus when it is stuck.
+    // SDA is not looked at after a NACK: I2CBus reports it while its STOP is still
+    // going out, and SDA can read low until that is done.
+    bool failed = status == 4 || status == 5;
+    if ((failed && digitalRead(SDA_PIN) == LOW) || _consecutiveTimeouts >= TIMEOUTS_BEFORE_RECOVERY)
+    {
+        recover();
+        _consecutiveTimeouts = 0;
+    }
+}
+
+void I2CSupervisor::observe(uint8_t address, uint32_t startMicros, bool ok)
+{
+    uint8_t status = ok ? 0 : 4;
+    if (Wire.getWireTimeoutFlag())
+    {
+        Wire.clearWireTimeoutFlag();
+        status = 5;
+    }
+    record(address, status, startMicros);
+}
+
+void I2CSupervisor::dump(Print &out) const
+{
+    out.println(F("i2c addr n nack timeout max_us <0.5ms <1 <2 <4 <8 <16 <32 >=32"));
+    for (uint8_t i = 0; i < _deviceCount; i++)
+    {
+        const DeviceStats &d = _devices[i];
+        out.print(F("0x"));
+        if (d.address < 0x10)
+            out.print('0');
+        out.print(d.address, HEX);
+        out.print(' ');
+        out.print(d.transactions);
+        out.print(' ');
+        out.print(d.nacks);
+        out.print(' ');
+        out.print(d.timeouts);
+        out.print(' ');
+        out.print(d.maxMicros);
+        for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++)
+        {
+            out.print(' ');
+            out.print(d.histogram[b]);
+        }
+        out.println();
+    }
+    out.print(F("i2c recoveries "));
+    out.println(_recoveries);
+}
+
+bool I2CSupervisor::recover()
+{
+    _recoveries++;
+
+    // Release the pins from the TWI peripheral before bit-banging them
+    Wire.end();
+    pinMode(SCL_PIN, OUTPUT);
+    pinMode(SDA_PIN, INPUT_PULLUP);
+
+    // Toggle clock up to 9 times to free SDA
+    for (uint8_t i = 0; i < 9; i++)
+    {
+        if (digitalRead(SDA_PIN) == HIGH)
+        {
+            break; // SDA released → bus is free
+        }
+        digitalWrite(SCL_PIN, LOW);
+        delayMicroseconds(5);
+        digitalWrite(SCL_PIN, HIGH);
+        delayMicroseconds(5);
+    }
+
+    // Generate STOP condition
+    pinMode(SDA_PIN, OUTPUT);
+    digitalWrite(SDA_PIN, LOW);
+    delayMicroseconds(5);
+    digitalWrite(SCL_PIN, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(SDA_PIN, HIGH);
+    delayMicroseconds(5);
+
+    // Reinit I2C, begin() resets the clock so restore it
+    Wire.begin();
+    Wire.setClock(_clockHz);
+    Wire.setWireTimeout(_timeoutMicros, true);
+
+    // Check if SDA is released
+    return (digitalRead(SDA_PIN) == HIGH);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+#include "i2c_supervisor.h"
+#include "tilt.h"
+
+struct ModelIMU
+{
+    float xa = 0;
+    float ya = 0;
+    float za = 0;
+    float xg = 0;
+    float yg = 0;
+    float zg = 0;
+    float Accelroll = 0;
+    float Accelpitch = 0;
+    float Accelyaw = 0;
+};
+
+/**
+ * @brief Shared state and read sequence for IMU drivers, dispatched to the driver at
+ * compile time (CRTP): no virtual calls and no vtable.
+ *
+ * A driver derives as `class X : public ImuBase<X>`, befriends ImuBase<X> and provides:
+ *  - void begin()                 : bring the sensor up and set `active`
+ *  - bool readSample()            : blocking read of one sample into `imuData`, true on success
+ *  - bool submitRead(I2CBus &bus) : queue the reads for one sample and return true, the
+ *                                   last callback hands the result to completeRead()
+ * It may shadow computeTilt(), which derives the tilt angles from `imuData` after
+ * every good sample, and the configuration calls, whose defaults do nothing.
+ * Accel is in driver units (raw counts or m/s²), gyro in °/s, tilt in degrees.
+ *
+ * Exactly one driver is compiled in, see imu_select.h.
+ */
+template <typename Driver>
+class ImuBase
+{
+protected:
+    bool active = false;
+    ModelIMU imuData;
+    I2CSupervisor *supervisor = nullptr;
+    bool readPending = false;
+    bool fresh = false;
+
+    Driver &driver() { return *static_cast<Driver *>(this); }
+
+    void computeTilt()
+    {
+        tiltFromAccel(imuData.xa, imuData.ya, imuData.za, imuData.Accelroll, imuData.Accelpitch);
+    }
+
+    /**
+     * @brief End of a queued read; `imuData` holds the new sample if ok.
+     */
+    void completeRead(bool ok)
+    {
+        readPending = false;
+        if (!ok)
+            return;
+        driver().computeTilt();
+        fresh = true;
+    }
+
+public:
+    /**
+     * @brief Report reads to the bus supervisor instead of handling bus faults locally.
+     */
+    void attachSupervisor(I2CSupervisor *bus) { supervisor = bus; }
+
+    /**
+     * @brief Read the sensor. Returns true if new data was stored.
+     */
+    bool update()
+    {
+        if (!active || !driver().readSample())
+            return false;
+        driver().computeTilt();
+        return true;
+    }
+
+    /**
+     * @brief Non-blocking update(): queue the sample read at URGENT priority, ahead of
+     * any RTC or LCD traffic. consumeFresh() reports when it has arrived.
+     */
+    void requestUpdate(I2CBus &bus)
+    {
+        if (!active || readPending)
+            return;
+        readPending = driver().submitRead(bus);
+    }
+
+    /**
+     * @brief true once after each sample completed through requestUpdate().
+     */
+    bool consumeFresh()
+    {
+        bool was = fresh;
+        fresh = false;
+        return was;
+    }
+
+    float getAccelX() const { return imuData.xa; }
+    float getAccelY() const { return imuData.ya; }
+    float getAccelZ() const { return imuData.za; }
+    float getGyroX() const { return imuData.xg; }
+    float getGyroY() const { return imuData.yg; }
+    float getGyroZ() const { return imuData.zg; }
+    float getAccelRoll() const { return imuData.Accelroll; }
+    float getAccelPitch() const { return imuData.Accelpitch; }
+    ModelIMU getModelIMU() const { return imuData; }
+
+    // Set accelerometer sensitivity (0=±2g, 1=±4g, 2=±8g, 3=±16g)
+    void setAccelSensitivity(uint8_t level) {}
+    // Set gyroscope sensitivity (0=±250°/s, 1=±500°/s, 2=±1000°/s, 3=±2000°/s)
+    void setGyroSensitivity(uint8_t level) {}
+    // Set filter bandwidth (0-6 = 260Hz ... 5Hz)
+    void setFilterBandwidth(uint8_t level) {}
+
+    bool isActive() { return active; }
+
+    void end() { active = false; }
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "eeprom_layout.h"
+#include "crc8.h"
+#include "eeprom_writer.h"
+
+/**
+ * @brief Linear per-axis correction: calibrated = raw * scale + offset.
+ */
+struct AxisCalibration
+{
+    float scale = 1.0;
+    float offset = 0.0;
+    float invScale = 1.0; // cached, not persisted
+
+    void set(float newScale, float newOffset)
+    {
+        scale = newScale;
+        offset = newOffset;
+        invScale = 1.0 / newScale;
+    }
+
+    float apply(float raw) const { return raw * scale + offset; }
+    float invert(float calibrated) const { return (calibrated - offset) * invScale; }
+};
+
+/**
+ * @brief Per-unit roll/pitch scale and offset, stored in EEPROM so every tracker can
+ * run the same firmware image. Falls back to the bench values of the first unit
+ * when nothing valid is stored.
+ */
+class ImuCalibration
+{
+private:
+    static const uint8_t VERSION = 1;
+
+    // Packed so the crc is the last byte on the host too; the AVR has no padding anyway
+    struct __attribute__((packed)) Record
+    {
+        uint8_t version;
+        float rollScale;
+        float rollOffset;
+        float pitchScale;
+        float pitchOffset;
+        uint8_t crc;
+    };
+
+public:
+    AxisCalibration roll;
+    AxisCalibration pitch;
+
+    ImuCalibration();
+    ~ImuCalibration();
+
+    /**
+     * @brief Load from EEPROM.
+     * @return false if no valid record was found and defaults are in use.
+     */
+    bool begin();
+
+    /**
+     * @brief Queue the current calibration for writing in the background.
+     * @return false if the writer has no room.
+     */
+    bool save(EepromWriter &writer);
+    void setDefaults();
+
+    /**
+     * @brief Measure offsets with the tracker held at a known pose, keeping the
+     * current scales. Blocks for `samples` reads of the IMU.
+     * @return false if the IMU produced no data.
+     */
+    template <typename IMU>
+    bool captureOffsets(IMU &imu, float refRoll, float refPitch, uint8_t samples);
+
+    /**
+     * @brief Solve scale and offset of one axis from two (measured, reference) pairs.
+     */
+    static void solveTwoPoint(AxisCalibration &axis, float measured1, float ref1, float measured2, float ref2);
+};
+
+/**
+ * @brief Two-orientation calibration without blocking: the tracker is held at one known
+ * pose while add() averages the uncalibrated roll/pitch of the fusion output, then at a
+ * second one, and solve() fits scale and offset of both axes through the two points.
+ * The poses should differ by tens of degrees on both axes for a usable scale.
+ */
+class TwoPointCapture
+{
+public:
+    static const uint8_t SAMPLES = 50;
+
+    TwoPointCapture();
+    ~TwoPointCapture();
+
+    /**
+     * @brief Start averaging point 0 or 1 at the given reference pose (degrees),
+     * replacing what that point held.
+     */
+    bool start(uint8_t point, float refRoll, float refPitch);
+
+    /**
+     * @brief Feed one uncalibrated sample while capturing.
+     */
+    void add(float rawRoll, float rawPitch);
+
+    bool capturing() const { return _capturing; }
+
+    /**
+     * @brief Bit n set once point n is complete.
+     */
+    uint8_t captured() const { return _captured; }
+
+    /**
+     * @brief Fit both axes into calibration.
+     * @return false unless both points are complete and differ on both axes.
+     */
+    bool solve(ImuCalibration &calibration) const;
+
+private:
+    struct Point
+    {
+        float refRoll;
+        float refPitch;
+        float sumRoll;
+        float sumPitch;
+    };
+
+    Point _point[2];
+    uint8_t _active = 0;
+    uint8_t _count = 0;
+    uint8_t _captured = 0;
+    bool _capturing = false;
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+ImuCalibration::ImuCalibration() { setDefaults(); }
+
+ImuCalibration::~ImuCalibration() {}
+
+void ImuCalibration::setDefaults()
+{
+    roll.set(1.028, -0.113);
+    pitch.set(1.0, 0.2);
+}
+
+bool ImuCalibration::begin()
+{
+    Record r;
+    EEPROM.get(EEPROM_IMU_CAL_ADDR, r);
+    if (r.version != VERSION || crc8((const uint8_t *)&r, sizeof(r) - 1) != r.crc ||
+        r.rollScale == 0 || r.pitchScale == 0)
+    {
+        setDefaults();
+        return false;
+    }
+
+    roll.set(r.rollScale, r.rollOffset);
+    pitch.set(r.pitchScale, r.pitchOffset);
+    return true;
+}
+
+bool ImuCalibration::save(EepromWriter &writer)
+{
+    Record r;
+    r.version = VERSION;
+    r.rollScale = roll.scale;
+    r.rollOffset = roll.offset;
+    r.pitchScale = pitch.scale;
+    r.pitchOffset = pitch.offset;
+    r.crc = crc8((const uint8_t *)&r, sizeof(r) - 1);
+    return writer.write(EEPROM_IMU_CAL_ADDR, &r, sizeof(r));
+}
+
+template <typename IMU>
+bool ImuCalibration::captureOffsets(IMU &imu, float refRoll, float refPitch, uint8_t samples)
+{
+    float sumRoll = 0;
+    float sumPitch = 0;
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < samples; i++)
+    {
+        if (imu.update())
+        {
+            sumRoll += imu.getAccelRoll();
+            sumPitch += imu.getAccelPitch();
+            count++;
+        }
+        delay(10);
+    }
+    if (count == 0)
+        return false;
+
+    roll.set(roll.scale, refRoll - roll.scale * (sumRoll / count));
+    pitch.set(pitch.scale, refPitch - pitch.scale * (sumPitch / count));
+    return true;
+}
+
+void ImuCalibration::solveTwoPoint(AxisCalibration &axis, float measured1, float ref1, float measured2, float ref2)
+{
+    if (measured2 == measured1)
+        return;
+    float scale = (ref2 - ref1) / (measured2 - measured1);
+    axis.set(scale, ref1 - scale * measured1);
+}
+
+TwoPointCapture::TwoPointCapture() {}
+
+TwoPointCapture::~TwoPointCapture() {}
+
+bool TwoPointCapture::start(uint8_t point, float refRoll, float refPitch)
+{
+    if (point > 1 || isnan(refRoll) || isnan(refPitch))
+        return false;
+    _point[point].refRoll = refRoll;
+    _point[point].refPitch = refPitch;
+    _point[point].sumRoll = 0;
+    _point[point].sumPitch = 0;
+    _captured &= ~(1 << point);
+    _active = point;
+    _count = 0;
+    _capturing = true;
+    return true;
+}
+
+void TwoPointCapture::add(float rawRoll, float rawPitch)
+{
+    if (!_capturing)
+        return;
+    Point &p = _point[_active];
+    p.sumRoll += rawRoll;
+    p.sumPitch += rawPitch;
+    if (++_count < SAMPLES)
+        return;
+    _capturing = false;
+    _captured |= 1 << _active;
+}
+
+bool TwoPointCapture::solve(ImuCalibration &calibration) const
+{
+    if (_captured != 0x03)
+        return false;
+    const Point &a = _point[0];
+    const Point &b = _point[1];
+    float roll1 = a.sumRoll / SAMPLES, roll2 = b.sumRoll / SAMPLES;
+    float pitch1 = a.sumPitch / SAMPLES, pitch2 = b.sumPitch / SAMPLES;
+    if (fabs(roll2 - roll1) < 1.0f || fabs(pitch2 - pitch1) < 1.0f)
+        return false; // a scale from less than a degree apart is mostly noise
+
+    ImuCalibration::solveTwoPoint(calibration.roll, roll1, a.refRoll, roll2, b.refRoll);
+    ImuCalibration::solveTwoPoint(calibration.pitch, pitch1, a.refPitch, pitch2, b.refPitch);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @brief Compile-time IMU selection. Set one of these in platformio.ini build_flags:
+ *  -D IMU_MPU6050       : SensorMPU, polled
+ *  -D IMU_MPU6050_FIFO  : SensorMPU sampling into its FIFO, INT on D2
+ *  -D IMU_SIMULATED     : SimulatedIMU
+ *  (default)            : SensorFXOSFXAS
+ * Only the selected driver header (and so only its libraries) is compiled in.
+ */
+#if defined(IMU_MPU6050) || defined(IMU_MPU6050_FIFO)
+#include "sensor_mpu.h"
+typedef SensorMPU ImuDriver;
+#elif defined(IMU_SIMULATED)
+#include "sensor_sim.h"
+typedef SimulatedIMU ImuDriver;
+#else
+#include "sensor_fxos.h"
+typedef SensorFXOSFXAS ImuDriver;
+#endif
+
+/**
+ * @brief true when the sensor paces itself and hands every sample to the handler set
+ * with setSampleHandler(); false when the caller reads it at its own rate.
+ */
+#ifdef IMU_MPU6050_FIFO
+const bool IMU_FIFO = true;
+#else
+const bool IMU_FIFO = false;
+#endif
+
+/**
+ * @brief Bring the selected driver up, sampling at sampleHz where the sensor paces itself.
+ */
+inline void beginImu(ImuDriver &imu, uint8_t sampleHz)
+{
+#ifdef IMU_MPU6050_FIFO
+    imu.beginFifo(1000 / sampleHz - 1); // 1 kHz internal rate with the DLPF on
+#else
+    (void)sampleHz;
+    imu.begin();
+#endif
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+
+/**
+ * @brief HD44780 behind a PCF8574 backpack, driven through I2CBus instead of the
+ * blocking LCD_I2C calls, so LCD traffic queues at BACKGROUND priority behind the
+ * IMU and RTC. Takes over from LCD_I2C after its begin(); provides the setCursor() /
+ * write() pair LcdFramebuffer::flush() needs.
+ *
+ * Every LCD byte is one bus write of four expander bytes, two nibbles each clocked
+ * with E high then low; at 10 kHz that takes ~4 ms, far above the 37 us the
+ * controller needs per byte. A write that was dropped or failed leaves the display
+ * unknown: consumeLost() then tells the caller to redraw.
+ */
+class LcdBus : public Print
+{
+public:
+    static const uint8_t SLOTS = 4;    // LCD bytes queued at once
+    static const uint8_t RESERVED = 2; // bus queue entries left for IMU and RTC reads
+
+    LcdBus(I2CBus &bus, uint8_t address);
+    ~LcdBus();
+
+    void setCursor(uint8_t col, uint8_t row);
+    size_t write(uint8_t c) override;
+    using Print::write;
+    void setBacklight(bool on);
+
+    /**
+     * @brief LCD bytes that can be queued now.
+     */
+    uint8_t room() const;
+
+    /**
+     * @brief true once after a byte was dropped or failed on the bus.
+     */
+    bool consumeLost();
+
+private:
+    // PCF8574 pins
+    static const uint8_t RS = 0x01;
+    static const uint8_t EN = 0x04;
+    static const uint8_t BACKLIGHT = 0x08;
+
+    I2CBus &_bus;
+    uint8_t _address;
+    uint8_t _backlight = BACKLIGHT;
+    uint8_t _slots[SLOTS][3]; // expander bytes after the first, which goes in reg
+    uint8_t _head = 0;        // oldest slot on the bus, they complete in order
+    uint8_t _used = 0;
+    bool _lost = false;
+
+    void send(uint8_t value, uint8_t mode);
+    static void onSent(void *context, uint8_t status);
+    static void onBacklight(void *context, uint8_t status);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+LcdBus::LcdBus(I2CBus &bus, uint8_t address) : _bus(bus), _address(address) {}
+
+LcdBus::~LcdBus() {}
+
+uint8_t LcdBus::room() const
+{
+    uint8_t free = _bus.available() > RESERVED ? _bus.available() - RESERVED : 0;
+    return min(free, (uint8_t)(SLOTS - _used));
+}
+
+bool LcdBus::consumeLost()
+{
+    bool was = _lost;
+    _lost = false;
+    return was;
+}
+
+void LcdBus::setCursor(uint8_t col, uint8_t row)
+{
+    static const uint8_t ROW_OFFSET[] = {0x00, 0x40, 0x14, 0x54}; // 20x4
+    send(0x80 | (col + ROW_OFFSET[row & 0x03]), 0);
+}
+
+size_t LcdBus::write(uint8_t c)
+{
+    send(c, RS);
+    return 1;
+}
+
+void LcdBus::setBacklight(bool on)
+{
+    _backlight = on ? BACKLIGHT : 0;
+    I2CTransaction t = {_address, _backlight, nullptr, 0, false, I2CPriority::BACKGROUND, onBacklight, this};
+    if (!_bus.submit(t))
+        _lost = true;
+}
+
+void LcdBus::send(uint8_t value, uint8_t mode)
+{
+    if (room() == 0)
+    {
+        _lost = true;
+        return;
+    }
+
+    uint8_t high = (value & 0xF0) | mode | _backlight;
+    uint8_t low = (value << 4) | mode | _backlight;
+    uint8_t *slot = _slots[(_head + _used) % SLOTS];
+    slot[0] = high;
+    slot[1] = low | EN;
+    slot[2] = low;
+
+    I2CTransaction t = {_address, (uint8_t)(high | EN), slot, 3, false, I2CPriority::BACKGROUND, onSent, this};
+    if (_bus.submit(t))
+        _used++;
+    else
+        _lost = true;
+}
+
+void LcdBus::onSent(void *context, uint8_t status)
+{
+    LcdBus *self = static_cast<LcdBus *>(context);
+    self->_head = (self->_head + 1) % SLOTS;
+    self->_used--;
+    if (status != 0)
+        self->_lost = true;
+}
+
+void LcdBus::onBacklight(void *context, uint8_t status)
+{
+    if (status != 0)
+        static_cast<LcdBus *>(context)->_lost = true;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Drop-in stand-in for LCD_I2C that keeps the 20x4 screen in RAM and counts
+ * what would have gone over the bus. Selected with -D LCD_EMULATOR, see
+ * user_interface.h, to look at screens and their I2C cost without a display.
+ *
+ * The character RAM is modelled like the HD44780: rows 0/2 and 1/3 are each one
+ * continuous line, so writing past the end of row 0 continues on row 2.
+ */
+class LcdEmulator : public Print
+{
+public:
+    static const uint8_t COLS = 20;
+    static const uint8_t ROWS = 4;
+
+    // LCD_I2C sends each LCD byte as two nibbles, each strobed with E high then low,
+    // and every strobe is its own Wire transfer of address + data byte
+    static const uint8_t BUS_BYTES_PER_LCD_BYTE = 8;
+
+    LcdEmulator(uint8_t address, uint8_t columns, uint8_t rows);
+    ~LcdEmulator();
+
+    void begin(bool beginWire = true);
+    void backlight();
+    void noBacklight();
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void display() { command(); }
+    void noDisplay() { command(); }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    char charAt(uint8_t col, uint8_t row) const;
+    bool isBacklightOn() const { return _backlight; }
+
+    /**
+     * @brief Print the screen as four lines framed by '|'.
+     */
+    void dump(Print &out) const;
+
+    uint32_t getCommands() const { return _commands; }
+    uint32_t getCharacters() const { return _characters; }
+    uint32_t getBusBytes() const { return (_commands + _characters) * BUS_BYTES_PER_LCD_BYTE; }
+    void resetCounters();
+
+private:
+    static const uint8_t LINE_LENGTH = 40; // DDRAM bytes per HD44780 line
+
+    char _ddram[2][LINE_LENGTH];
+    uint8_t _address = 0; // 0..79, line * LINE_LENGTH + offset
+    bool _backlight = false;
+    uint32_t _commands = 0;
+    uint32_t _characters = 0;
+
+    void command() { _commands++; }
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+LcdEmulator::LcdEmulator(uint8_t /* address */, uint8_t /* columns */, uint8_t /* rows */)
+{
+    memset(_ddram, ' ', sizeof(_ddram));
+}
+
+LcdEmulator::~LcdEmulator() {}
+
+void LcdEmulator::begin(bool /* beginWire */)
+{
+    // Function set, display control, clear and entry mode
+    _commands += 4;
+    memset(_ddram, ' ', sizeof(_ddram));
+    _address = 0;
+}
+
+void LcdEmulator::backlight()
+{
+    _backlight = true;
+    command(); // one expander write, counted like a command
+}
+
+void LcdEmulator::noBacklight()
+{
+    _backlight = false;
+    command();
+}
+
+void LcdEmulator::clear()
+{
+    command();
+    memset(_ddram, ' ', sizeof(_ddram));
+    _address = 0;
+}
+
+void LcdEmulator::home()
+{
+    command();
+    _address = 0;
+}
+
+void LcdEmulator::setCursor(uint8_t col, uint8_t row)
+{
+    command();
+    if (row >= ROWS)
+        row = ROWS - 1;
+    // Rows 2 and 3 are the second half of lines 0 and 1
+    _address = (row & 1) * LINE_LENGTH + (row >> 1) * COLS + col;
+    if (_address >= 2 * LINE_LENGTH)
+        _address = 0;
+}
+
+size_t LcdEmulator::write(uint8_t c)
+{
+    _characters++;
+    _ddram[_address / LINE_LENGTH][_address % LINE_LENGTH] = c;
+    if (++_address >= 2 * LINE_LENGTH)
+        _address = 0;
+    return 1;
+}
+
+char LcdEmulator::charAt(uint8_t col, uint8_t row) const
+{
+    if (col >= COLS || row >= ROWS)
+        return ' ';
+    return _ddram[row & 1][(row >> 1) * COLS + col];
+}
+
+void LcdEmulator::dump(Print &out) const
+{
+    for (uint8_t row = 0; row < ROWS; row++)
+    {
+        out.print('|');
+        for (uint8_t col = 0; col < COLS; col++)
+        {
+            out.print(charAt(col, row));
+        }
+        out.println("|");
+    }
+}
+
+void LcdEmulator::resetCounters()
+{
+    _commands = 0;
+    _characters = 0;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Shadow copy of a 20x4 character LCD. Screens print into it like into the
+ * LCD itself; flush() then sends only the characters that differ from what the
+ * display already shows, skipping setCursor where the LCD cursor is already there.
+ *
+ * On the 10 kHz bus every character costs several expander transfers, so rewriting
+ * the full screen each second blocked for hundreds of milliseconds, while an
+ * unchanged screen now costs nothing.
+ */
+class LcdFramebuffer : public Print
+{
+public:
+    static const uint8_t COLS = 20;
+    static const uint8_t ROWS = 4;
+
+    LcdFramebuffer();
+    ~LcdFramebuffer();
+
+    /**
+     * @brief Blank the frame being drawn. Unlike LCD_I2C::clear() this sends nothing.
+     */
+    void clear();
+    void setCursor(uint8_t col, uint8_t row);
+
+    /**
+     * @brief Characters past the end of a row are dropped, not wrapped.
+     */
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    /**
+     * @brief Force the next flush to resend every cell, e.g. after the LCD was reset.
+     */
+    void invalidate();
+
+    /**
+     * @brief Send changed cells to the display, resuming where the previous call
+     * stopped, so a screen update can be spread over several loop iterations.
+     * @param maxChars Upper bound on characters sent by this call.
+     * @return Number of characters sent.
+     */
+    template <typename LCD>
+    uint8_t flush(LCD &lcd, uint8_t maxChars = 255);
+
+    /**
+     * @brief Number of cells that still differ from the display.
+     */
+    uint8_t pending() const;
+
+private:
+    // Rewriting up to this many unchanged cells is cheaper than a new setCursor
+    static const uint8_t MAX_GAP = 1;
+    static const uint8_t NO_CURSOR = 0xFF;
+
+    char _frame[ROWS][COLS];
+    char _shown[ROWS][COLS];
+    uint8_t _col = 0;
+    uint8_t _row = 0;
+    uint8_t _scan = 0;              // next cell flush() looks at, row-major
+    uint8_t _cursorCol = 0;         // where the LCD will put the next character
+    uint8_t _cursorRow = NO_CURSOR; // unknown until the next setCursor
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+LcdFramebuffer::LcdFramebuffer()
+{
+    clear();
+    invalidate();
+}
+
+LcdFramebuffer::~LcdFramebuffer() {}
+
+void LcdFramebuffer::clear()
+{
+    memset(_frame, ' ', sizeof(_frame));
+    _col = 0;
+    _row = 0;
+}
+
+void LcdFramebuffer::setCursor(uint8_t col, uint8_t row)
+{
+    _col = col;
+    _row = row;
+}
+
+size_t LcdFramebuffer::write(uint8_t c)
+{
+    if (_row >= ROWS || _col >= COLS)
+        return 0;
+    _frame[_row][_col++] = c;
+    return 1;
+}
+
+void LcdFramebuffer::invalidate()
+{
+    // No printable character is 0, so every cell differs from the frame
+    memset(_shown, 0, sizeof(_shown));
+    _cursorRow = NO_CURSOR;
+}
+
+uint8_t LcdFramebuffer::pending() const
+{
+    uint8_t count = 0;
+    for (uint8_t row = 0; row < ROWS; row++)
+    {
+        for (uint8_t col = 0; col < COLS; col++)
+        {
+            if (_frame[row][col] != _shown[row][col])
+                count++;
+        }
+    }
+    return count;
+}
+
+template <typename LCD>
+uint8_t LcdFramebuffer::flush(LCD &lcd, uint8_t maxChars)
+{
+    uint8_t sent = 0;
+    for (uint8_t i = 0; i < ROWS * COLS && sent < maxChars; i++)
+    {
+        uint8_t row = _scan / COLS;
+        uint8_t col = _scan % COLS;
+        if (++_scan >= ROWS * COLS)
+            _scan = 0;
+
+        if (_frame[row][col] == _shown[row][col])
+            continue;
+
+        // Rewrite a short run of unchanged cells instead of moving the cursor,
+        // as long as that still fits in this call's budget
+        uint8_t gap = col - _cursorCol;
+        if (row != _cursorRow || col < _cursorCol || gap > MAX_GAP || sent + gap >= maxChars)
+        {
+            lcd.setCursor(col, row);
+            _cursorRow = row;
+            _cursorCol = col;
+        }
+
+        while (_cursorCol <= col)
+        {
+            lcd.write(_frame[row][_cursorCol]);
+            _shown[row][_cursorCol] = _frame[row][_cursorCol];
+            _cursorCol++;
+            sent++;
+        }
+
+        // The HD44780 does not continue on the next visible row
+        if (_cursorCol >= COLS)
+            _cursorRow = NO_CURSOR;
+    }
+    return sent;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Builds a line of text in a caller-provided buffer without touching the
+ * heap, replacing String concatenation in the UI. Output that does not fit is
+ * truncated; the buffer is always NUL-terminated.
+ *
+ * Numbers print like Print::print(): integers in decimal, floats with a fixed
+ * number of decimals, rounded half away from zero.
+ */
+class LineFormat
+{
+public:
+    LineFormat(char *buffer, uint8_t size);
+    ~LineFormat();
+
+    LineFormat &text(const char *s);
+    LineFormat &character(char c);
+    LineFormat &integer(int32_t value);
+    LineFormat &fixed(float value, uint8_t decimals = 2);
+
+    const char *c_str() const { return _buffer; }
+    uint8_t length() const { return _length; }
+
+private:
+    char *_buffer;
+    uint8_t _size;
+    uint8_t _length = 0;
+
+    void digits(uint32_t value, uint8_t minDigits);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+LineFormat::LineFormat(char *buffer, uint8_t size) : _buffer(buffer), _size(size)
+{
+    if (_size > 0)
+        _buffer[0] = '\0';
+}
+
+LineFormat::~LineFormat() {}
+
+LineFormat &LineFormat::character(char c)
+{
+    if (_length + 1 < _size)
+    {
+        _buffer[_length++] = c;
+        _buffer[_length] = '\0';
+    }
+    return *this;
+}
+
+LineFormat &LineFormat::text(const char *s)
+{
+    while (*s)
+        character(*s++);
+    return *this;
+}
+
+void LineFormat::digits(uint32_t value, uint8_t minDigits)
+{
+    char tmp[10];
+    uint8_t n = 0;
+    do
+    {
+        tmp[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value || n < minDigits);
+
+    while (n)
+        character(tmp[--n]);
+}
+
+LineFormat &LineFormat::integer(int32_t value)
+{
+    uint32_t magnitude = value;
+    if (value < 0)
+    {
+        character('-');
+        magnitude = -magnitude; // well defined for INT32_MIN on unsigned
+    }
+    digits(magnitude, 1);
+    return *this;
+}
+
+LineFormat &LineFormat::fixed(float value, uint8_t decimals)
+{
+    if (isnan(value))
+        return text("nan");
+    if (decimals > 6)
+        decimals = 6;
+
+    if (value < 0)
+    {
+        character('-');
+        value = -value;
+    }
+
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++)
+        scale *= 10;
+
+    value = value * scale + 0.5f;
+    if (value >= 4294967040.0f) // largest float below 2^32
+        return text("ovf");
+
+    uint32_t scaled = value;
+    digits(scaled / scale, 1);
+    if (decimals)
+    {
+        character('.');
+        digits(scaled % scale, decimals);
+    }
+    return *this;
+}
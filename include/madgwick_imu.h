@@ -1,38 +1,65 @@
 #pragma once
 
-#include <MadgwickAHRS.h>
-#include "sensor_mpu.h"
+#include "imu.h"
+#include "fast_math.h"
+#include "tilt.h"
+#include "imu_calibration.h"
 #include <Arduino.h>
 
+/**
+ * @brief Madgwick accel + gyro orientation filter stepped at a fixed sample rate.
+ *
+ * Gyro input is in °/s, accel in any unit (it is normalised). The filter seeds its
+ * quaternion from the first accel sample so it does not have to converge from level.
+ */
 class MadgwickIMU
 {
 private:
-    unsigned long _microsPerReading;
-    unsigned long _microsPrevious;
+    unsigned long _microsPerReading = 0;
+    unsigned long _microsPrevious = 0;
+    float _invSampleFreq = 0;
+    float _beta = 0.1f;
+    float _q0 = 1.0f, _q1 = 0.0f, _q2 = 0.0f, _q3 = 0.0f;
     float _roll, _pitch, _yaw;
-    Madgwick _filter;
-    ModelIMU _imuData;
+    float _rawRoll, _rawPitch;
+    const ImuCalibration *_calibration = nullptr;
+    bool _seeded = false;
     bool active = false;
 
-    float convertRawAcceleration(int aRaw)
-    {
-        float a = (aRaw * 8.0) / 32768.0;
-        return a;
-    }
-
-    float convertRawGyro(int gRaw)
-    {
-        float g = (gRaw * 250.0) / 32768.0;
-        return g;
-    }
+    void seed(float ax, float ay, float az);
+    void computeAngles();
 
 public:
     MadgwickIMU();
     ~MadgwickIMU();
 
-    void update(ModelIMU imu);
+    /**
+     * @brief Set the fixed sample rate and gain, and start pacing from now.
+     */
+    void begin(float sampleHz, float beta = 0.1f);
+
+    /**
+     * @brief true once per sample period; keeps pace by advancing the previous
+     * timestamp by exactly one period instead of resetting it to now. A backlog of
+     * more than one period (e.g. after a blocking call) is dropped, not replayed.
+     */
+    bool due();
+
+    /**
+     * @brief Correct roll/pitch with a per-unit calibration, applied once per sample.
+     */
+    void setCalibration(const ImuCalibration *calibration) { _calibration = calibration; }
+
+    /**
+     * @brief Run one fixed-timestep filter step with the given sample.
+     */
+    void update(const ModelIMU &imu);
     float getRoll();
     float getPitch();
+    float getRawRoll() { return _rawRoll; }
+    float getRawPitch() { return _rawPitch; }
+    bool isSeeded() const { return _seeded; }
+    float getYaw();
     void end();
     bool isActive();
 };
@@ -40,36 +67,123 @@ public:
 MadgwickIMU::MadgwickIMU() {}
 MadgwickIMU::~MadgwickIMU() {}
 
-void MadgwickIMU::update(ModelIMU imu)
+void MadgwickIMU::begin(float sampleHz, float beta)
+{
+    _microsPerReading = 1000000UL / sampleHz;
+    _microsPrevious = micros();
+    _invSampleFreq = 1.0f / sampleHz;
+    _beta = beta;
+    _seeded = false;
+    active = true;
+}
+
+bool MadgwickIMU::due()
+{
+    unsigned long now = micros();
+    unsigned long elapsed = now - _microsPrevious;
+    if (!active || elapsed < _microsPerReading)
+        return false;
+
+    if (elapsed >= 2 * _microsPerReading)
+        _microsPrevious = now;
+    else
+        _microsPrevious += _microsPerReading;
+    return true;
+}
+
+void MadgwickIMU::seed(float ax, float ay, float az)
+{
+    float roll = atan2(ay, az);
+    float pitch = atan2(-ax, sqrt(ay * ay + az * az));
+    float cr = cos(roll * 0.5f), sr = sin(roll * 0.5f);
+    float cp = cos(pitch * 0.5f), sp = sin(pitch * 0.5f);
+    _q0 = cr * cp;
+    _q1 = sr * cp;
+    _q2 = cr * sp;
+    _q3 = -sr * sp;
+    _seeded = true;
+}
+
+void MadgwickIMU::update(const ModelIMU &imu)
 {
-    if (micros() - _microsPrevious >= _microsPerReading)
+    float ax = imu.xa, ay = imu.ya, az = imu.za;
+    if (ax == 0.0f && ay == 0.0f && az == 0.0f)
+        return; // no gravity reference, nothing sensible to do
+
+    if (!_seeded)
     {
-        _imuData.xa = convertRawAcceleration(imu.xa);
-        _imuData.ya = convertRawAcceleration(imu.ya);
-        _imuData.za = convertRawAcceleration(imu.za);
-        _imuData.xg = convertRawGyro(imu.xg);
-        _imuData.yg = convertRawGyro(imu.yg);
-        _imuData.zg = convertRawGyro(imu.zg);
-
-        // update the filter, which computes orientation
-        _filter.updateIMU(
-            _imuData.xg, _imuData.yg, _imuData.zg,
-            _imuData.xa, _imuData.ya, _imuData.za);
-
-        // print the heading, pitch and roll
-        _roll = _filter.getRoll();
-        _pitch = _filter.getPitch();
-        _yaw = _filter.getYaw();
-
-        // increment previous time, so we keep proper pace
-        _microsPrevious = _microsPrevious + _microsPerReading;
+        seed(ax, ay, az);
+        computeAngles();
+        return;
     }
+
+    float gx = imu.xg * DEG_TO_RAD;
+    float gy = imu.yg * DEG_TO_RAD;
+    float gz = imu.zg * DEG_TO_RAD;
+
+    // Rate of change of quaternion from gyroscope
+    float qDot1 = 0.5f * (-_q1 * gx - _q2 * gy - _q3 * gz);
+    float qDot2 = 0.5f * (_q0 * gx + _q2 * gz - _q3 * gy);
+    float qDot3 = 0.5f * (_q0 * gy - _q1 * gz + _q3 * gx);
+    float qDot4 = 0.5f * (_q0 * gz + _q1 * gy - _q2 * gx);
+
+    float recipNorm = fastInvSqrt(ax * ax + ay * ay + az * az);
+    ax *= recipNorm;
+    ay *= recipNorm;
+    az *= recipNorm;
+
+    // Gradient descent corrective step
+    float _2q0 = 2.0f * _q0, _2q1 = 2.0f * _q1, _2q2 = 2.0f * _q2, _2q3 = 2.0f * _q3;
+    float _4q0 = 4.0f * _q0, _4q1 = 4.0f * _q1, _4q2 = 4.0f * _q2;
+    float _8q1 = 8.0f * _q1, _8q2 = 8.0f * _q2;
+    float q0q0 = _q0 * _q0, q1q1 = _q1 * _q1, q2q2 = _q2 * _q2, q3q3 = _q3 * _q3;
+
+    float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+    float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * _q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+    float s2 = 4.0f * q0q0 * _q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+    float s3 = 4.0f * q1q1 * _q3 - _2q1 * ax + 4.0f * q2q2 * _q3 - _2q2 * ay;
+
+    // The reference filter always normalises the step, which at our low sample rates
+    // turns into a limit cycle of beta / rate around the solution. Normalise only large
+    // steps so the correction is proportional near the solution and bounded far from it.
+    float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+    float gain = (sNorm > 1.0f) ? _beta * fastInvSqrt(sNorm) : _beta;
+    qDot1 -= gain * s0;
+    qDot2 -= gain * s1;
+    qDot3 -= gain * s2;
+    qDot4 -= gain * s3;
+
+    // Integrate over one fixed sample period
+    _q0 += qDot1 * _invSampleFreq;
+    _q1 += qDot2 * _invSampleFreq;
+    _q2 += qDot3 * _invSampleFreq;
+    _q3 += qDot4 * _invSampleFreq;
+
+    recipNorm = fastInvSqrt(_q0 * _q0 + _q1 * _q1 + _q2 * _q2 + _q3 * _q3);
+    _q0 *= recipNorm;
+    _q1 *= recipNorm;
+    _q2 *= recipNorm;
+    _q3 *= recipNorm;
+
+    computeAngles();
+}
+
+void MadgwickIMU::computeAngles()
+{
+    // Same axis conventions as Accelroll / Accelpitch
+    _rawRoll = fastAtan2Deg(_q0 * _q1 + _q2 * _q3, 0.5f - _q1 * _q1 - _q2 * _q2);
+    _rawPitch = asin(constrain(-2.0f * (_q1 * _q3 - _q0 * _q2), -1.0f, 1.0f)) * RAD_TO_DEG;
+    _roll = _calibration ? _calibration->roll.apply(_rawRoll) : _rawRoll;
+    _pitch = _calibration ? _calibration->pitch.apply(_rawPitch) : _rawPitch;
+    _yaw = fastAtan2Deg(_q1 * _q2 + _q0 * _q3, 0.5f - _q2 * _q2 - _q3 * _q3);
 }
 
 float MadgwickIMU::getRoll() { return _roll; }
 
 float MadgwickIMU::getPitch() { return _pitch; }
 
+float MadgwickIMU::getYaw() { return _yaw; }
+
 void MadgwickIMU::end() { active = false; }
 
-bool MadgwickIMU::isActive() { return active; }
\ No newline at end of file
+bool MadgwickIMU::isActive() { return active; }
@@ -41,11 +41,23 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Drive or release the BTS7960 half bridges (REN/LEN). Disabled, both
+     * outputs float and the driver draws only its quiescent current.
+     */
+    void enable(bool on);
+
+    /**
+     * @brief Last commanded PWM duty, positive when turning right.
+     */
+    int16_t getDuty() const { return duty; }
+
 private:
     byte LEN;
     byte REN;
     byte LPWM;
     byte RPWM;
+    int16_t duty = 0;
 };
 
 // ------------------------------
@@ -81,6 +93,7 @@ void Motor::turnLeft(byte speed)
     digitalWrite(LPWM, LOW);
 
     analogWrite(RPWM, speed);
+    duty = -speed;
 }
 
 void Motor::turnRight(byte speed)
@@ -89,6 +102,15 @@ void Motor::turnRight(byte speed)
     digitalWrite(RPWM, LOW);
 
     analogWrite(LPWM, speed);
+    duty = speed;
+}
+
+void Motor::enable(bool on)
+{
+    if (!on)
+        stop();
+    digitalWrite(this->LEN, on ? HIGH : LOW);
+    digitalWrite(this->REN, on ? HIGH : LOW);
 }
 
 void Motor::stop()
@@ -97,4 +119,5 @@ void Motor::stop()
     analogWrite(LPWM, 0);
     digitalWrite(RPWM, LOW);
     digitalWrite(LPWM, LOW);
+    duty = 0;
 }
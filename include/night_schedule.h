@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+#include "epoch_time.h"
+
+// The tracker parks from NIGHT_START_HOUR to NIGHT_END_HOUR, local time
+const uint8_t NIGHT_START_HOUR = 20;
+const uint8_t NIGHT_END_HOUR = 4;
+
+static inline bool isNight(const timeObject &t)
+{
+    return t.hour >= NIGHT_START_HOUR || t.hour < NIGHT_END_HOUR;
+}
+
+/**
+ * @brief Seconds from t to NIGHT_END_HOUR; only meaningful while isNight(t).
+ */
+static inline uint32_t secondsUntilMorning(const timeObject &t)
+{
+    uint8_t hours = (t.hour >= NIGHT_START_HOUR) ? 24 + NIGHT_END_HOUR - t.hour : NIGHT_END_HOUR - t.hour;
+    return hours * 3600UL - t.minute * 60UL - t.second;
+}
+
+/**
+ * @brief Watchdog periods to sleep before the next RTC read: 90% of the time left
+ * until morning, so a watchdog running up to 10% slow cannot overshoot by much, and
+ * never more than maxSleepSeconds between reads.
+ * @param periodSeconds Length of one watchdog period.
+ * @return At least 1.
+ */
+static inline uint16_t nightSleepPeriods(const timeObject &t, uint8_t periodSeconds, uint16_t maxSleepSeconds)
+{
+    uint32_t periods = secondsUntilMorning(t) * 9 / 10 / periodSeconds;
+    return constrain(periods, 1UL, (uint32_t)(maxSleepSeconds / periodSeconds));
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include "task_watchdog.h" // owns ISR(WDT_vect), which returns at once in interrupt-only mode
+
+/**
+ * @brief AVR power-down sleep with the watchdog as the wake-up timer.
+ *
+ * Every free external interrupt pin is taken (D2 by the IMU interrupt line, D3 by
+ * the X motor driver), so an RTC alarm cannot reach the CPU; the watchdog wakes it
+ * every WAKE_SECONDS instead. The encoder's pin change interrupt also wakes it, so
+ * turning the knob ends a sleep early. millis() does not advance while asleep:
+ * resync wall-clock time from the RTC after waking.
+ */
+class PowerDown
+{
+public:
+    static const uint8_t WAKE_SECONDS = 8; // longest watchdog interval, ±10% over temperature
+
+    /**
+     * @brief Sleep until the watchdog interval ends or another interrupt arrives.
+     * Leaves the watchdog in interrupt-only mode; TaskWatchdog::arm() restores it.
+     */
+    static void sleep();
+
+private:
+    static void armWatchdogInterrupt();
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+void PowerDown::armWatchdogInterrupt()
+{
+    // Timed sequence: WDCE and WDE first, then the new setting within 4 cycles.
+    // WDE cleared and WDIE set: interrupt after ~8 s, no reset.
+    cli();
+    wdt_reset();
+    MCUSR &= ~_BV(WDRF); // WDE cannot be cleared while WDRF is set
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | _BV(WDP3) | _BV(WDP0);
+    sei();
+}
+
+void PowerDown::sleep()
+{
+    armWatchdogInterrupt();
+
+    uint8_t adc = ADCSRA;
+    ADCSRA = 0; // the ADC would keep drawing ~200 µA in power-down
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    sleep_enable();
+    sleep_bod_disable(); // must be followed by sleep within 3 cycles
+    sei();               // the instruction after sei always runs, so no wake-up is lost
+    sleep_cpu();
+    sleep_disable();
+
+    ADCSRA = adc;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Probes timed by PROFILE_SCOPE. Add new ones before PROBE_COUNT and give
+ * them a name in Profiler::name().
+ */
+enum ProfileProbe : uint8_t
+{
+    PROBE_LOOP,    // one pass of loop()
+    PROBE_SUN,     // SunTracker::calculateSunAngles
+    PROBE_LDR,     // SensorLDR::update
+    PROBE_FUSION,  // MadgwickIMU::update, one fusion step
+    PROBE_CONTROL, // ControlSystem::run*
+    PROBE_LCD,     // LCD flush
+    PROBE_COUNT
+};
+
+/**
+ * @brief Execution time histograms, one per probe, built with -D PROFILE.
+ *
+ * Bin b counts runs of [2^(b-1), 2^b) µs, bin 0 runs under 1 µs and the last bin
+ * everything from 2^(BINS-2) µs up, so 16 bins reach past 16 ms at the cost of
+ * 32 bytes per probe. micros() ticks in 4 µs on a 16 MHz AVR, so bins 1 and 2
+ * stay empty. Without PROFILE the macro expands to nothing and no RAM is used.
+ */
+class Profiler
+{
+public:
+    static const uint8_t BINS = 16;
+
+    struct Histogram
+    {
+        uint16_t bins[BINS]; // saturating counts
+        uint32_t maxMicros;
+    };
+
+    Profiler();
+    ~Profiler();
+
+    void record(uint8_t probe, uint32_t elapsed);
+    const Histogram &get(uint8_t probe) const { return _histograms[probe]; }
+    void reset();
+
+    /**
+     * @brief Print one line per probe: name, max µs, then the bin counts.
+     */
+    void dump(Print &out) const;
+
+    static const __FlashStringHelper *name(uint8_t probe);
+    static uint8_t bin(uint32_t elapsed);
+
+private:
+    Histogram _histograms[PROBE_COUNT];
+};
+
+/**
+ * @brief Times its own lifetime into a probe.
+ */
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler &profiler, uint8_t probe) : _profiler(profiler), _probe(probe), _start(micros()) {}
+    ~ProfileScope() { _profiler.record(_probe, micros() - _start); }
+
+private:
+    Profiler &_profiler;
+    uint8_t _probe;
+    uint32_t _start;
+};
+
+#ifdef PROFILE
+Profiler profiler;
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(probe) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, probe)
+#else
+#define PROFILE_SCOPE(probe)
+#endif
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+Profiler::Profiler() { reset(); }
+
+Profiler::~Profiler() {}
+
+uint8_t Profiler::bin(uint32_t elapsed)
+{
+    uint8_t b = 0;
+    while (elapsed && b < BINS - 1)
+    {
+        elapsed >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void Profiler::record(uint8_t probe, uint32_t elapsed)
+{
+    if (probe >= PROBE_COUNT)
+        return;
+    Histogram &h = _histograms[probe];
+    uint16_t &count = h.bins[bin(elapsed)];
+    if (count != 0xFFFF)
+        count++;
+    if (elapsed > h.maxMicros)
+        h.maxMicros = elapsed;
+}
+
+void Profiler::reset()
+{
+    memset(_histograms, 0, sizeof(_histograms));
+}
+
+const __FlashStringHelper *Profiler::name(uint8_t probe)
+{
+    switch (probe)
+    {
+    case PROBE_LOOP:
+        return F("loop");
+    case PROBE_SUN:
+        return F("sun");
+    case PROBE_LDR:
+        return F("ldr");
+    case PROBE_FUSION:
+        return F("fusion");
+    case PROBE_CONTROL:
+        return F("control");
+    case PROBE_LCD:
+        return F("lcd");
+    default:
+        return F("?");
+    }
+}
+
+void Profiler::dump(Print &out) const
+{
+    out.println(F("probe max_us <1 <2 <4 <8 <16 <32 <64 <128 <256 <512 <1k <2k <4k <8k <16k >=16k"));
+    for (uint8_t p = 0; p < PROBE_COUNT; p++)
+    {
+        out.print(name(p));
+        out.print(' ');
+        out.print(_histograms[p].maxMicros);
+        for (uint8_t b = 0; b < BINS; b++)
+        {
+            out.print(' ');
+            out.print(_histograms[p].bins[b]);
+        }
+        out.println();
+    }
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "eeprom_layout.h"
+#include "crc8.h"
+#include "epoch_time.h"
+#include "eeprom_writer.h"
+
+/**
+ * @brief Learns the RTC rate error from the sun itself.
+ *
+ * While the LDRs hold the tracker centred on the sun around solar noon, the X axis
+ * pose is the true sun position; the sun model evaluated at RTC time predicts where
+ * it should be. Their difference divided by the model's X rate is the clock offset
+ * in seconds. A constant mechanical offset cancels out, so only the change of the
+ * daily mean offset over a baseline of several days is used, which is the rate error.
+ *
+ * Observations are made with the already-corrected time, so each day measures the
+ * residual rate and the estimate converges instead of being recomputed from scratch.
+ * The estimate and the baseline's reference day are kept in EEPROM, so neither the
+ * correction nor a baseline under way is lost to a reset.
+ */
+class RtcDriftEstimator
+{
+public:
+    static const uint16_t OBSERVATION_INTERVAL = 60;      // s between observations
+    static const uint8_t MIN_OBSERVATIONS_PER_DAY = 10;
+    static constexpr float MIN_X_RATE = 0.002f;           // deg/s, ~7°/h: only near noon
+    static constexpr float MAX_OFFSET_SECONDS = 900.0f;   // reject LDR lock on a reflection
+    static constexpr float MAX_PPM = 200.0f;
+    static const uint8_t BASELINE_DAYS = 7;               // pointing noise is ~1 s/day, 1 week keeps it to a few ppm
+    static constexpr float GAIN = 0.5f;                   // fraction of the residual applied per update
+
+    RtcDriftEstimator();
+    ~RtcDriftEstimator();
+
+    /**
+     * @brief Load the last estimate and reference from EEPROM. A version 1 record
+     * (ppm only) is taken over with no reference.
+     * @return false if no valid record was found and 0 ppm is in use.
+     */
+    bool begin();
+
+    /**
+     * @brief true when the estimate or the reference changed since the last save().
+     */
+    bool needsSave() const { return _dirty; }
+
+    /**
+     * @brief Queue the record for writing in the background.
+     * @return false if the writer has no room; needsSave() stays true then.
+     */
+    bool save(EepromWriter &writer);
+
+    /**
+     * @brief true when enough time has passed since the last observe(), accepted or
+     * not, so a window that keeps being rejected costs one sun model run per interval.
+     */
+    bool wantsObservation(epoch_t utc) const { return utc - _lastAttempt >= OBSERVATION_INTERVAL; }
+
+    /**
+     * @brief Add one observation with the tracker centred on the sun.
+     * @param measuredX Tracker X angle (deg).
+     * @param predictedX Sun model X angle at utc (deg).
+     * @param predictedXRate Sun model X angle rate at utc (deg/s).
+     * @return true if a baseline was completed and the ppm estimate changed.
+     */
+    bool observe(epoch_t utc, float measuredX, float predictedX, float predictedXRate);
+
+    /**
+     * @brief Rate correction in ppm, positive when the RTC runs slow.
+     */
+    float getPpm() const { return _ppm; }
+
+private:
+    static const uint8_t VERSION = 2;
+
+    // Packed so the crc is the last byte on the host too; the AVR has no padding anyway
+    struct __attribute__((packed)) RecordV1
+    {
+        uint8_t version;
+        float ppm;
+        uint8_t crc;
+    };
+
+    struct __attribute__((packed)) Record
+    {
+        uint8_t version;
+        float ppm;
+        float referenceOffset;
+        epoch_t referenceEpoch; // 0: no reference yet
+        uint8_t crc;
+    };
+
+    float _ppm = 0;
+    epoch_t _lastObservation = 0; // last accepted
+    epoch_t _lastAttempt = 0;
+
+    uint16_t _day = 0;
+    float _offsetSum = 0;
+    uint8_t _offsetCount = 0;
+
+    bool _hasReference = false;
+    float _referenceOffset = 0;
+    epoch_t _referenceEpoch = 0;
+
+    epoch_t _firstObservation = 0;
+    bool _dirty = false;
+
+    bool closeDay();
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+RtcDriftEstimator::RtcDriftEstimator() {}
+
+RtcDriftEstimator::~RtcDriftEstimator() {}
+
+bool RtcDriftEstimator::begin()
+{
+    _ppm = 0;
+    _hasReference = false;
+
+    Record r;
+    EEPROM.get(EEPROM_RTC_DRIFT_ADDR, r);
+    if (r.version == 1)
+    {
+        RecordV1 old;
+        EEPROM.get(EEPROM_RTC_DRIFT_ADDR, old);
+        if (crc8((const uint8_t *)&old, sizeof(old) - 1) != old.crc || isnan(old.ppm) || fabs(old.ppm) > MAX_PPM)
+            return false;
+        _ppm = old.ppm;
+        _dirty = true; // rewrite as version 2
+        return true;
+    }
+
+    if (r.version != VERSION || crc8((const uint8_t *)&r, sizeof(r) - 1) != r.crc ||
+        isnan(r.ppm) || fabs(r.ppm) > MAX_PPM || isnan(r.referenceOffset))
+        return false;
+
+    _ppm = r.ppm;
+    if (r.referenceEpoch != 0)
+    {
+        _hasReference = true;
+        _referenceOffset = r.referenceOffset;
+        _referenceEpoch = r.referenceEpoch;
+    }
+    return true;
+}
+
+bool RtcDriftEstimator::save(EepromWriter &writer)
+{
+    Record r;
+    r.version = VERSION;
+    r.ppm = _ppm;
+    r.referenceOffset = _hasReference ? _referenceOffset : 0;
+    r.referenceEpoch = _hasReference ? _referenceEpoch : 0;
+    r.crc = crc8((const uint8_t *)&r, sizeof(r) - 1);
+    if (!writer.write(EEPROM_RTC_DRIFT_ADDR, &r, sizeof(r)))
+        return false;
+    _dirty = false;
+    return true;
+}
+
+bool RtcDriftEstimator::observe(epoch_t utc, float measuredX, float predictedX, float predictedXRate)
+{
+    _lastAttempt = utc;
+    bool changed = false;
+    uint16_t day = utc / SECONDS_PER_DAY;
+    if (day != _day)
+    {
+        changed = closeDay();
+        _day = day;
+    }
+
+    if (fabs(predictedXRate) < MIN_X_RATE)
+        return changed;
+
+    float offset = (measuredX - predictedX) / predictedXRate; // s the RTC is behind the sun
+    if (fabs(offset) > MAX_OFFSET_SECONDS)
+        return changed;
+
+    if (_offsetCount == 0)
+        _firstObservation = utc;
+    _lastObservation = utc;
+    _offsetSum += offset;
+    _offsetCount++;
+    return changed;
+}
+
+bool RtcDriftEstimator::closeDay()
+{
+    if (_offsetCount < MIN_OBSERVATIONS_PER_DAY)
+    {
+        _offsetSum = 0;
+        _offsetCount = 0;
+        return false;
+    }
+
+    float offset = _offsetSum / _offsetCount;
+    epoch_t utc = _firstObservation / 2 + _lastObservation / 2; // middle of the day's window
+    _offsetSum = 0;
+    _offsetCount = 0;
+
+    if (!_hasReference)
+    {
+        _hasReference = true;
+        _referenceOffset = offset;
+        _referenceEpoch = utc;
+        _dirty = true;
+        return false;
+    }
+
+    if (utc - _referenceEpoch < BASELINE_DAYS * SECONDS_PER_DAY - SECONDS_PER_DAY / 2)
+        return false;
+
+    float residualPpm = (offset - _referenceOffset) / (float)(utc - _referenceEpoch) * 1e6;
+    _ppm = constrain(_ppm + GAIN * residualPpm, -MAX_PPM, MAX_PPM);
+    _referenceOffset = offset;
+    _referenceEpoch = utc;
+    _dirty = true;
+    return true;
+}
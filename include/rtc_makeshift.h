@@ -1,22 +1,18 @@
 #pragma once
 #include <Arduino.h>
-#include "sensor_rtc.h"
+#include "epoch_time.h"
 
 class RTCMakeshift
 {
 private:
-    timeObject simTime;
+    epoch_t simTime; // local time
     unsigned long lastUpdate = 0;
 
 public:
     RTCMakeshift()
     {
-        simTime.hour = 6; // Start at 06:00:00
-        simTime.minute = 0;
-        simTime.second = 0;
-        simTime.day = 20;
-        simTime.month = 8;
-        simTime.year = 25;
+        timeObject start = {0, 0, 6, 20, 8, 25}; // 2025-08-20 06:00:00
+        simTime = fromCalendar(start);
     }
 
     void begin()
@@ -30,23 +26,17 @@ public:
         if (now - lastUpdate >= 1000)
         { // Every 1 second
             lastUpdate += 1000;
-            simTime.minute += 5;
-            if (simTime.minute >= 60)
-            {
-                simTime.minute -= 60;
-                simTime.hour++;
-                if (simTime.hour >= 24)
-                {
-                    simTime.hour = 0;
-                    simTime.day++;
-                    // Optionally handle month/year rollover
-                }
-            }
+            simTime += 5 * 60; // 5 minutes, dates roll over through the epoch
         }
     }
 
-    timeObject getData()
+    epoch_t getEpoch()
     {
         return simTime;
     }
+
+    timeObject getData()
+    {
+        return toCalendar(simTime);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_FXOS8700.h>
+#include <Adafruit_FXAS21002C.h>
+#include "imu.h"
+#include "tilt.h"
+
+class SensorFXOSFXAS : public ImuBase<SensorFXOSFXAS>
+{
+private:
+    Adafruit_FXOS8700 fxos = Adafruit_FXOS8700(0x8700A, 0x8700B);
+    Adafruit_FXAS21002C fxas = Adafruit_FXAS21002C(0x0021002C);
+    const uint8_t FXOS_ADDR = 0x1F;
+    const uint8_t FXAS_ADDR = 0x21;
+    const uint8_t OUT_X_MSB = 0x01; // same on both: X, Y, Z, MSB first
+    const float ACCEL_MS2_PER_LSB = 0.000244f * SENSORS_GRAVITY_STANDARD; // ±2 g, 14 bit
+    const float GYRO_DPS_PER_LSB = 0.0078125f;                             // ±250 °/s
+    bool gyroActive = false;
+    uint8_t accelBuffer[6];
+    uint8_t gyroBuffer[6];
+    bool accelOk = false;
+
+    friend class ImuBase<SensorFXOSFXAS>;
+
+    bool readSample()
+    {
+        sensors_event_t aevent, mevent, gevent;
+        uint32_t start = micros();
+        fxos.getEvent(&aevent, &mevent);
+
+        // Basic sanity check (NaN or out-of-range values)
+        bool valid = !(isnan(aevent.acceleration.x) || fabs(aevent.acceleration.x) > 100.0 ||
+                       isnan(aevent.acceleration.y) || fabs(aevent.acceleration.y) > 100.0 ||
+                       isnan(aevent.acceleration.z) || fabs(aevent.acceleration.z) > 100.0);
+
+        // Timeout or invalid read: the supervisor decides whether the bus needs recovery
+        if (supervisor)
+            supervisor->observe(FXOS_ADDR, start, valid);
+        if (!valid)
+            return false;
+
+        imuData.xa = -1 * aevent.acceleration.y;
+        imuData.ya = aevent.acceleration.x;
+        imuData.za = aevent.acceleration.z;
+
+        // FXAS21002C sits on the same board with the same axes, remap like the accel (rad/s -> °/s)
+        bool gyroOk = false;
+        if (gyroActive)
+        {
+            start = micros();
+            gyroOk = fxas.getEvent(&gevent);
+            if (supervisor)
+                supervisor->observe(FXAS_ADDR, start, gyroOk);
+        }
+        if (gyroOk)
+        {
+            imuData.xg = -1 * gevent.gyro.y * RAD_TO_DEG;
+            imuData.yg = gevent.gyro.x * RAD_TO_DEG;
+            imuData.zg = gevent.gyro.z * RAD_TO_DEG;
+        }
+        else
+        {
+            imuData.xg = 0;
+            imuData.yg = 0;
+            imuData.zg = 0;
+        }
+        return true;
+    }
+
+    static int16_t be16(const uint8_t *b) { return (int16_t)((b[0] << 8) | b[1]); }
+
+    /**
+     * @brief Same sample as readSample() as two raw register reads on the bus; the
+     * Adafruit drivers only read blocking.
+     */
+    bool submitRead(I2CBus &bus)
+    {
+        if (bus.available() < (gyroActive ? 2 : 1))
+            return false;
+
+        I2CTransaction accel = {FXOS_ADDR, OUT_X_MSB, accelBuffer, sizeof(accelBuffer), true, I2CPriority::URGENT, onAccel, this};
+        bus.submit(accel);
+        if (gyroActive)
+        {
+            I2CTransaction gyro = {FXAS_ADDR, OUT_X_MSB, gyroBuffer, sizeof(gyroBuffer), true, I2CPriority::URGENT, onGyro, this};
+            bus.submit(gyro);
+        }
+        return true;
+    }
+
+    static void onAccel(void *context, uint8_t status)
+    {
+        SensorFXOSFXAS *self = static_cast<SensorFXOSFXAS *>(context);
+        self->accelOk = status == 0;
+        if (self->accelOk)
+        {
+            // 14-bit, left aligned
+            self->imuData.xa = -1 * (be16(self->accelBuffer + 2) >> 2) * self->ACCEL_MS2_PER_LSB;
+            self->imuData.ya = (be16(self->accelBuffer) >> 2) * self->ACCEL_MS2_PER_LSB;
+            self->imuData.za = (be16(self->accelBuffer + 4) >> 2) * self->ACCEL_MS2_PER_LSB;
+        }
+        if (!self->gyroActive)
+        {
+            self->imuData.xg = 0;
+            self->imuData.yg = 0;
+            self->imuData.zg = 0;
+            self->completeRead(self->accelOk);
+        }
+    }
+
+    static void onGyro(void *context, uint8_t status)
+    {
+        SensorFXOSFXAS *self = static_cast<SensorFXOSFXAS *>(context);
+        bool ok = status == 0;
+        self->imuData.xg = ok ? -1 * be16(self->gyroBuffer + 2) * self->GYRO_DPS_PER_LSB : 0;
+        self->imuData.yg = ok ? be16(self->gyroBuffer) * self->GYRO_DPS_PER_LSB : 0;
+        self->imuData.zg = ok ? be16(self->gyroBuffer + 4) * self->GYRO_DPS_PER_LSB : 0;
+        self->completeRead(self->accelOk);
+    }
+
+public:
+    SensorFXOSFXAS() {}
+    ~SensorFXOSFXAS() {}
+
+    void begin()
+    {
+        if (!fxos.begin())
+        {
+            active = false;
+            return;
+        }
+        active = true;
+
+        // Without the gyro the fusion filter degrades to accel-only tilt
+        gyroActive = fxas.begin();
+    }
+
+    bool isGyroActive() { return gyroActive; }
+};
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "profiler.h"
 
 /**
  * @brief SensorLDR class for reading LDR sensor values using weighted vector readings.
@@ -91,6 +92,7 @@ void SensorLDR::begin()
 
 void SensorLDR::update()
 {
+    PROFILE_SCOPE(PROBE_LDR);
     for (int i = 0; i < 6; i++)
     {
         value[i] = analogRead(pin[i]) + sensorOffset[i];
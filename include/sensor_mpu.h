@@ -2,32 +2,310 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "imu.h"
+#include "i2c_bus.h"
+#include "tilt.h"
 
-#define SDA_PIN A4
-#define SCL_PIN A5
+#define MPU_INT_PIN 2 // INT0, the only free external interrupt pin on the Nano
 
-struct ModelIMU
-{
-    float xa = 0;
-    float ya = 0;
-    float za = 0;
-    float xg = 0;
-    float yg = 0;
-    float zg = 0;
-    float Accelroll = 0;
-    float Accelpitch = 0;
-    float Accelyaw = 0;
-};
-
-class SensorMPU
+class SensorMPU : public ImuBase<SensorMPU>
 {
 private:
     const uint8_t MPU_ADDR = 0x68;
     const uint8_t MPU_PWR_MGMT_1 = 0x6B;
     const uint8_t MPU_ACCEL_XOUT_H = 0x3B;
-    const uint8_t byteSize = 6;
-    bool active = false;
-    ModelIMU imuData;
+    const uint8_t MPU_SMPLRT_DIV = 0x19;
+    const uint8_t MPU_CONFIG = 0x1A;
+    const uint8_t MPU_FIFO_EN = 0x23;
+    const uint8_t MPU_INT_PIN_CFG = 0x37;
+    const uint8_t MPU_INT_ENABLE = 0x38;
+    const uint8_t MPU_INT_STATUS = 0x3A;
+    const uint8_t MPU_USER_CTRL = 0x6A;
+    const uint8_t MPU_FIFO_COUNTH = 0x72;
+    const uint8_t MPU_FIFO_R_W = 0x74;
+    const uint8_t byteSize = 14; // accel XYZ, temperature, gyro XYZ
+
+    static const uint8_t FIFO_FRAME_SIZE = 12;     // accel XYZ + gyro XYZ, big endian
+    static const uint8_t FIFO_FRAMES_PER_READ = 2; // Wire buffer is 32 bytes, and so is RAM
+    static const uint8_t FIFO_MAX_FRAMES = 8;      // bound the bus time of one drain pass
+    static const uint16_t FIFO_CAPACITY = 1024;
+
+    bool fifoMode = false;
+    float gyroLsbPerDps = 131.0; // ±250°/s after reset
+    uint16_t fifoOverflows = 0;
+    uint32_t samplesDrained = 0;
+    void (*sampleHandler)(const ModelIMU &) = nullptr;
+    int16_t rawAccel[3];
+    uint8_t sampleBuffer[14];
+
+    // FIFO drain pass, shared by the blocking and the queued path
+    uint8_t fifoStatus = 0;
+    uint8_t fifoCount[2];
+    uint8_t fifoBuffer[FIFO_FRAME_SIZE * FIFO_FRAMES_PER_READ];
+    uint8_t fifoReset[2] = {0x04, 0x40}; // USER_CTRL: FIFO_RESET (clears FIFO_EN too), then FIFO_EN
+    uint8_t fifoFrames = 0;
+    uint8_t fifoDrained = 0;
+    int32_t fifoSum[6];
+    bool fifoStatusOk = false;
+    I2CBus *fifoBus = nullptr;
+
+    static volatile bool dataReady;
+    static void onDataReady() { dataReady = true; }
+
+    void writeRegister(uint8_t reg, uint8_t value)
+    {
+        Wire.beginTransmission(MPU_ADDR);
+        Wire.write(reg);
+        Wire.write(value);
+        Wire.endTransmission(true);
+    }
+
+    void resetFifo()
+    {
+        writeRegister(MPU_USER_CTRL, fifoReset[0]);
+        writeRegister(MPU_USER_CTRL, fifoReset[1]);
+    }
+
+    static void onSample(void *context, uint8_t status)
+    {
+        SensorMPU *self = static_cast<SensorMPU *>(context);
+        if (status == 0)
+            self->parseSample(self->sampleBuffer);
+        self->completeRead(status == 0);
+    }
+
+    void parseSample(const uint8_t *buffer)
+    {
+        for (uint8_t i = 0; i < 3; i++)
+            rawAccel[i] = (buffer[2 * i] << 8) | buffer[2 * i + 1];
+
+        imuData.xa = rawAccel[0];
+        imuData.ya = rawAccel[1];
+        imuData.za = rawAccel[2];
+        imuData.xg = (int16_t)((buffer[8] << 8) | buffer[9]) / gyroLsbPerDps;
+        imuData.yg = (int16_t)((buffer[10] << 8) | buffer[11]) / gyroLsbPerDps;
+        imuData.zg = (int16_t)((buffer[12] << 8) | buffer[13]) / gyroLsbPerDps;
+    }
+
+    friend class ImuBase<SensorMPU>;
+
+    /**
+     * @brief Polled samples keep their raw counts for the exact integer kernel; a
+     * FIFO batch average is not a whole count.
+     */
+    void computeTilt()
+    {
+        if (fifoMode)
+            tiltFromAccel(imuData.xa, imuData.ya, imuData.za, imuData.Accelroll, imuData.Accelpitch);
+        else
+            tiltFromRaw(rawAccel[0], rawAccel[1], rawAccel[2], imuData.Accelroll, imuData.Accelpitch);
+    }
+
+    /**
+     * @brief Start a drain pass from the INT_STATUS and FIFO_COUNT just read.
+     * @return false if the FIFO overflowed or lost its frame alignment; it then has to
+     * be reset, frames in it are not worth reading.
+     */
+    bool beginFifoPass()
+    {
+        fifoDrained = 0;
+        fifoFrames = 0;
+        memset(fifoSum, 0, sizeof(fifoSum));
+
+        uint16_t available = (fifoCount[0] << 8) | fifoCount[1];
+        if ((fifoStatus & 0x10) || available >= FIFO_CAPACITY - FIFO_FRAME_SIZE || available % FIFO_FRAME_SIZE != 0)
+        {
+            fifoOverflows++;
+            return false;
+        }
+
+        fifoFrames = available / FIFO_FRAME_SIZE;
+        if (fifoFrames > FIFO_MAX_FRAMES)
+        {
+            fifoFrames = FIFO_MAX_FRAMES;
+            dataReady = true; // leave the rest for the next pass
+        }
+        return true;
+    }
+
+    uint8_t nextFifoChunk() const
+    {
+        uint8_t chunk = fifoFrames - fifoDrained;
+        return chunk > FIFO_FRAMES_PER_READ ? FIFO_FRAMES_PER_READ : chunk;
+    }
+
+    /**
+     * @brief Hand every frame in fifoBuffer to the sample handler and add it to the batch.
+     */
+    void drainFifoChunk(uint8_t chunk)
+    {
+        for (uint8_t f = 0; f < chunk; f++)
+        {
+            int16_t raw[6];
+            parseFifoFrame(fifoBuffer + f * FIFO_FRAME_SIZE, raw);
+            for (uint8_t i = 0; i < 6; i++)
+                fifoSum[i] += raw[i];
+
+            if (sampleHandler)
+            {
+                ModelIMU sample;
+                sample.xa = raw[0];
+                sample.ya = raw[1];
+                sample.za = raw[2];
+                sample.xg = raw[3] / gyroLsbPerDps;
+                sample.yg = raw[4] / gyroLsbPerDps;
+                sample.zg = raw[5] / gyroLsbPerDps;
+                sampleHandler(sample);
+            }
+        }
+        fifoDrained += chunk;
+    }
+
+    bool endFifoPass()
+    {
+        if (fifoDrained == 0)
+            return false;
+
+        // Batch average is what the polled getters report
+        imuData.xa = (float)fifoSum[0] / fifoDrained;
+        imuData.ya = (float)fifoSum[1] / fifoDrained;
+        imuData.za = (float)fifoSum[2] / fifoDrained;
+        imuData.xg = (float)fifoSum[3] / fifoDrained / gyroLsbPerDps;
+        imuData.yg = (float)fifoSum[4] / fifoDrained / gyroLsbPerDps;
+        imuData.zg = (float)fifoSum[5] / fifoDrained / gyroLsbPerDps;
+        samplesDrained += fifoDrained;
+        return true;
+    }
+
+    bool updateFifo()
+    {
+        if (!dataReady)
+            return false; // nothing new since the last drain, no bus traffic needed
+        dataReady = false;
+
+        if (!safeReadIMU(MPU_ADDR, MPU_INT_STATUS, &fifoStatus, 1, 20) ||
+            !safeReadIMU(MPU_ADDR, MPU_FIFO_COUNTH, fifoCount, 2, 20))
+        {
+            return false;
+        }
+
+        if (!beginFifoPass())
+        {
+            resetFifo();
+            return false;
+        }
+
+        while (fifoDrained < fifoFrames)
+        {
+            uint8_t chunk = nextFifoChunk();
+            if (!safeReadIMU(MPU_ADDR, MPU_FIFO_R_W, fifoBuffer, chunk * FIFO_FRAME_SIZE, 20))
+            {
+                resetFifo();
+                break;
+            }
+            drainFifoChunk(chunk);
+        }
+        return endFifoPass();
+    }
+
+    /**
+     * @brief Queued drain: INT_STATUS and FIFO_COUNT, then one FIFO read per chunk,
+     * each queued from the previous one's callback.
+     */
+    bool submitFifoRead(I2CBus &bus)
+    {
+        if (!dataReady || bus.available() < 2)
+            return false;
+        dataReady = false;
+        fifoBus = &bus;
+        fifoStatusOk = false;
+
+        I2CTransaction status = {MPU_ADDR, MPU_INT_STATUS, &fifoStatus, 1, true, I2CPriority::URGENT, onFifoStatus, this};
+        I2CTransaction count = {MPU_ADDR, MPU_FIFO_COUNTH, fifoCount, 2, true, I2CPriority::URGENT, onFifoCount, this};
+        bus.submit(status);
+        bus.submit(count);
+        return true;
+    }
+
+    static void onFifoStatus(void *context, uint8_t status)
+    {
+        static_cast<SensorMPU *>(context)->fifoStatusOk = status == 0;
+    }
+
+    static void onFifoCount(void *context, uint8_t status)
+    {
+        SensorMPU *self = static_cast<SensorMPU *>(context);
+        if (status != 0 || !self->fifoStatusOk)
+            return self->completeRead(false); // the frames stay queued for the next INT
+
+        if (!self->beginFifoPass())
+        {
+            self->queueFifoReset();
+            return self->completeRead(false);
+        }
+        self->queueFifoChunk();
+    }
+
+    static void onFifoChunk(void *context, uint8_t status)
+    {
+        SensorMPU *self = static_cast<SensorMPU *>(context);
+        if (status != 0)
+        {
+            // Part of a frame may have been read, the alignment is gone
+            self->queueFifoReset();
+            return self->completeRead(self->endFifoPass());
+        }
+        self->drainFifoChunk(self->nextFifoChunk());
+        self->queueFifoChunk();
+    }
+
+    void queueFifoChunk()
+    {
+        if (fifoDrained < fifoFrames)
+        {
+            I2CTransaction t = {MPU_ADDR, MPU_FIFO_R_W, fifoBuffer, (uint8_t)(nextFifoChunk() * FIFO_FRAME_SIZE), true,
+                                I2CPriority::URGENT, onFifoChunk, this};
+            if (fifoBus->submit(t))
+                return;
+            dataReady = true; // bus full: the frames stay in the FIFO for the next pass
+        }
+        completeRead(endFifoPass());
+    }
+
+    void queueFifoReset()
+    {
+        I2CTransaction reset = {MPU_ADDR, MPU_USER_CTRL, &fifoReset[0], 1, false, I2CPriority::URGENT, nullptr, nullptr};
+        I2CTransaction enable = {MPU_ADDR, MPU_USER_CTRL, &fifoReset[1], 1, false, I2CPriority::URGENT, nullptr, nullptr};
+        fifoBus->submit(reset);
+        fifoBus->submit(enable);
+    }
+
+    bool readSample()
+    {
+        if (fifoMode)
+        {
+            return updateFifo();
+        }
+
+        uint32_t start = micros();
+        bool ok = safeReadIMU(MPU_ADDR, MPU_ACCEL_XOUT_H, sampleBuffer, byteSize, 20); // 20ms timeout only for IMU
+        if (supervisor)
+            supervisor->observe(MPU_ADDR, start, ok);
+        if (!ok)
+            return false;
+
+        parseSample(sampleBuffer);
+        return true;
+    }
+
+    bool submitRead(I2CBus &bus)
+    {
+        if (fifoMode)
+            return submitFifoRead(bus);
+
+        I2CTransaction t = {MPU_ADDR, MPU_ACCEL_XOUT_H, sampleBuffer, byteSize, true, I2CPriority::URGENT, onSample, this};
+        return bus.submit(t);
+    }
 
     bool safeReadIMU(uint8_t addr, uint8_t reg, uint8_t *data, uint8_t len, uint16_t timeoutMs)
     {
@@ -70,34 +348,48 @@ public:
         active = true;
     }
 
-    void update()
+    /**
+     * @brief Switch to FIFO acquisition: the MPU samples accel + gyro into its FIFO at
+     * 1 kHz / (1 + sampleRateDivider) and pulses INT on every sample. update() and
+     * requestUpdate() then only touch the bus after INT fired, and drain every queued
+     * frame through the sample handler.
+     *
+     * @param sampleRateDivider SMPLRT_DIV value, e.g. 99 for 10 Hz, 49 for 20 Hz.
+     */
+    void beginFifo(uint8_t sampleRateDivider)
     {
-        uint8_t buffer[6];
+        begin();
+        writeRegister(MPU_CONFIG, 0x03);     // DLPF 44 Hz, keeps the gyro output rate at 1 kHz
+        writeRegister(MPU_SMPLRT_DIV, sampleRateDivider);
+        writeRegister(MPU_FIFO_EN, 0x78);    // XG, YG, ZG, ACCEL
+        writeRegister(MPU_INT_PIN_CFG, 0x00); // active high, push-pull, 50 us pulse
+        writeRegister(MPU_INT_ENABLE, 0x01); // DATA_RDY
+        resetFifo();
+
+        pinMode(MPU_INT_PIN, INPUT);
+        attachInterrupt(digitalPinToInterrupt(MPU_INT_PIN), onDataReady, RISING);
+        fifoMode = true;
+    }
 
-        if (!safeReadIMU(MPU_ADDR, MPU_ACCEL_XOUT_H, buffer, byteSize, 20)) // 20ms timeout only for IMU
+    /**
+     * @brief Decode one FIFO frame into raw accel XYZ and gyro XYZ counts.
+     */
+    static void parseFifoFrame(const uint8_t *frame, int16_t raw[6])
+    {
+        for (uint8_t i = 0; i < 6; i++)
         {
-            // i2cRecover();
-            return;
+            raw[i] = (int16_t)((frame[2 * i] << 8) | frame[2 * i + 1]);
         }
-
-        int16_t rawXa = (buffer[0] << 8) | buffer[1];
-        int16_t rawYa = (buffer[2] << 8) | buffer[3];
-        int16_t rawZa = (buffer[4] << 8) | buffer[5];
-
-        imuData.xa = rawXa;
-        imuData.ya = rawYa;
-        imuData.za = rawZa;
-
-        imuData.Accelroll = atan2(imuData.ya, imuData.za) * 180.0 / PI;
-        imuData.Accelpitch = atan2(-imuData.xa, sqrt(imuData.ya * imuData.ya + imuData.za * imuData.za)) * 180.0 / PI;
     }
 
-    float getAccelX() const { return imuData.xa; }
-    float getAccelY() const { return imuData.ya; }
-    float getAccelZ() const { return imuData.za; }
-    float getAccelRoll() const { return imuData.Accelroll; }
-    float getAccelPitch() const { return imuData.Accelpitch; }
-    ModelIMU getModelIMU() const { return imuData; }
+    /**
+     * @brief Called once per FIFO sample (gyro in °/s) while draining, so a consumer
+     * such as a fusion filter sees every sample at the configured rate.
+     */
+    void setSampleHandler(void (*handler)(const ModelIMU &)) { sampleHandler = handler; }
+
+    uint16_t getFifoOverflows() const { return fifoOverflows; }
+    uint32_t getSamplesDrained() const { return samplesDrained; }
 
     // Set accelerometer sensitivity (0=±2g, 1=±4g, 2=±8g, 3=±16g)
     void setAccelSensitivity(uint8_t level)
@@ -115,6 +407,7 @@ public:
         Wire.write(0x1B); // GYRO_CONFIG register
         Wire.write((level & 0x03) << 3);
         Wire.endTransmission(true);
+        gyroLsbPerDps = 131.0 / (1 << (level & 0x03));
     }
 
     // Set filter bandwidth (1-6 = 5Hz, 10Hz, 21Hz, 44Hz, 94Hz, 184Hz, 260Hz)
@@ -126,125 +419,15 @@ public:
         Wire.endTransmission(true);
     }
 
-    bool i2cRecover()
-    {
-        pinMode(SCL_PIN, OUTPUT);
-        pinMode(SDA_PIN, INPUT_PULLUP);
-
-        // Toggle clock up to 9 times to free SDA
-        for (uint8_t i = 0; i < 9; i++)
-        {
-            if (digitalRead(SDA_PIN) == HIGH)
-            {
-                break; // SDA released → bus is free
-            }
-            digitalWrite(SCL_PIN, LOW);
-            delayMicroseconds(5);
-            digitalWrite(SCL_PIN, HIGH);
-            delayMicroseconds(5);
-        }
-
-        // Generate STOP condition
-        pinMode(SDA_PIN, OUTPUT);
-        digitalWrite(SDA_PIN, LOW);
-        delayMicroseconds(5);
-        digitalWrite(SCL_PIN, HIGH);
-        delayMicroseconds(5);
-        digitalWrite(SDA_PIN, HIGH);
-        delayMicroseconds(5);
-
-        // Reinit I2C
-        Wire.end();
-        Wire.begin();
-        Wire.setWireTimeout(100000, true); // 25ms timeout, auto clear bus
-
-        // Check if SDA is released
-        return (digitalRead(SDA_PIN) == HIGH);
-    }
-
-    bool isActive() { return active; }
-
     void end()
     {
-        active = false;
-    }
-};
-
-#include <Adafruit_FXOS8700.h>
-
-class SensorFXOSFXAS
-{
-private:
-    Adafruit_FXOS8700 fxos = Adafruit_FXOS8700(0x8700A, 0x8700B);
-    bool active = false;
-    ModelIMU imuData;
-
-public:
-    SensorFXOSFXAS() {}
-    ~SensorFXOSFXAS() {}
-
-    void begin()
-    {
-        if (!fxos.begin())
-        {
-            active = false;
-            return;
-        }
-        active = true;
-    }
-
-    void update()
-    {
-        if (!active)
-            return;
-
-        sensors_event_t aevent, mevent;
-        fxos.getEvent(&aevent, &mevent);
-
-        // Basic sanity check (NaN or out-of-range values)
-        if (isnan(aevent.acceleration.x) || fabs(aevent.acceleration.x) > 100.0 ||
-            isnan(aevent.acceleration.y) || fabs(aevent.acceleration.y) > 100.0 ||
-            isnan(aevent.acceleration.z) || fabs(aevent.acceleration.z) > 100.0)
+        if (fifoMode)
         {
-            // Timeout or invalid read – try I2C recovery
-            Wire.end();
-            delay(10);
-            Wire.begin();
-            return;
+            detachInterrupt(digitalPinToInterrupt(MPU_INT_PIN));
+            fifoMode = false;
         }
-
-        imuData.xa = -1 * aevent.acceleration.y;
-        imuData.ya = aevent.acceleration.x;
-        imuData.za = aevent.acceleration.z;
-
-        // NOTE: FXOS8700 is only accel + mag, no gyro.
-        imuData.xg = 0;
-        imuData.yg = 0;
-        imuData.zg = 0;
-
-        imuData.Accelroll = atan2(imuData.ya, imuData.za) * 180.0 / PI;
-        imuData.Accelpitch = atan2(-imuData.xa, sqrt(imuData.ya * imuData.ya + imuData.za * imuData.za)) * 180.0 / PI;
-    }
-
-    float getAccelX() const { return imuData.xa; }
-    float getAccelY() const { return imuData.ya; }
-    float getAccelZ() const { return imuData.za; }
-    float getGyroX() const { return imuData.xg; }
-    float getGyroY() const { return imuData.yg; }
-    float getGyroZ() const { return imuData.zg; }
-    float getAccelRoll() const { return imuData.Accelroll; }
-    float getAccelPitch() const { return imuData.Accelpitch; }
-    ModelIMU getModelIMU() const { return imuData; }
-
-    // Dummy functions for compatibility (not supported by Adafruit lib)
-    void setAccelSensitivity(uint8_t level) {}
-    void setGyroSensitivity(uint8_t level) {}
-    void setFilterBandwidth(uint8_t level) {}
-
-    bool isActive() { return active; }
-
-    void end()
-    {
         active = false;
     }
 };
+
+volatile bool SensorMPU::dataReady = false;
@@ -2,22 +2,75 @@
 
 #include "Arduino.h"
 #include "uRTCLib.h"
-
-struct timeObject
-{
-    byte second;
-    byte minute;
-    byte hour;
-    byte day;
-    byte month;
-    byte year;
-};
+#include "i2c_bus.h"
+#include "epoch_time.h"
 
 class SensorRTC
 {
 private:
-    timeObject tb;
+    const uint8_t RTC_ADDR = 0x68; // DS3231 and DS1307
+    timeObject tb = {0, 0, 0, 0, 0, 0}; // day 0: nothing read yet
     uRTCLib rtc;
+    uint8_t raw[7];
+    uint8_t setting[7]; // time registers being written by requestAdjust()
+    bool requestPending = false;
+    bool adjustPending = false;
+    bool fresh = false;
+    uint16_t rejected = 0;
+
+    static uint8_t bcd2bin(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+    static uint8_t bin2bcd(uint8_t v) { return (v / 10) << 4 | (v % 10); }
+    static bool isBcd(uint8_t v) { return (v & 0x0F) <= 9 && (v >> 4) <= 9; }
+
+    /**
+     * @brief Decode the seven time registers. false, with `out` untouched, when a field
+     * is not BCD or out of range: a glitched transfer or a stopped oscillator would
+     * otherwise rebase the clock onto a wrapped date.
+     */
+    static bool decode(const uint8_t *regs, timeObject &out)
+    {
+        if (regs[2] & 0x40)
+            return false; // 12h mode, never set by this firmware
+        for (uint8_t i = 0; i < 7; i++)
+        {
+            if (!isBcd(regs[i] & (i == 5 ? 0x1F : 0x7F))) // bit 7 is CH on DS1307, century on DS3231
+                return false;
+        }
+        uint8_t dow = regs[3] & 0x07;
+        if (dow < 1 || dow > 7)
+            return false;
+
+        timeObject t;
+        t.second = bcd2bin(regs[0] & 0x7F);
+        t.minute = bcd2bin(regs[1] & 0x7F);
+        t.hour = bcd2bin(regs[2] & 0x3F);
+        t.day = bcd2bin(regs[4] & 0x3F);
+        t.month = bcd2bin(regs[5] & 0x1F);
+        t.year = bcd2bin(regs[6]);
+        if (!isValidCalendar(t))
+            return false;
+        out = t;
+        return true;
+    }
+
+    static void onRead(void *context, uint8_t status)
+    {
+        SensorRTC *self = static_cast<SensorRTC *>(context);
+        self->requestPending = false;
+        if (status != 0)
+            return; // keep the last good time
+        if (!decode(self->raw, self->tb))
+        {
+            self->rejected++;
+            return;
+        }
+        self->fresh = true;
+    }
+
+    static void onAdjusted(void *context, uint8_t /* status */)
+    {
+        static_cast<SensorRTC *>(context)->adjustPending = false;
+    }
 
 public:
     void begin()
@@ -28,16 +81,92 @@ public:
         // rtc.set(0, 3, 21, 4, 20, 8, 25);
     }
 
-    timeObject getData()
+    timeObject getData() { return tb; }
+
+    /**
+     * @brief Last read time as an epoch in the RTC's own (local) zone.
+     */
+    epoch_t getEpoch() const { return fromCalendar(tb); }
+
+    /**
+     * @brief true once after each completed requestUpdate().
+     */
+    bool consumeFresh()
     {
-        tb.second = rtc.second();
-        tb.minute = rtc.minute();
-        tb.hour = rtc.hour();
-        tb.day = rtc.day();
-        tb.month = rtc.month();
-        tb.year = rtc.year();
-        return tb;
+        bool was = fresh;
+        fresh = false;
+        return was;
     }
 
-    void update() { rtc.refresh(); }
+    /**
+     * @brief Reads whose time failed validation and were dropped.
+     */
+    uint16_t getRejected() const { return rejected; }
+
+    /**
+     * @brief Blocking refresh through uRTCLib.
+     * @return false if the RTC returned an invalid time; getData() keeps the last good one.
+     */
+    bool update()
+    {
+        if (!rtc.refresh())
+            return false;
+        timeObject t;
+        t.second = rtc.second();
+        t.minute = rtc.minute();
+        t.hour = rtc.hour();
+        t.day = rtc.day();
+        t.month = rtc.month();
+        t.year = rtc.year();
+        if (!isValidCalendar(t) || rtc.dayOfWeek() < 1 || rtc.dayOfWeek() > 7)
+        {
+            rejected++;
+            return false;
+        }
+        tb = t;
+        return true;
+    }
+
+    /**
+     * @brief Queue a write that steps the RTC by a number of seconds from the last
+     * good read, at NORMAL priority like the reads. The step is taken relative to that
+     * read, so call it right after one completed; getData() moves along at once.
+     * @return false if no valid time has been read yet, a step is still on the bus or
+     * the queue is full; nothing changes then.
+     */
+    bool requestAdjust(I2CBus &bus, int32_t seconds)
+    {
+        if (adjustPending || !isValidCalendar(tb))
+            return false;
+
+        epoch_t epoch = getEpoch() + seconds;
+        timeObject t = toCalendar(epoch);
+        setting[0] = bin2bcd(t.second); // CH clear, keeps a DS1307 running
+        setting[1] = bin2bcd(t.minute);
+        setting[2] = bin2bcd(t.hour);                       // 24h mode
+        setting[3] = ((epoch / SECONDS_PER_DAY + 6) % 7) + 1; // 1 = Sunday, 2000-01-01 was a Saturday
+        setting[4] = bin2bcd(t.day);
+        setting[5] = bin2bcd(t.month);
+        setting[6] = bin2bcd(t.year);
+
+        I2CTransaction w = {RTC_ADDR, 0x00, setting, sizeof(setting), false, I2CPriority::NORMAL, onAdjusted, this};
+        if (!bus.submit(w))
+            return false;
+        adjustPending = true;
+        tb = t;
+        return true;
+    }
+
+    /**
+     * @brief Queue a read of the time registers on the bus; getData() picks up the
+     * result once the transaction has run.
+     */
+    void requestUpdate(I2CBus &bus)
+    {
+        if (requestPending)
+            return;
+
+        I2CTransaction t = {RTC_ADDR, 0x00, raw, sizeof(raw), true, I2CPriority::NORMAL, onRead, this};
+        requestPending = bus.submit(t);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include "imu.h"
+#include "tilt.h"
+
+/**
+ * @brief IMU driver without hardware: reports the accel and gyro a real sensor would
+ * see at the pose set through setAngles(). Lets the full firmware run on a bench
+ * board or host build with no IMU attached.
+ */
+class SimulatedIMU : public ImuBase<SimulatedIMU>
+{
+private:
+    float roll = 0;
+    float pitch = 0;
+    float lastRoll = 0;
+    float lastPitch = 0;
+    unsigned long lastUpdate = 0;
+
+    friend class ImuBase<SimulatedIMU>;
+
+    bool readSample()
+    {
+        unsigned long now = millis();
+        float dt = (now - lastUpdate) / 1000.0f;
+        lastUpdate = now;
+
+        float r = roll * DEG_TO_RAD;
+        float p = pitch * DEG_TO_RAD;
+        imuData.xa = -sin(p) * 9.80665f;
+        imuData.ya = cos(p) * sin(r) * 9.80665f;
+        imuData.za = cos(p) * cos(r) * 9.80665f;
+
+        // Small-angle body rates from the pose change since the last sample
+        imuData.xg = (dt > 0) ? (roll - lastRoll) / dt : 0;
+        imuData.yg = (dt > 0) ? (pitch - lastPitch) / dt : 0;
+        imuData.zg = 0;
+        lastRoll = roll;
+        lastPitch = pitch;
+        return true;
+    }
+
+    bool submitRead(I2CBus &)
+    {
+        completeRead(readSample()); // nothing on the bus, done at once
+        return false;
+    }
+
+public:
+    SimulatedIMU() {}
+    ~SimulatedIMU() {}
+
+    void begin()
+    {
+        lastUpdate = millis();
+        active = true;
+    }
+
+    /**
+     * @brief Set the simulated pose in degrees (same convention as Accelroll / Accelpitch).
+     */
+    void setAngles(float newRoll, float newPitch)
+    {
+        roll = newRoll;
+        pitch = newPitch;
+    }
+};
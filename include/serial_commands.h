@@ -0,0 +1,248 @@
+#pragma once
+
+#include <Arduino.h>
+#include "serial_frame.h"
+#include "control_tuning.h"
+#include "eeprom_writer.h"
+#include "imu_calibration.h"
+
+/**
+ * @brief Binary command interface over the serial port for reading and writing the
+ * tuning parameters, using the same COBS + CRC-8 frames as the telemetry stream.
+ *
+ * Requests (type, payload) and replies:
+ *   0x10 DESCRIBE u8 id          -> 0x90 u8 id, u8 count, f32 value, min, max, name
+ *   0x11 GET u8 id               -> 0x91 u8 id, f32 value
+ *   0x12 SET u8 id, f32 value    -> 0x91 u8 id, f32 value as applied (clamped)
+ *   0x13 SAVE                    -> 0x93 once queued, the EEPROM write runs in the background
+ *   0x14 DEFAULTS                -> 0x94, RAM only until SAVE
+ *   0x15 PROFILE                 -> status text from the setStatusDump() callback:
+ *                                   profiler histograms (-D PROFILE), I2C device stats
+ *   0x16 CALIBRATE u8 action ... -> 0x96 u8 action, u8 status (bit n: point n captured,
+ *                                   bit 7: capturing), see setCalibration()
+ *        0/1 point, f32 roll, f32 pitch: start capturing that point at this pose
+ *        2: status only
+ *        3: solve and save          -> also f32 roll scale, roll offset, pitch scale, pitch offset
+ *   anything wrong               -> 0x7F u8 request type, u8 error
+ * A reply is dropped rather than waited for if the transmit buffer is full, so the
+ * host retries on timeout. See tools/tune.py.
+ */
+class SerialCommands
+{
+public:
+    enum Command : uint8_t
+    {
+        CMD_DESCRIBE = 0x10,
+        CMD_GET = 0x11,
+        CMD_SET = 0x12,
+        CMD_SAVE = 0x13,
+        CMD_DEFAULTS = 0x14,
+        CMD_PROFILE = 0x15,
+        CMD_CALIBRATE = 0x16,
+    };
+
+    enum CalibrateAction : uint8_t
+    {
+        CALIBRATE_POINT_0 = 0,
+        CALIBRATE_POINT_1 = 1,
+        CALIBRATE_STATUS = 2,
+        CALIBRATE_SOLVE = 3,
+    };
+    static const uint8_t REPLY = 0x80; // or'ed into the request type
+    static const uint8_t REPLY_ERROR = 0x7F;
+
+    enum Error : uint8_t
+    {
+        ERROR_COMMAND = 1, // unknown or unsupported request
+        ERROR_ID = 2,      // no such parameter
+        ERROR_VALUE = 3,   // short payload or NaN
+        ERROR_BUSY = 4,    // EEPROM writer full or capture running, retry
+    };
+
+    typedef void (*StatusDump)(Print &out);
+
+    SerialCommands(HardwareSerial &port, TuningTable &table, EepromWriter &writer);
+    ~SerialCommands();
+
+    /**
+     * @brief Writer of the PROFILE reply text; without one PROFILE is an unknown request.
+     */
+    void setStatusDump(StatusDump dump) { _statusDump = dump; }
+
+    /**
+     * @brief Enable CALIBRATE: capture feeds the IMU samples, calibration receives
+     * the solution and is saved. Without them CALIBRATE is an unknown request.
+     */
+    void setCalibration(TwoPointCapture *capture, ImuCalibration *calibration)
+    {
+        _capture = capture;
+        _calibration = calibration;
+    }
+
+    /**
+     * @brief Decode whatever has arrived and answer complete requests. Call from loop().
+     */
+    void service();
+
+private:
+    HardwareSerial &_port;
+    TuningTable &_table;
+    EepromWriter &_eeprom;
+    FrameReader _reader;
+    FrameWriter _writer;
+    StatusDump _statusDump = nullptr;
+    TwoPointCapture *_capture = nullptr;
+    ImuCalibration *_calibration = nullptr;
+
+    void handle();
+    void handleCalibrate();
+    void replyValue(uint8_t id);
+    void replyError(uint8_t error);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+SerialCommands::SerialCommands(HardwareSerial &port, TuningTable &table, EepromWriter &writer)
+    : _port(port), _table(table), _eeprom(writer) {}
+
+SerialCommands::~SerialCommands() {}
+
+void SerialCommands::service()
+{
+    // At most what is buffered now; the 64-byte receive ring bounds the time spent
+    while (_port.available() > 0)
+    {
+        if (_reader.feed(_port.read()))
+            handle();
+    }
+}
+
+void SerialCommands::handle()
+{
+    uint8_t id = _reader.get8(0);
+    switch (_reader.type())
+    {
+    case CMD_DESCRIBE:
+    {
+        char name[TuningTable::NAME_LENGTH + 1];
+        float value, min, max;
+        if (_reader.length() < 1 || !_table.describe(id, name, min, max))
+            return replyError(ERROR_ID);
+        _table.get(id, value);
+        _writer.begin(REPLY | CMD_DESCRIBE);
+        _writer.put8(id);
+        _writer.put8(_table.count());
+        _writer.putFloat(value);
+        _writer.putFloat(min);
+        _writer.putFloat(max);
+        for (uint8_t i = 0; name[i]; i++)
+            _writer.put8(name[i]);
+        _writer.end(_port);
+        return;
+    }
+    case CMD_GET:
+        if (_reader.length() < 1)
+            return replyError(ERROR_VALUE);
+        return replyValue(id);
+    case CMD_SET:
+    {
+        if (_reader.length() < 5)
+            return replyError(ERROR_VALUE);
+        float value = _reader.getFloat(1);
+        if (isnan(value))
+            return replyError(ERROR_VALUE);
+        if (!_table.set(id, value))
+            return replyError(ERROR_ID);
+        return replyValue(id);
+    }
+    case CMD_SAVE:
+        if (!_table.save(_eeprom))
+            return replyError(ERROR_BUSY);
+        break;
+    case CMD_DEFAULTS:
+        _table.defaults();
+        break;
+    case CMD_PROFILE:
+        if (!_statusDump)
+            return replyError(ERROR_COMMAND);
+        _statusDump(_port);
+        return;
+    case CMD_CALIBRATE:
+        return handleCalibrate();
+    default:
+        return replyError(ERROR_COMMAND);
+    }
+
+    _writer.begin(REPLY | _reader.type());
+    _writer.end(_port);
+}
+
+void SerialCommands::handleCalibrate()
+{
+    if (!_capture || !_calibration)
+        return replyError(ERROR_COMMAND);
+    if (_reader.length() < 1)
+        return replyError(ERROR_VALUE);
+
+    uint8_t action = _reader.get8(0);
+    switch (action)
+    {
+    case CALIBRATE_POINT_0:
+    case CALIBRATE_POINT_1:
+        if (_reader.length() < 9)
+            return replyError(ERROR_VALUE);
+        if (!_capture->start(action, _reader.getFloat(1), _reader.getFloat(5)))
+            return replyError(ERROR_VALUE);
+        break;
+    case CALIBRATE_STATUS:
+        break;
+    case CALIBRATE_SOLVE:
+    {
+        if (_capture->capturing())
+            return replyError(ERROR_BUSY);
+        // Solve into a copy so a failed save leaves the running calibration alone
+        ImuCalibration solved = *_calibration;
+        if (!_capture->solve(solved))
+            return replyError(ERROR_VALUE);
+        if (!solved.save(_eeprom))
+            return replyError(ERROR_BUSY);
+        *_calibration = solved;
+        break;
+    }
+    default:
+        return replyError(ERROR_VALUE);
+    }
+
+    _writer.begin(REPLY | CMD_CALIBRATE);
+    _writer.put8(action);
+    _writer.put8(_capture->captured() | (_capture->capturing() ? 0x80 : 0));
+    if (action == CALIBRATE_SOLVE)
+    {
+        _writer.putFloat(_calibration->roll.scale);
+        _writer.putFloat(_calibration->roll.offset);
+        _writer.putFloat(_calibration->pitch.scale);
+        _writer.putFloat(_calibration->pitch.offset);
+    }
+    _writer.end(_port);
+}
+
+void SerialCommands::replyValue(uint8_t id)
+{
+    float value;
+    if (!_table.get(id, value))
+        return replyError(ERROR_ID);
+    _writer.begin(REPLY | CMD_GET);
+    _writer.put8(id);
+    _writer.putFloat(value);
+    _writer.end(_port);
+}
+
+void SerialCommands::replyError(uint8_t error)
+{
+    _writer.begin(REPLY_ERROR);
+    _writer.put8(_reader.type());
+    _writer.put8(error);
+    _writer.end(_port);
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <Arduino.h>
+#include "crc8.h"
+
+/**
+ * @brief Builds one binary frame for the serial port: a type byte, the payload, a
+ * CRC-8 over both, COBS encoded and closed with a 0x00 delimiter.
+ *
+ * COBS replaces every zero in the frame with the distance to the next one, so the
+ * only zero on the wire is the delimiter and a receiver that starts mid-stream
+ * resynchronises on the next 0x00. Encoding happens in place: the payload is
+ * written one byte in, and the zeros are turned into the code chain on end().
+ * Multi-byte fields are little-endian.
+ */
+class FrameWriter
+{
+public:
+    // type + payload + CRC; encoded with code byte and delimiter that is 62 bytes,
+    // which fits the 63 free bytes of the AVR core's 64-byte transmit ring
+    static const uint8_t MAX_PAYLOAD = 60;
+
+    FrameWriter();
+    ~FrameWriter();
+
+    void begin(uint8_t type);
+    void put8(uint8_t value);
+    void put16(uint16_t value);
+    void put32(uint32_t value);
+    void putFloat(float value);
+
+    /**
+     * @brief Angle in 0.01° steps, saturated to int16.
+     */
+    void putAngle(float degrees);
+
+    /**
+     * @brief Encode and send the frame, but only if it fits the transmit buffer so
+     * the caller never waits on the UART.
+     * @return false if the frame was dropped (port busy or payload overflow).
+     */
+    bool end(HardwareSerial &port);
+
+    /**
+     * @brief Encoded size of the frame being built, delimiter included.
+     */
+    uint8_t encodedLength() const { return _length + 3; }
+
+private:
+    uint8_t _buffer[MAX_PAYLOAD + 2];
+    uint8_t _length = 0; // bytes after the leading code byte, CRC excluded
+    bool _overflow = false;
+};
+
+/**
+ * @brief Incremental decoder for frames built by FrameWriter. Feed it one received
+ * byte at a time; it keeps no more than one frame and never allocates.
+ */
+class FrameReader
+{
+public:
+    FrameReader();
+    ~FrameReader();
+
+    /**
+     * @return true when b completed a frame with a good CRC. type(), data() and
+     * length() then describe it until the next call.
+     */
+    bool feed(uint8_t b);
+
+    uint8_t type() const { return _buffer[0]; }
+    const uint8_t *data() const { return &_buffer[1]; }
+    uint8_t length() const { return _length; } // payload bytes, type and CRC excluded
+
+    uint8_t get8(uint8_t offset) const { return offset < _length ? data()[offset] : 0; }
+    uint16_t get16(uint8_t offset) const { return get8(offset) | (uint16_t)get8(offset + 1) << 8; }
+    uint32_t get32(uint8_t offset) const { return get16(offset) | (uint32_t)get16(offset + 2) << 16; }
+    float getFloat(uint8_t offset) const;
+
+    uint16_t getErrors() const { return _errors; }
+
+private:
+    uint8_t _buffer[FrameWriter::MAX_PAYLOAD];
+    uint8_t _received = 0;  // decoded bytes of the frame so far
+    uint8_t _length = 0;    // payload length of the last complete frame
+    uint8_t _remaining = 0; // bytes left in the current COBS block
+    bool _zeroPending = false;
+    bool _overflow = false;
+    uint16_t _errors = 0;
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+FrameWriter::FrameWriter() {}
+
+FrameWriter::~FrameWriter() {}
+
+void FrameWriter::begin(uint8_t type)
+{
+    _length = 0;
+    _overflow = false;
+    put8(type);
+}
+
+void FrameWriter::put8(uint8_t value)
+{
+    if (_length >= MAX_PAYLOAD - 1) // keep a byte for the CRC
+    {
+        _overflow = true;
+        return;
+    }
+    _buffer[1 + _length++] = value;
+}
+
+void FrameWriter::put16(uint16_t value)
+{
+    put8(value);
+    put8(value >> 8);
+}
+
+void FrameWriter::put32(uint32_t value)
+{
+    put16(value);
+    put16(value >> 16);
+}
+
+void FrameWriter::putFloat(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits)); // IEEE 754 single on AVR and the host alike
+    put32(bits);
+}
+
+void FrameWriter::putAngle(float degrees)
+{
+    put16((int16_t)constrain(lround(degrees * 100.0f), -32767L, 32767L));
+}
+
+bool FrameWriter::end(HardwareSerial &port)
+{
+    if (_overflow || port.availableForWrite() < encodedLength())
+        return false;
+
+    uint8_t end = 1 + _length;
+    _buffer[end] = crc8(&_buffer[1], _length);
+
+    uint8_t code = 0;
+    for (uint8_t i = 1; i <= end; i++)
+    {
+        if (_buffer[i] == 0)
+        {
+            _buffer[code] = i - code;
+            code = i;
+        }
+    }
+    _buffer[code] = end + 1 - code;
+    _buffer[end + 1] = 0;
+
+    port.write(_buffer, end + 2);
+    return true;
+}
+
+FrameReader::FrameReader() {}
+
+FrameReader::~FrameReader() {}
+
+bool FrameReader::feed(uint8_t b)
+{
+    if (b == 0)
+    {
+        bool complete = _received >= 2 && _remaining == 0 && !_overflow;
+        bool valid = complete && crc8(_buffer, _received - 1) == _buffer[_received - 1];
+        if (_received && !valid)
+            _errors++;
+        if (valid)
+            _length = _received - 2;
+
+        _received = 0;
+        _remaining = 0;
+        _zeroPending = false;
+        _overflow = false;
+        return valid;
+    }
+
+    uint8_t value = b;
+    if (_remaining == 0)
+    {
+        // Code byte: ends the previous block, which stood for a zero unless it was full
+        _remaining = b - 1;
+        bool zero = _zeroPending;
+        _zeroPending = b != 0xFF;
+        if (!zero)
+            return false;
+        value = 0;
+    }
+    else
+    {
+        _remaining--;
+    }
+
+    if (_received >= sizeof(_buffer))
+        _overflow = true;
+    else
+        _buffer[_received++] = value;
+    return false;
+}
+
+float FrameReader::getFloat(uint8_t offset) const
+{
+    uint32_t bits = get32(offset);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
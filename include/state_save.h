@@ -2,6 +2,8 @@
 
 #include <EEPROM.h>
 #include <user_interface.h>
+#include "eeprom_layout.h"
+#include "eeprom_ring.h"
 
 struct SystemStructure
 {
@@ -10,78 +12,145 @@ struct SystemStructure
     bool inEditMode;
     int xVal;
     int yVal;
+    ModeSelection modeSelection;
+    float poseX; // pose low-pass filter state, deg
+    float poseY;
 };
 
 class StateSave
 {
 private:
+    static const uint8_t VERSION = 2;
+
+    // On-EEPROM form, fixed-width so the layout does not depend on enum sizes
+    struct StoredState
+    {
+        uint8_t state;
+        uint8_t selection;
+        uint8_t inEditMode;
+        int8_t xVal;
+        int8_t yVal;
+        uint8_t modeSelection;
+        int16_t poseX; // 0.01 deg
+        int16_t poseY;
+    };
+
     SystemStructure _structure;
+    EepromRing<StoredState> _ring;
+    EepromWriter &_writer;
+
+    void setDefaults();
+    static bool isValid(const StoredState &stored);
+    bool readVersion1(StoredState &stored);
+    void eraseVersion1();
 
 public:
-    StateSave();
+    StateSave(EepromWriter &writer);
     ~StateSave();
 
-    void initialization();
+    /**
+     * @brief Load the newest valid state, or defaults if there is none. A state in
+     * the old fixed layout is queued into the ring once, then erased behind it.
+     * @return true if a stored state was found.
+     */
+    bool initialization();
     SystemStructure getState();
-    void updateState(SystemStructure newState);
+
+    /**
+     * @brief Queue newState for the ring; nothing is written if it did not change.
+     * @return false if nothing was queued: unchanged, the previous save is still
+     * being written or the writer is full. getState() then keeps the old state, so
+     * the caller sees the difference again on its next check and retries.
+     */
+    bool updateState(SystemStructure newState);
 };
 
-StateSave::StateSave() {}
+StateSave::StateSave(EepromWriter &writer) : _ring(EEPROM_STATE_ADDR, EEPROM_STATE_SIZE, VERSION), _writer(writer) { setDefaults(); }
 StateSave::~StateSave() {}
 
-void StateSave::initialization()
+void StateSave::setDefaults()
+{
+    _structure.state = AppState::AUTOMATIC;
+    _structure.selection = ManualSelection::X;
+    _structure.inEditMode = false;
+    _structure.xVal = 0;
+    _structure.yVal = 0;
+    _structure.modeSelection = ModeSelection::MANUAL;
+    _structure.poseX = 0;
+    _structure.poseY = 0;
+}
+
+bool StateSave::isValid(const StoredState &stored)
+{
+    return stored.state <= static_cast<uint8_t>(AppState::MANUAL) &&
+           stored.selection < static_cast<uint8_t>(ManualSelection::COUNT) &&
+           stored.modeSelection < static_cast<uint8_t>(ModeSelection::COUNT);
+}
+
+bool StateSave::readVersion1(StoredState &stored)
 {
-    bool isEmpty = true;
-    for (int i = 0; i < 5; i++)
+    uint8_t v1[EEPROM_STATE_V1_SIZE];
+    bool erased = true;
+    for (uint8_t i = 0; i < EEPROM_STATE_V1_SIZE; i++)
     {
-        if (EEPROM.read(i) != 255)
-        {
-            isEmpty = false;
-            break;
-        }
+        v1[i] = EEPROM.read(EEPROM_STATE_V1_ADDR + i);
+        erased &= v1[i] == 0xFF;
     }
+    if (erased)
+        return false;
+
+    stored.state = v1[0];
+    stored.selection = v1[1];
+    stored.inEditMode = v1[2] == 1 ? 1 : 0;
+    // The old loader read an unwritten setpoint (0xFF) as 0
+    stored.xVal = v1[3] == 0xFF ? 0 : (int8_t)v1[3];
+    stored.yVal = v1[4] == 0xFF ? 0 : (int8_t)v1[4];
+    stored.modeSelection = static_cast<uint8_t>(ModeSelection::MANUAL);
+    stored.poseX = 0;
+    stored.poseY = 0;
+    return true;
+}
+
+void StateSave::eraseVersion1()
+{
+    static const uint8_t ERASED[EEPROM_STATE_V1_SIZE] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    _writer.write(EEPROM_STATE_V1_ADDR, ERASED, sizeof(ERASED));
+}
 
-    if (isEmpty)
+bool StateSave::initialization()
+{
+    StoredState stored;
+    bool found = _ring.load(stored) && isValid(stored);
+    StoredState v1;
+    if (readVersion1(v1))
     {
-        _structure.state = AppState::AUTOMATIC;
-        _structure.selection = ManualSelection::X;
-        _structure.inEditMode = false;
-        _structure.xVal = 0;
-        _structure.yVal = 0;
-
-        EEPROM.write(0, 0); // AppState::AUTOMATIC
-        EEPROM.write(1, 0); // ManualSelection::X
-        EEPROM.write(2, 0); // inEditMode false
-        EEPROM.write(3, 0); // xVal
-        EEPROM.write(4, 0); // yVal
+        // The writer keeps order, so the erase lands after the ring record and a reset
+        // in between loses neither copy. With the writer full, both wait a boot.
+        bool moveIn = !found && isValid(v1);
+        if (moveIn)
+        {
+            stored = v1;
+            found = true;
+        }
+        if (!moveIn || _ring.save(v1, _writer))
+            eraseVersion1();
     }
-    else
+
+    if (!found)
     {
-        byte _tempAppstate = EEPROM.read(0);
-        if (_tempAppstate == 0)
-            _structure.state = AppState::AUTOMATIC;
-        else if (_tempAppstate == 1)
-            _structure.state = AppState::MANUAL;
-
-        byte _tempSelection = EEPROM.read(1);
-        if (_tempSelection == 0)
-            _structure.selection = ManualSelection::X;
-        else if (_tempSelection == 1)
-            _structure.selection = ManualSelection::Y;
-        else if (_tempSelection == 2)
-            _structure.selection = ManualSelection::BACK;
-        else if (_tempSelection == 3)
-            _structure.selection = ManualSelection::COUNT;
-
-        byte _tempEditMode = EEPROM.read(2);
-        _structure.inEditMode = (_tempEditMode == 1);
-
-        int8_t _tempXval = EEPROM.read(3);
-        _structure.xVal = (_tempXval == 255) ? 0 : _tempXval;
-
-        int8_t _tempYval = EEPROM.read(4);
-        _structure.yVal = (_tempYval == 255) ? 0 : _tempYval;
+        setDefaults();
+        return false;
     }
+
+    _structure.state = static_cast<AppState>(stored.state);
+    _structure.selection = static_cast<ManualSelection>(stored.selection);
+    _structure.inEditMode = stored.inEditMode == 1;
+    _structure.xVal = stored.xVal;
+    _structure.yVal = stored.yVal;
+    _structure.modeSelection = static_cast<ModeSelection>(stored.modeSelection);
+    _structure.poseX = stored.poseX * 0.01f;
+    _structure.poseY = stored.poseY * 0.01f;
+    return true;
 }
 
 SystemStructure StateSave::getState()
@@ -89,14 +158,19 @@ SystemStructure StateSave::getState()
     return _structure;
 }
 
-void StateSave::updateState(SystemStructure newState)
+bool StateSave::updateState(SystemStructure newState)
 {
+    StoredState stored;
+    stored.state = static_cast<uint8_t>(newState.state);
+    stored.selection = static_cast<uint8_t>(newState.selection);
+    stored.inEditMode = newState.inEditMode ? 1 : 0;
+    stored.xVal = static_cast<int8_t>(newState.xVal);
+    stored.yVal = static_cast<int8_t>(newState.yVal);
+    stored.modeSelection = static_cast<uint8_t>(newState.modeSelection);
+    stored.poseX = static_cast<int16_t>(constrain(newState.poseX, -300.0f, 300.0f) * 100);
+    stored.poseY = static_cast<int16_t>(constrain(newState.poseY, -300.0f, 300.0f) * 100);
+    if (!_ring.save(stored, _writer))
+        return false;
     _structure = newState;
-
-    // Write each field to EEPROM
-    EEPROM.write(0, static_cast<uint8_t>(_structure.state));
-    EEPROM.write(1, static_cast<uint8_t>(_structure.selection));
-    EEPROM.write(2, _structure.inEditMode ? 1 : 0);
-    EEPROM.write(3, static_cast<int8_t>(_structure.xVal));
-    EEPROM.write(4, static_cast<int8_t>(_structure.yVal));
-}
\ No newline at end of file
+    return true;
+}
@@ -1,6 +1,7 @@
 #include <Arduino.h>
-#include <sensor_rtc.h>
+#include <epoch_time.h>
 #include <math.h>
+#include "profiler.h"
 
 static inline float deg2rad(float d) { return d * (M_PI / 180.0f); }
 static inline float rad2deg(float r) { return r * (180.0f / M_PI); }
@@ -14,30 +15,36 @@ struct SeptyanJaya
 class SunTracker
 {
 public:
-    SunTracker();
-    void update(const timeObject &time);
+    /**
+     * @param zone The zone the RTC keeps, the same one TimeService uses.
+     */
+    SunTracker(TimeZone zone);
+    /**
+     * @brief Recompute sun angles for a UTC epoch.
+     */
+    void update(epoch_t utc);
     SeptyanJaya septyanUpdate(float azimuth, float elevation);
     float getAzimuth() const;
     float getElevation() const;
     int calculateDayOfYear(byte day, byte month, byte year);
+    float getTimezone() const { return _zone.offsetMinutes / 60.0f; }
 
 private:
     const float _latitude = -7.7657162;
     const float _longitude = 110.3702127;
-    const float _timezone = 7;
+    const TimeZone _zone;
     float _azimuth = 0;
     float _elevation = 0;
 
     void calculateSunAngles(int dayOfYear, float fractionalHour);
 };
 
-SunTracker::SunTracker() {}
+SunTracker::SunTracker(TimeZone zone) : _zone(zone) {}
 
-void SunTracker::update(const timeObject &time)
+void SunTracker::update(epoch_t utc)
 {
-    int dayOfYear = calculateDayOfYear(time.day, time.month, time.year);
-    float fractionalHour = time.hour + time.minute / 60.0 + time.second / 3600.0;
-    calculateSunAngles(dayOfYear, fractionalHour);
+    epoch_t local = _zone.toLocal(utc);
+    calculateSunAngles(dayOfYear(local), fractionalHour(local));
 }
 
 SeptyanJaya SunTracker::septyanUpdate(float azimuth, float elevation)
@@ -62,23 +69,13 @@ float SunTracker::getElevation() const
 
 int SunTracker::calculateDayOfYear(byte day, byte month, byte year)
 {
-    byte daysInMonth[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    uint16_t doy = 0;
-    uint16_t correctYear = 2000 + year;
-    if (correctYear % 4 == 0 && (correctYear % 100 != 0 || correctYear % 400 == 0))
-    {
-        daysInMonth[2] = 29;
-    }
-    for (byte i = 1; i < month; ++i)
-    {
-        doy += daysInMonth[i];
-    }
-    doy += day;
-    return doy;
+    return daysFromCivil(2000 + year, month, day) - daysFromCivil(2000 + year, 1, 1) + 1;
 }
 
 void SunTracker::calculateSunAngles(int dayOfYear, float fractionalHour)
 {
+    PROFILE_SCOPE(PROBE_SUN);
+
     // Convert latitude to radians for calculations
     float latRad = radians(_latitude);
 
@@ -90,7 +87,7 @@ void SunTracker::calculateSunAngles(int dayOfYear, float fractionalHour)
     double eot = 9.87 * sin(2 * B) - 7.53 * cos(B) - 1.5 * sin(B);
 
     // 3. Calculate Time Correction Factor (in minutes)
-    float lstm = 15.0 * _timezone; // Local Standard Time Meridian
+    float lstm = 15.0 * getTimezone(); // Local Standard Time Meridian
     double tcf = 4.0 * (_longitude - lstm) + eot;
 
     // 4. Calculate Local Solar Time (LST)
@@ -118,7 +115,8 @@ void SunTracker::calculateSunAngles(int dayOfYear, float fractionalHour)
 
 #define TEST_CASE
 #ifndef TEST_CASE
-SunTracker sunTracker;
+const TimeZone SIMULATED_TIME = {7 * 60};
+SunTracker sunTracker(SIMULATED_TIME);
 
 // Variables to hold the simulated time
 timeObject simulatedTime;
@@ -156,7 +154,7 @@ void loop()
         previousMillis = millis(); // Reset the timer
 
         // 1. Update the SunTracker with the current simulated time
-        sunTracker.update(simulatedTime);
+        sunTracker.update(SIMULATED_TIME.toUtc(fromCalendar(simulatedTime)));
 
         // 2. Get the results
         float azimuth = sunTracker.getAzimuth();
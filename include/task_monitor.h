@@ -0,0 +1,137 @@
+#pragma once
+
+// Must come before the first TaskScheduler include: start delay / overrun tracking,
+// layered priority schedulers and per-task catch-up policy
+#define _TASK_TIMECRITICAL
+#define _TASK_PRIORITY
+#define _TASK_SCHEDULING_OPTIONS
+#include <TaskScheduler.h>
+
+#include <Arduino.h>
+
+/**
+ * @brief Timing of one scheduled task.
+ */
+struct TaskStats
+{
+    const char *name;
+    uint32_t runs;
+    uint16_t minMicros;
+    uint16_t avgMicros; // moving average over ~16 runs
+    uint16_t maxMicros;
+    uint16_t lastLatenessMs; // how late the last run started against its schedule
+    uint16_t maxLatenessMs;
+    uint16_t overruns; // runs that started a full interval late or took longer than one
+};
+
+/**
+ * @brief Wraps TaskScheduler callbacks to measure how long each task runs, how late
+ * it starts, and how often it overruns its interval. Query with getStats() / find().
+ */
+class TaskMonitor
+{
+public:
+    static const uint8_t MAX_TASKS = 8;
+
+    TaskMonitor();
+    ~TaskMonitor();
+
+    /**
+     * @brief Register a task name.
+     * @return Id to pass to run(), or MAX_TASKS if the table is full.
+     */
+    uint8_t add(const char *name);
+
+    /**
+     * @brief Run fn on behalf of task and record its timing. Call from the task callback.
+     */
+    void run(uint8_t id, Task &task, void (*fn)());
+
+    const TaskStats *getStats(uint8_t id) const { return id < _count ? &_stats[id] : nullptr; }
+    const TaskStats *find(const char *name) const;
+    uint8_t getTaskCount() const { return _count; }
+
+    /**
+     * @brief Clear all counters, e.g. after boot so setup() work is not counted.
+     */
+    void reset();
+
+private:
+    TaskStats _stats[MAX_TASKS];
+    uint8_t _count = 0;
+
+    void record(TaskStats &s, uint32_t elapsed, long startDelay, long overrun, uint32_t intervalMs);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+TaskMonitor::TaskMonitor() {}
+
+TaskMonitor::~TaskMonitor() {}
+
+uint8_t TaskMonitor::add(const char *name)
+{
+    if (_count >= MAX_TASKS)
+        return MAX_TASKS;
+    memset(&_stats[_count], 0, sizeof(TaskStats));
+    _stats[_count].name = name;
+    _stats[_count].minMicros = 0xFFFF;
+    return _count++;
+}
+
+const TaskStats *TaskMonitor::find(const char *name) const
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (strcmp(_stats[i].name, name) == 0)
+            return &_stats[i];
+    }
+    return nullptr;
+}
+
+void TaskMonitor::reset()
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        const char *name = _stats[i].name;
+        memset(&_stats[i], 0, sizeof(TaskStats));
+        _stats[i].name = name;
+        _stats[i].minMicros = 0xFFFF;
+    }
+}
+
+void TaskMonitor::run(uint8_t id, Task &task, void (*fn)())
+{
+    uint32_t start = micros();
+    fn();
+    uint32_t elapsed = micros() - start;
+
+    if (id < _count)
+        record(_stats[id], elapsed, task.getStartDelay(), task.getOverrun(), task.getInterval());
+}
+
+void TaskMonitor::record(TaskStats &s, uint32_t elapsed, long startDelay, long overrun, uint32_t intervalMs)
+{
+    uint16_t micros16 = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+    if (s.runs == 0)
+        s.avgMicros = micros16;
+    else
+        s.avgMicros += ((int32_t)micros16 - s.avgMicros) / 16;
+    s.runs++;
+
+    if (micros16 < s.minMicros)
+        s.minMicros = micros16;
+    if (micros16 > s.maxMicros)
+        s.maxMicros = micros16;
+
+    uint16_t lateness = startDelay < 0 ? 0 : (startDelay > 0xFFFF ? 0xFFFF : startDelay);
+    s.lastLatenessMs = lateness;
+    if (lateness > s.maxLatenessMs)
+        s.maxLatenessMs = lateness;
+
+    // A negative overrun means the next run was already due when this one started
+    if (overrun < 0 || elapsed > intervalMs * 1000UL)
+        s.overruns++;
+}
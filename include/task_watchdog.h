@@ -0,0 +1,179 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+
+/**
+ * @brief Software supervisor in front of the hardware watchdog: every task checks
+ * in with a heartbeat, and the watchdog is fed only while every task has checked
+ * in within its own timeout. A task that stops running, or one that never returns,
+ * lets the watchdog expire.
+ *
+ * The watchdog runs in interrupt + reset mode. The first timeout raises WDT_vect,
+ * which records the task that was running, or else the first one overdue, in a
+ * .noinit record; the second timeout resets the CPU. begin() picks the record up
+ * after the reset, for getLastFailure().
+ */
+class TaskWatchdog
+{
+public:
+    static const uint8_t MAX_TASKS = 8;
+    static const uint8_t NO_TASK = 0xFF; // reset outside any task, e.g. in loop() itself
+
+    TaskWatchdog();
+    ~TaskWatchdog();
+
+    /**
+     * @brief Read and clear the record of the last watchdog reset.
+     * @return true if the previous reset was a watchdog reset.
+     */
+    bool begin();
+
+    /**
+     * @brief Register a task; ids are handed out in order, matching TaskMonitor::add().
+     * @param timeoutMs Longest gap between heartbeats that still counts as live.
+     */
+    uint8_t add(uint16_t timeoutMs);
+
+    /**
+     * @brief Enable the watchdog, treating every task as just checked in. Also the
+     * way back from the interrupt-only mode used by PowerDown.
+     */
+    void arm(uint8_t timeout = WDTO_120MS);
+
+    /**
+     * @brief Heartbeat at the start of a task; the task counts as running until done().
+     */
+    void beat(uint8_t id);
+    void done() { _running = NO_TASK; }
+
+    /**
+     * @brief Feed the watchdog if all tasks are live. Call from loop().
+     * @return false if a task is overdue and the watchdog is left to expire.
+     */
+    bool service();
+
+    /**
+     * @brief Task id recorded before the last watchdog reset, NO_TASK if it hung
+     * outside the tasks. Valid when begin() returned true.
+     */
+    uint8_t getLastFailure() const { return _lastFailure; }
+
+    /**
+     * @brief Called from ISR(WDT_vect).
+     */
+    static void onInterrupt();
+
+private:
+    static const uint16_t MAGIC = 0x5744; // "WD"
+
+    struct Failure
+    {
+        uint16_t magic;
+        uint8_t task;
+        uint8_t check; // ~task
+    };
+    static Failure _failure; // in .noinit, survives the reset
+    static TaskWatchdog *_active;
+
+    uint16_t _timeout[MAX_TASKS];
+    uint32_t _lastBeat[MAX_TASKS];
+    uint8_t _count = 0;
+    volatile uint8_t _running = NO_TASK;
+    uint8_t _lastFailure = NO_TASK;
+
+    uint8_t overdue(uint32_t now) const;
+    void onTimeout();
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+TaskWatchdog::Failure TaskWatchdog::_failure __attribute__((section(".noinit")));
+TaskWatchdog *TaskWatchdog::_active = nullptr;
+
+TaskWatchdog::TaskWatchdog() {}
+
+TaskWatchdog::~TaskWatchdog() {}
+
+bool TaskWatchdog::begin()
+{
+    bool failed = _failure.magic == MAGIC && _failure.check == (uint8_t)~_failure.task;
+    _lastFailure = failed ? _failure.task : NO_TASK;
+    _failure.magic = 0;
+    _active = this;
+    return failed;
+}
+
+uint8_t TaskWatchdog::add(uint16_t timeoutMs)
+{
+    if (_count >= MAX_TASKS)
+        return MAX_TASKS;
+    _timeout[_count] = timeoutMs;
+    _lastBeat[_count] = millis();
+    return _count++;
+}
+
+void TaskWatchdog::arm(uint8_t timeout)
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < _count; i++)
+        _lastBeat[i] = now;
+    _running = NO_TASK;
+
+    wdt_enable(timeout);
+    WDTCSR |= _BV(WDIE); // WDIE needs no timed sequence; with WDE set it is interrupt + reset
+}
+
+void TaskWatchdog::beat(uint8_t id)
+{
+    if (id >= _count)
+        return;
+    _lastBeat[id] = millis();
+    _running = id;
+}
+
+uint8_t TaskWatchdog::overdue(uint32_t now) const
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (now - _lastBeat[i] > _timeout[i])
+            return i;
+    }
+    return NO_TASK;
+}
+
+bool TaskWatchdog::service()
+{
+    if (overdue(millis()) != NO_TASK)
+        return false;
+    wdt_reset();
+    return true;
+}
+
+void TaskWatchdog::onInterrupt()
+{
+    // PowerDown uses the interrupt alone (WDE clear) as its wake-up timer
+    if (_active && (WDTCSR & _BV(WDE)))
+        _active->onTimeout();
+}
+
+void TaskWatchdog::onTimeout()
+{
+    uint8_t task = _running != NO_TASK ? _running : overdue(millis());
+    _failure.task = task;
+    _failure.check = ~task;
+    _failure.magic = MAGIC;
+    // Wait for the reset one timeout later. Returning could let a loop that recovers
+    // feed the watchdog with WDIE already cleared by hardware, and the next hang
+    // would then reset without a record.
+    for (;;)
+        ;
+}
+
+ISR(WDT_vect)
+{
+    TaskWatchdog::onInterrupt();
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "epoch_time.h"
+
+/**
+ * @brief Fault bits carried in every telemetry sample (6 bits available).
+ */
+enum TelemetryFault : uint8_t
+{
+    TELEMETRY_FAULT_IMU = 0x01,     // IMU driver not active
+    TELEMETRY_FAULT_I2C = 0x02,     // bus recovery since the previous sample
+    TELEMETRY_FAULT_OVERRUN = 0x04, // previous record was still being written, one sample lost
+};
+
+struct TelemetrySample
+{
+    epoch_t time; // UTC
+    float poseX;
+    float poseY;
+    float setpointX;
+    float setpointY;
+    uint8_t ldrAverage;
+    uint8_t mode;   // AppState, 2 bits
+    uint8_t faults; // TelemetryFault bits
+};
+
+/**
+ * @brief Flight recorder for the tracker: a ring of fixed 8-byte records in EEPROM
+ * that survives resets and brown-outs.
+ *
+ * Records are delta encoded in time. A KEY record holds the full epoch; SAMPLE
+ * records hold the time since the previous record in 4 s units, pose and setpoint
+ * in 0.5° steps, LDR average, mode and fault bits. A KEY is written after boot,
+ * every KEY_EVERY records and whenever the gap does not fit in a SAMPLE. With the
+ * default 704 bytes that is 88 records, ~7 h at one sample per 5 min.
+ *
+ * Byte 7 of the first KEY after a reset is 0x80 | task id (0x7F outside any task)
+ * when the reset came from TaskWatchdog, otherwise 0.
+ *
+ * Byte 0 of each record is the header: bit 7 set for KEY, bits 0..6 a sequence
+ * number modulo 127, so 0xFF never is a valid header. The header is erased first and
+ * written last, so a record torn by a reset reads as invalid. The newest record is
+ * the last one of the run of consecutive sequence numbers.
+ *
+ * Writes never block: log() only encodes into a small buffer, and service() writes
+ * one byte per call once the EEPROM is ready, so the ~3.3 ms per byte runs in the
+ * background. See tools/telemetry_decode.py for the host side.
+ */
+class TelemetryLog
+{
+public:
+    static const uint8_t RECORD_SIZE = 8;
+    static const uint8_t KEY_EVERY = 16;
+    static const uint8_t TIME_UNIT = 4; // s per SAMPLE time step
+
+    TelemetryLog(int address, int size);
+    ~TelemetryLog();
+
+    /**
+     * @brief Find the newest record and continue after it.
+     * @param intervalSeconds Time between samples, at most 255 * TIME_UNIT.
+     */
+    void begin(uint16_t intervalSeconds = 300);
+
+    void setInterval(uint16_t intervalSeconds) { _interval = intervalSeconds; }
+
+    /**
+     * @brief Note in the boot KEY that this reset was a watchdog reset in task.
+     */
+    void setWatchdogReset(uint8_t task) { _resetCause = 0x80 | (task & 0x7F); }
+
+    /**
+     * @brief true when the sampling interval has passed since the last sample.
+     */
+    bool due(epoch_t now) const { return !_started || now - _lastSample >= _interval; }
+
+    /**
+     * @brief Queue one sample (and a KEY before it if needed).
+     * @return false if the previous record is still being written; the next sample
+     * then carries TELEMETRY_FAULT_OVERRUN.
+     */
+    bool log(const TelemetrySample &sample);
+
+    /**
+     * @brief Write at most one byte if the EEPROM is idle. Call from loop().
+     */
+    void service();
+
+    bool busy() const { return _pendingLength != 0; }
+
+    /**
+     * @brief Print the raw ring as hex, 16 bytes per line, for the host decoder.
+     */
+    void dump(Print &out) const;
+
+private:
+    static const uint8_t NO_HEADER = 0xFF;
+    static const uint8_t SEQUENCE_MODULO = 127;
+
+    int _address;
+    uint8_t _slots;
+    uint16_t _interval = 300;
+
+    uint8_t _nextSlot = 0;
+    uint8_t _sequence = 0;
+    uint8_t _sinceKey = KEY_EVERY;
+    bool _started = false;
+    bool _overrun = false;
+    uint8_t _resetCause = 0;
+    epoch_t _lastSample = 0; // time of the last sample asked for
+    epoch_t _lastTime = 0;   // time as the decoder will reconstruct it
+
+    // Up to a KEY and a SAMPLE, written in order: erase header, body, header
+    uint8_t _pending[2 * RECORD_SIZE];
+    uint8_t _pendingSlot[2];
+    uint8_t _pendingLength = 0;
+    uint8_t _pendingStep = 0;
+
+    uint8_t *cell(uint8_t slot, uint8_t offset) const { return (uint8_t *)(uintptr_t)(_address + slot * RECORD_SIZE + offset); }
+    uint8_t *queue();
+    static int8_t toHalfDegrees(float angle);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+TelemetryLog::TelemetryLog(int address, int size)
+    : _address(address), _slots(size / RECORD_SIZE) {}
+
+TelemetryLog::~TelemetryLog() {}
+
+void TelemetryLog::begin(uint16_t intervalSeconds)
+{
+    _interval = intervalSeconds;
+
+    // The newest record ends the run of consecutive sequence numbers
+    int16_t newest = -1;
+    uint8_t newestSequence = 0;
+    for (uint8_t slot = 0; slot < _slots; slot++)
+    {
+        uint8_t header = eeprom_read_byte(cell(slot, 0));
+        if (header == NO_HEADER)
+            continue;
+        uint8_t sequence = header & 0x7F;
+        if (newest < 0 || sequence == (newestSequence + 1) % SEQUENCE_MODULO)
+        {
+            newest = slot;
+            newestSequence = sequence;
+        }
+    }
+
+    _nextSlot = (newest < 0) ? 0 : (newest + 1) % _slots;
+    _sequence = (newest < 0) ? 0 : (newestSequence + 1) % SEQUENCE_MODULO;
+    _sinceKey = KEY_EVERY; // start every boot with a KEY
+    _started = false;
+}
+
+int8_t TelemetryLog::toHalfDegrees(float angle)
+{
+    return (int8_t)constrain(lround(angle * 2.0f), -127, 127);
+}
+
+uint8_t *TelemetryLog::queue()
+{
+    uint8_t *record = &_pending[_pendingLength];
+    _pendingSlot[_pendingLength / RECORD_SIZE] = _nextSlot;
+    _pendingLength += RECORD_SIZE;
+    _nextSlot = (_nextSlot + 1) % _slots;
+    return record;
+}
+
+bool TelemetryLog::log(const TelemetrySample &sample)
+{
+    _lastSample = sample.time;
+    if (busy() || _slots < 2)
+    {
+        _overrun = true;
+        return false;
+    }
+
+    uint8_t modeFaults = (sample.mode << 6) | (sample.faults & 0x3F);
+    if (_overrun)
+        modeFaults |= TELEMETRY_FAULT_OVERRUN;
+    _overrun = false;
+
+    uint32_t elapsed = sample.time - _lastTime;
+    if (!_started || _sinceKey >= KEY_EVERY || sample.time < _lastTime || elapsed > 255UL * TIME_UNIT)
+    {
+        uint8_t *key = queue();
+        key[0] = 0x80 | _sequence;
+        key[1] = sample.time;
+        key[2] = sample.time >> 8;
+        key[3] = sample.time >> 16;
+        key[4] = sample.time >> 24;
+        key[5] = modeFaults;
+        key[6] = _started ? 0 : 1; // 1: first record after a reset
+        key[7] = _started ? 0 : _resetCause;
+        _sequence = (_sequence + 1) % SEQUENCE_MODULO;
+        _sinceKey = 0;
+        _lastTime = sample.time;
+        elapsed = 0;
+    }
+
+    uint8_t steps = (elapsed + TIME_UNIT / 2) / TIME_UNIT;
+    uint8_t *record = queue();
+    record[0] = _sequence;
+    record[1] = steps;
+    record[2] = toHalfDegrees(sample.poseX);
+    record[3] = toHalfDegrees(sample.poseY);
+    record[4] = toHalfDegrees(sample.setpointX);
+    record[5] = toHalfDegrees(sample.setpointY);
+    record[6] = sample.ldrAverage;
+    record[7] = modeFaults;
+    _sequence = (_sequence + 1) % SEQUENCE_MODULO;
+    _sinceKey++;
+    _lastTime += (uint32_t)steps * TIME_UNIT; // same rounding as the decoder
+
+    _started = true;
+    _pendingStep = 0;
+    return true;
+}
+
+void TelemetryLog::service()
+{
+    if (!busy() || !eeprom_is_ready())
+        return;
+
+    // Per record: step 0 erases the header, 1..7 write the body, 8 writes the header
+    uint8_t record = _pendingStep / (RECORD_SIZE + 1);
+    uint8_t step = _pendingStep % (RECORD_SIZE + 1);
+    uint8_t slot = _pendingSlot[record];
+    const uint8_t *bytes = &_pending[record * RECORD_SIZE];
+
+    uint8_t offset = (step == 0 || step == RECORD_SIZE) ? 0 : step;
+    uint8_t value = (step == 0) ? NO_HEADER : bytes[offset];
+    if (eeprom_read_byte(cell(slot, offset)) != value)
+        eeprom_write_byte(cell(slot, offset), value); // starts the write and returns
+
+    _pendingStep++;
+    if (_pendingStep >= (_pendingLength / RECORD_SIZE) * (RECORD_SIZE + 1))
+    {
+        _pendingLength = 0;
+        _pendingStep = 0;
+    }
+}
+
+void TelemetryLog::dump(Print &out) const
+{
+    for (uint16_t i = 0; i < (uint16_t)_slots * RECORD_SIZE; i++)
+    {
+        uint8_t b = eeprom_read_byte((uint8_t *)(uintptr_t)(_address + i));
+        if (b < 0x10)
+            out.print('0');
+        out.print(b, HEX);
+        out.print((i % 16 == 15) ? '\n' : ' ');
+    }
+}
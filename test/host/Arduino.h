@@ -0,0 +1,324 @@
+#pragma once
+
+// Host stand-in for the Arduino core, enough for the headers under include/ to build
+// and run in [env:native] tests. Time only moves when a test (or delay()) moves it.
+// Every test suite is a single translation unit, so state lives in function statics.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+
+enum
+{
+    A0 = 14,
+    A1,
+    A2,
+    A3,
+    A4,
+    A5,
+    A6,
+    A7
+};
+#define NUM_HOST_PINS 22
+
+// ------------------------------
+// Host clock
+// ------------------------------
+
+inline uint32_t &hostMicros()
+{
+    static uint32_t now = 0;
+    return now;
+}
+
+inline void hostAdvanceMicros(uint32_t us) { hostMicros() += us; }
+inline void hostAdvanceMillis(uint32_t ms) { hostMicros() += ms * 1000UL; }
+
+inline uint32_t micros() { return hostMicros(); }
+inline uint32_t millis() { return hostMicros() / 1000UL; }
+inline void delay(uint32_t ms) { hostAdvanceMillis(ms); }
+inline void delayMicroseconds(unsigned int us) { hostAdvanceMicros(us); }
+
+// ------------------------------
+// Pins, all read HIGH (pulled up) until a test drives them
+// ------------------------------
+
+struct HostPins
+{
+    uint8_t mode[NUM_HOST_PINS];
+    uint8_t level[NUM_HOST_PINS];
+    int analog[NUM_HOST_PINS];
+    void (*isr[2])();
+    uint8_t isrMode[2];
+
+    HostPins()
+    {
+        memset(mode, INPUT, sizeof(mode));
+        memset(level, HIGH, sizeof(level));
+        memset(analog, 0, sizeof(analog));
+        isr[0] = isr[1] = nullptr;
+        isrMode[0] = isrMode[1] = 0;
+    }
+};
+
+inline HostPins &hostPins()
+{
+    static HostPins pins;
+    return pins;
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < NUM_HOST_PINS)
+        hostPins().mode[pin] = mode;
+}
+
+inline int digitalRead(uint8_t pin) { return pin < NUM_HOST_PINS ? hostPins().level[pin] : LOW; }
+
+inline void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < NUM_HOST_PINS)
+        hostPins().level[pin] = value ? HIGH : LOW;
+}
+
+inline int analogRead(uint8_t pin) { return pin < NUM_HOST_PINS ? hostPins().analog[pin] : 0; }
+inline void analogWrite(uint8_t pin, int value) { digitalWrite(pin, value > 127); }
+
+inline int8_t digitalPinToInterrupt(uint8_t pin) { return pin == 2 ? 0 : (pin == 3 ? 1 : -1); }
+
+inline void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode)
+{
+    if (interrupt < 2)
+    {
+        hostPins().isr[interrupt] = isr;
+        hostPins().isrMode[interrupt] = mode;
+    }
+}
+
+inline void detachInterrupt(uint8_t interrupt)
+{
+    if (interrupt < 2)
+        hostPins().isr[interrupt] = nullptr;
+}
+
+/**
+ * @brief Run the handler attached to an external interrupt, as the edge would.
+ */
+inline void hostRaiseInterrupt(uint8_t interrupt)
+{
+    if (interrupt < 2 && hostPins().isr[interrupt])
+        hostPins().isr[interrupt]();
+}
+
+// ------------------------------
+// Print / Stream, formatting as the AVR core does it
+// ------------------------------
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+        {
+            if (write(*buffer++))
+                n++;
+            else
+                break;
+        }
+        return n;
+    }
+    size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+    size_t print(const char s[]) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char b, int base = DEC) { return print((unsigned long)b, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC)
+    {
+        if (base == 0)
+            return write((uint8_t)n);
+        if (base == 10 && n < 0)
+        {
+            size_t t = print('-');
+            return printNumber(-(unsigned long)n, 10) + t;
+        }
+        return printNumber(n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) { return base == 0 ? write((uint8_t)n) : printNumber(n, base); }
+    size_t print(double n, int digits = 2) { return printFloat(n, digits); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    template <typename T>
+    size_t println(T value, int format)
+    {
+        size_t n = print(value, format);
+        return n + println();
+    }
+
+private:
+    size_t printNumber(unsigned long n, uint8_t base)
+    {
+        char buf[8 * sizeof(long) + 1];
+        char *str = &buf[sizeof(buf) - 1];
+        *str = '\0';
+        if (base < 2)
+            base = 10;
+        do
+        {
+            char c = n % base;
+            n /= base;
+            *--str = c < 10 ? c + '0' : c + 'A' - 10;
+        } while (n);
+        return write(str);
+    }
+
+    size_t printFloat(double number, uint8_t digits)
+    {
+        if (isnan(number))
+            return print("nan");
+        if (isinf(number))
+            return print("inf");
+        if (number > 4294967040.0 || number < -4294967040.0)
+            return print("ovf");
+
+        size_t n = 0;
+        if (number < 0.0)
+        {
+            n += print('-');
+            number = -number;
+        }
+
+        double rounding = 0.5;
+        for (uint8_t i = 0; i < digits; ++i)
+            rounding /= 10.0;
+        number += rounding;
+
+        unsigned long intPart = (unsigned long)number;
+        double remainder = number - (double)intPart;
+        n += print(intPart);
+        if (digits > 0)
+            n += print('.');
+        while (digits-- > 0)
+        {
+            remainder *= 10.0;
+            unsigned int toPrint = (unsigned int)remainder;
+            n += print(toPrint);
+            remainder -= toPrint;
+        }
+        return n;
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/**
+ * @brief Serial port with both directions in RAM: the firmware's output collects in
+ * `tx`, a test queues the firmware's input with hostReceive(). TX space is what the
+ * AVR core has, 63 bytes free, refilled by hostDrain().
+ */
+class HardwareSerial : public Stream
+{
+public:
+    static const uint16_t BUFFER = 1024;
+    static const uint8_t TX_RING = 63;
+
+    uint8_t tx[BUFFER];
+    uint16_t txLength = 0;
+    uint8_t txQueued = 0; // bytes not yet "sent" by the UART
+
+    void begin(unsigned long) {}
+    void end() {}
+    operator bool() { return true; }
+
+    size_t write(uint8_t c) override
+    {
+        if (txLength < BUFFER)
+            tx[txLength++] = c;
+        if (txQueued < TX_RING)
+            txQueued++;
+        return 1;
+    }
+    using Print::write;
+    int availableForWrite() override { return TX_RING - txQueued; }
+    void flush() override { txQueued = 0; }
+
+    int available() override { return _rxLength - _rxHead; }
+    int read() override { return _rxHead < _rxLength ? _rx[_rxHead++] : -1; }
+    int peek() override { return _rxHead < _rxLength ? _rx[_rxHead] : -1; }
+
+    void hostReceive(const uint8_t *data, uint16_t length)
+    {
+        for (uint16_t i = 0; i < length && _rxLength < BUFFER; i++)
+            _rx[_rxLength++] = data[i];
+    }
+    void hostDrain() { txQueued = 0; }
+    void hostClear()
+    {
+        txLength = 0;
+        txQueued = 0;
+        _rxHead = _rxLength = 0;
+    }
+
+private:
+    uint8_t _rx[BUFFER];
+    uint16_t _rxHead = 0;
+    uint16_t _rxLength = 0;
+};
+
+static HardwareSerial Serial;
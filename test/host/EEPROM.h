@@ -0,0 +1,35 @@
+#pragma once
+
+// Host stand-in for the EEPROM library, on top of avr/eeprom.h
+
+#include <avr/eeprom.h>
+
+class EEPROMClass
+{
+public:
+    uint8_t read(int address) { return eeprom_read_byte((const uint8_t *)(uintptr_t)address); }
+    void write(int address, uint8_t value) { eeprom_write_byte((uint8_t *)(uintptr_t)address, value); }
+    void update(int address, uint8_t value) { eeprom_update_byte((uint8_t *)(uintptr_t)address, value); }
+    uint16_t length() { return HostEeprom::SIZE; }
+
+    template <typename T>
+    T &get(int address, T &value)
+    {
+        uint8_t *p = (uint8_t *)&value;
+        for (uint16_t i = 0; i < sizeof(T); i++)
+            p[i] = read(address + i);
+        return value;
+    }
+
+    // Like the library: only cells that differ are written
+    template <typename T>
+    const T &put(int address, const T &value)
+    {
+        const uint8_t *p = (const uint8_t *)&value;
+        for (uint16_t i = 0; i < sizeof(T); i++)
+            update(address + i, p[i]);
+        return value;
+    }
+};
+
+static EEPROMClass EEPROM;
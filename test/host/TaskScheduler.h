@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for TaskScheduler: no scheduler, only the timing a Task reports after
+// a run, which TaskMonitor reads. A test sets the fields to what the scheduler would.
+
+#include <Arduino.h>
+
+class Task
+{
+public:
+    long startDelay = 0;    // ms the run started after its schedule
+    long overrun = 0;       // negative when the next run was already due
+    unsigned long interval; // ms
+
+    Task(unsigned long intervalMs = 0) : interval(intervalMs) {}
+
+    long getStartDelay() { return startDelay; }
+    long getOverrun() { return overrun; }
+    unsigned long getInterval() { return interval; }
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+// Host stand-in for the Wire library, transferring to the devices in i2c_device.h
+
+#include <Arduino.h>
+#include "i2c_device.h"
+
+class TwoWire
+{
+public:
+    static const uint8_t BUFFER_LENGTH = 32;
+
+    void begin() {}
+    void end() {}
+    void setClock(uint32_t clock) { _clock = clock; }
+    void setWireTimeout(uint32_t timeout = 25000, bool /* reset */ = false) { _timeout = timeout; }
+    bool getWireTimeoutFlag() const { return _timeoutFlag; }
+    void clearWireTimeoutFlag() { _timeoutFlag = false; }
+
+    void beginTransmission(uint8_t address)
+    {
+        _address = address;
+        _txLength = 0;
+    }
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+
+    size_t write(uint8_t value)
+    {
+        if (_txLength >= BUFFER_LENGTH)
+            return 0;
+        _tx[_txLength++] = value;
+        return 1;
+    }
+    size_t write(const uint8_t *data, size_t length)
+    {
+        size_t n = 0;
+        while (n < length && write(data[n]))
+            n++;
+        return n;
+    }
+
+    uint8_t endTransmission(bool sendStop = true)
+    {
+        HostI2CDevice *device = hostI2C().at(_address);
+        if (device && device->holdsClock)
+        {
+            hostAdvanceMicros(_timeout);
+            _timeoutFlag = true;
+            return 5;
+        }
+        if (!device || !device->start(false))
+            return 2;
+        for (uint8_t i = 0; i < _txLength; i++)
+        {
+            if (!device->write(_tx[i]))
+                return 3;
+        }
+        if (sendStop)
+            device->stop();
+        hostAdvanceMicros(byteMicros() * (_txLength + 1));
+        return 0;
+    }
+    uint8_t endTransmission(uint8_t sendStop) { return endTransmission((bool)sendStop); }
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true)
+    {
+        _rxHead = _rxLength = 0;
+        HostI2CDevice *device = hostI2C().at(address);
+        if (device && device->holdsClock)
+        {
+            hostAdvanceMicros(_timeout);
+            _timeoutFlag = true;
+            return 0;
+        }
+        if (!device || !device->start(true))
+            return 0;
+        if (quantity > BUFFER_LENGTH)
+            quantity = BUFFER_LENGTH;
+        for (uint8_t i = 0; i < quantity; i++)
+            _rx[_rxLength++] = device->read();
+        if (sendStop)
+            device->stop();
+        hostAdvanceMicros(byteMicros() * (quantity + 1));
+        return quantity;
+    }
+    uint8_t requestFrom(int address, int quantity, int sendStop = 1) { return requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)sendStop); }
+
+    int available() { return _rxLength - _rxHead; }
+    int read() { return _rxHead < _rxLength ? _rx[_rxHead++] : -1; }
+
+private:
+    uint8_t _address = 0;
+    uint8_t _tx[BUFFER_LENGTH];
+    uint8_t _txLength = 0;
+    uint8_t _rx[BUFFER_LENGTH];
+    uint8_t _rxHead = 0;
+    uint8_t _rxLength = 0;
+    uint32_t _clock = 100000;
+    uint32_t _timeout = 25000;
+    bool _timeoutFlag = false;
+
+    uint32_t byteMicros() const { return 9000000UL / _clock; }
+};
+
+static TwoWire Wire;
@@ -0,0 +1,66 @@
+#pragma once
+
+// Host stand-in for the ATmega328P EEPROM: 1 KiB, erased to 0xFF, with a write count
+// per cell. A byte write keeps the EEPROM busy for 3.4 ms of host time, like the part.
+
+#include <stdint.h>
+#include <string.h>
+#include <Arduino.h>
+
+struct HostEeprom
+{
+    static const uint16_t SIZE = 1024;
+    static const uint32_t WRITE_MICROS = 3400;
+
+    uint8_t data[SIZE];
+    uint32_t writes[SIZE];
+    uint32_t totalWrites = 0;
+    uint32_t busyUntil = 0;
+
+    HostEeprom() { erase(); }
+
+    void erase()
+    {
+        memset(data, 0xFF, sizeof(data));
+        memset(writes, 0, sizeof(writes));
+        totalWrites = 0;
+        busyUntil = 0;
+    }
+
+    bool ready() const { return (int32_t)(micros() - busyUntil) >= 0; }
+
+    void write(uint16_t address, uint8_t value)
+    {
+        if (address >= SIZE)
+            return;
+        // The AVR waits for the previous write before starting the next one
+        if (!ready())
+            hostAdvanceMicros(busyUntil - micros());
+        data[address] = value;
+        writes[address]++;
+        totalWrites++;
+        busyUntil = micros() + WRITE_MICROS;
+    }
+
+    uint8_t read(uint16_t address)
+    {
+        if (!ready())
+            hostAdvanceMicros(busyUntil - micros());
+        return address < SIZE ? data[address] : 0xFF;
+    }
+};
+
+inline HostEeprom &hostEeprom()
+{
+    static HostEeprom eeprom;
+    return eeprom;
+}
+
+#define eeprom_is_ready() (hostEeprom().ready())
+inline uint8_t eeprom_read_byte(const uint8_t *address) { return hostEeprom().read((uint16_t)(uintptr_t)address); }
+inline void eeprom_write_byte(uint8_t *address, uint8_t value) { hostEeprom().write((uint16_t)(uintptr_t)address, value); }
+inline void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+    if (eeprom_read_byte(address) != value)
+        eeprom_write_byte(address, value);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in: no real interrupts, a test calls the vector function itself
+
+#define cli()
+#define sei()
+#define ISR(vector) void vector()
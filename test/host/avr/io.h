@@ -0,0 +1,89 @@
+#pragma once
+
+// Host stand-in for the ATmega328P I/O registers. Each register is a plain byte unless
+// a model (e.g. twi_model.h) hooks its reads and writes.
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+struct HostRegister
+{
+    uint8_t value = 0;
+    void (*onWrite)(uint8_t value) = nullptr;
+    uint8_t (*onRead)() = nullptr;
+
+    operator uint8_t() const { return onRead ? onRead() : value; }
+    HostRegister &operator=(uint8_t v)
+    {
+        if (onWrite)
+            onWrite(v);
+        else
+            value = v;
+        return *this;
+    }
+    HostRegister &operator=(const HostRegister &other) { return *this = (uint8_t)other; }
+    HostRegister &operator|=(uint8_t v) { return *this = (uint8_t)(*this | v); }
+    HostRegister &operator&=(uint8_t v) { return *this = (uint8_t)(*this & v); }
+};
+
+struct HostRegisters
+{
+    HostRegister pinb, pcicr, pcmsk0, pcifr;
+    HostRegister wdtcsr, mcusr;
+    HostRegister twcr, twsr, twdr, twbr;
+    HostRegister eecr, smcr, adcsra, prr;
+};
+
+inline HostRegisters &hostRegisters()
+{
+    static HostRegisters registers;
+    return registers;
+}
+
+#define PINB (hostRegisters().pinb)
+#define PCICR (hostRegisters().pcicr)
+#define PCMSK0 (hostRegisters().pcmsk0)
+#define PCIFR (hostRegisters().pcifr)
+#define WDTCSR (hostRegisters().wdtcsr)
+#define MCUSR (hostRegisters().mcusr)
+#define TWCR (hostRegisters().twcr)
+#define TWSR (hostRegisters().twsr)
+#define TWDR (hostRegisters().twdr)
+#define TWBR (hostRegisters().twbr)
+#define EECR (hostRegisters().eecr)
+#define SMCR (hostRegisters().smcr)
+#define ADCSRA (hostRegisters().adcsra)
+#define PRR (hostRegisters().prr)
+
+// PCICR / PCMSK0 / PCIFR
+#define PCIE0 0
+#define PCIF0 0
+#define PCINT3 3
+#define PCINT4 4
+#define PCINT5 5
+
+// WDTCSR / MCUSR
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+#define WDRF 3
+
+// TWCR
+#define TWIE 0
+#define TWEN 2
+#define TWWC 3
+#define TWSTO 4
+#define TWSTA 5
+#define TWEA 6
+#define TWINT 7
+
+// EECR
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
@@ -0,0 +1,116 @@
+#pragma once
+
+// I2C slaves for host tests. Both the Wire stub and the TWI model (twi_model.h)
+// address the devices attached here.
+
+#include <stdint.h>
+#include <string.h>
+
+class HostI2CDevice
+{
+public:
+    bool holdsClock = false; // stretches SCL forever: every transfer to it times out
+
+    virtual ~HostI2CDevice() {}
+
+    /**
+     * @brief Addressed after a (repeated) START. false NACKs the address.
+     */
+    virtual bool start(bool /* read */) { return true; }
+    /**
+     * @brief Byte from the master. false NACKs it.
+     */
+    virtual bool write(uint8_t value) = 0;
+    virtual uint8_t read() = 0;
+    virtual void stop() {}
+};
+
+/**
+ * @brief Plain register file: the first byte of a write sets the register pointer,
+ * later bytes and reads auto-increment it, as on the IMUs and RTCs used here.
+ */
+class RegisterFileDevice : public HostI2CDevice
+{
+public:
+    uint8_t regs[256];
+    uint8_t pointer = 0;
+    uint16_t writeTransfers = 0; // transfers that wrote at least the register
+    uint16_t readTransfers = 0;
+
+    RegisterFileDevice() { memset(regs, 0, sizeof(regs)); }
+
+    bool start(bool read) override
+    {
+        _first = !read;
+        if (read)
+            readTransfers++;
+        return true;
+    }
+
+    bool write(uint8_t value) override
+    {
+        if (_first)
+        {
+            pointer = value;
+            _first = false;
+            writeTransfers++;
+            return true;
+        }
+        onWrite(pointer, value);
+        pointer++;
+        return true;
+    }
+
+    uint8_t read() override { return onRead(pointer++); }
+
+protected:
+    virtual void onWrite(uint8_t reg, uint8_t value) { regs[reg] = value; }
+    virtual uint8_t onRead(uint8_t reg) { return regs[reg]; }
+
+private:
+    bool _first = false;
+};
+
+/**
+ * @brief Write-only device that logs every byte it receives, e.g. a PCF8574 expander.
+ */
+class ByteLogDevice : public HostI2CDevice
+{
+public:
+    static const uint16_t CAPACITY = 4096;
+    uint8_t log[CAPACITY];
+    uint16_t length = 0;
+    uint16_t transfers = 0;
+
+    bool start(bool read) override
+    {
+        if (!read)
+            transfers++;
+        return true;
+    }
+
+    bool write(uint8_t value) override
+    {
+        if (length < CAPACITY)
+            log[length++] = value;
+        return true;
+    }
+
+    uint8_t read() override { return 0xFF; }
+};
+
+struct HostI2C
+{
+    HostI2CDevice *devices[128];
+
+    HostI2C() { detachAll(); }
+    void attach(uint8_t address, HostI2CDevice *device) { devices[address & 0x7F] = device; }
+    void detachAll() { memset(devices, 0, sizeof(devices)); }
+    HostI2CDevice *at(uint8_t address) { return devices[address & 0x7F]; }
+};
+
+inline HostI2C &hostI2C()
+{
+    static HostI2C bus;
+    return bus;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Print that collects into a string, to check text output in host tests
+
+#include <Arduino.h>
+
+class PrintBuffer : public Print
+{
+public:
+    static const uint16_t CAPACITY = 4096;
+    char text[CAPACITY + 1];
+    uint16_t length = 0;
+
+    PrintBuffer() { clear(); }
+
+    void clear()
+    {
+        length = 0;
+        text[0] = '\0';
+    }
+
+    size_t write(uint8_t c) override
+    {
+        if (length >= CAPACITY)
+            return 0;
+        text[length++] = c;
+        text[length] = '\0';
+        return 1;
+    }
+    using Print::write;
+};
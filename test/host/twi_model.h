@@ -0,0 +1,180 @@
+#pragma once
+
+// Model of the ATmega328P TWI master, behind the TWCR / TWSR / TWDR stand-ins, for
+// testing code that drives the peripheral directly (I2CBus). Every START, byte and
+// STOP takes bus time: its TWINT (or the clearing of TWSTO) only shows once the host
+// clock has moved on by that much, so a polling driver sees real "still busy" states.
+
+#include <Arduino.h>
+#include <util/twi.h>
+#include "i2c_device.h"
+
+class HostTwi
+{
+public:
+    uint32_t byteMicros = 90; // 9 clocks at 100 kHz
+    uint32_t startMicros = 10;
+    uint16_t starts = 0;
+    uint16_t stops = 0;
+    uint16_t resets = 0; // TWCR written without TWEN
+
+    /**
+     * @brief Hook the model into TWCR and reset it.
+     */
+    void install()
+    {
+        *this = HostTwi();
+        TWCR.value = 0;
+        TWSR.value = 0xF8;
+        TWCR.onWrite = onControlWrite;
+        TWCR.onRead = onControlRead;
+    }
+
+    void uninstall()
+    {
+        TWCR.onWrite = nullptr;
+        TWCR.onRead = nullptr;
+    }
+
+    bool busy() const { return _action != NONE || (TWCR.value & _BV(TWSTO)); }
+
+private:
+    enum Action : uint8_t
+    {
+        NONE,
+        START,
+        ADDRESS,
+        TRANSMIT,
+        RECEIVE,
+        STOP
+    };
+    enum Phase : uint8_t
+    {
+        IDLE,
+        ADDRESSING,
+        TX,
+        RX
+    };
+
+    Action _action = NONE;
+    Phase _phase = IDLE;
+    bool _ack = false;
+    uint32_t _issued = 0;
+    HostI2CDevice *_device = nullptr;
+
+    static HostTwi &self();
+
+    uint32_t duration() const { return (_action == START || _action == STOP) ? startMicros : byteMicros; }
+
+    static void onControlWrite(uint8_t value)
+    {
+        HostTwi &twi = self();
+        if (!(value & _BV(TWEN)))
+        {
+            // Disabling the TWI aborts whatever it was doing
+            TWCR.value = value;
+            twi._action = NONE;
+            twi._phase = IDLE;
+            twi._device = nullptr;
+            twi.resets++;
+            return;
+        }
+
+        // Writing TWINT clears the flag and starts the next action
+        uint8_t flags = TWCR.value & (_BV(TWINT) | _BV(TWSTO));
+        if (value & _BV(TWINT))
+            flags &= ~_BV(TWINT);
+        TWCR.value = (value & ~(_BV(TWINT) | _BV(TWSTO))) | flags;
+        if (!(value & _BV(TWINT)))
+            return;
+
+        twi._issued = micros();
+        if (value & _BV(TWSTO))
+        {
+            if (twi._device)
+                twi._device->stop();
+            twi._device = nullptr;
+            twi._phase = IDLE;
+            twi._action = STOP;
+            TWCR.value |= _BV(TWSTO);
+            twi.stops++;
+        }
+        else if (value & _BV(TWSTA))
+        {
+            twi._action = START;
+            twi.starts++;
+        }
+        else if (twi._phase == ADDRESSING)
+            twi._action = ADDRESS;
+        else if (twi._phase == TX)
+            twi._action = TRANSMIT;
+        else if (twi._phase == RX)
+        {
+            twi._action = RECEIVE;
+            twi._ack = value & _BV(TWEA);
+        }
+    }
+
+    static uint8_t onControlRead()
+    {
+        self().advance();
+        return TWCR.value;
+    }
+
+    void advance()
+    {
+        if (_action == NONE || micros() - _issued < duration())
+            return;
+        if (_device && _device->holdsClock && (_action == TRANSMIT || _action == RECEIVE))
+            return; // SCL held low, never completes
+
+        uint8_t status = 0xF8;
+        switch (_action)
+        {
+        case STOP:
+            TWCR.value &= ~_BV(TWSTO);
+            _action = NONE;
+            return;
+        case START:
+            status = _phase == IDLE ? TW_START : TW_REP_START;
+            _phase = ADDRESSING;
+            break;
+        case ADDRESS:
+        {
+            bool read = TWDR.value & TW_READ;
+            _device = hostI2C().at(TWDR.value >> 1);
+            if (_device && _device->start(read))
+            {
+                status = read ? TW_MR_SLA_ACK : TW_MT_SLA_ACK;
+                _phase = read ? RX : TX;
+            }
+            else
+            {
+                _device = nullptr;
+                status = read ? TW_MR_SLA_NACK : TW_MT_SLA_NACK;
+            }
+            break;
+        }
+        case TRANSMIT:
+            status = _device->write(TWDR.value) ? TW_MT_DATA_ACK : TW_MT_DATA_NACK;
+            break;
+        case RECEIVE:
+            TWDR.value = _device->read();
+            status = _ack ? TW_MR_DATA_ACK : TW_MR_DATA_NACK;
+            break;
+        default:
+            break;
+        }
+        _action = NONE;
+        TWSR.value = status;
+        TWCR.value |= _BV(TWINT);
+    }
+};
+
+inline HostTwi &hostTwi()
+{
+    static HostTwi twi;
+    return twi;
+}
+
+inline HostTwi &HostTwi::self() { return hostTwi(); }
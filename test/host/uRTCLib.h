@@ -0,0 +1,57 @@
+#pragma once
+
+// Host stand-in for uRTCLib: the blocking calls go through the Wire stub to whatever
+// device is attached at the RTC address, decoding BCD the way the library does.
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define URTCLIB_WIRE Wire
+
+class uRTCLib
+{
+public:
+    uRTCLib() {}
+    explicit uRTCLib(int address) : _address(address) {}
+
+    void set_rtc_address(int address) { _address = address; }
+
+    bool refresh()
+    {
+        Wire.beginTransmission(_address);
+        Wire.write((uint8_t)0x00);
+        if (Wire.endTransmission() != 0 || Wire.requestFrom(_address, 7) != 7)
+            return false;
+        _second = bcd(Wire.read() & 0x7F);
+        _minute = bcd(Wire.read() & 0x7F);
+        _hour = bcd(Wire.read() & 0x3F);
+        _dayOfWeek = bcd(Wire.read() & 0x07);
+        _day = bcd(Wire.read() & 0x3F);
+        _month = bcd(Wire.read() & 0x1F);
+        _year = bcd(Wire.read());
+        return true;
+    }
+
+    void set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek, uint8_t day, uint8_t month, uint8_t year)
+    {
+        uint8_t regs[] = {0x00, toBcd(second), toBcd(minute), toBcd(hour), toBcd(dayOfWeek), toBcd(day), toBcd(month), toBcd(year)};
+        Wire.beginTransmission(_address);
+        Wire.write(regs, sizeof(regs));
+        Wire.endTransmission();
+    }
+
+    uint8_t second() { return _second; }
+    uint8_t minute() { return _minute; }
+    uint8_t hour() { return _hour; }
+    uint8_t dayOfWeek() { return _dayOfWeek; }
+    uint8_t day() { return _day; }
+    uint8_t month() { return _month; }
+    uint8_t year() { return _year; }
+
+private:
+    int _address = 0x68;
+    uint8_t _second = 0, _minute = 0, _hour = 0, _dayOfWeek = 0, _day = 0, _month = 0, _year = 0;
+
+    static uint8_t bcd(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+    static uint8_t toBcd(uint8_t v) { return (v / 10) << 4 | (v % 10); }
+};
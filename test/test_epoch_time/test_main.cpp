@@ -0,0 +1,200 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "epoch_time.h"
+#include "rtc_makeshift.h"
+#include "sun_trajectory.h"
+
+// Reference calendar, counted the slow way: every day from 2000-01-01
+static const uint8_t MONTH_DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static bool referenceLeap(int y)
+{
+    if (y % 400 == 0)
+        return true;
+    if (y % 100 == 0)
+        return false;
+    return y % 4 == 0;
+}
+
+static uint8_t referenceMonthDays(int y, uint8_t m)
+{
+    return MONTH_DAYS[m - 1] + (m == 2 && referenceLeap(y));
+}
+
+static timeObject at(uint8_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t minute = 0, uint8_t second = 0)
+{
+    timeObject t = {second, minute, hour, day, month, year};
+    return t;
+}
+
+static void assertCalendar(const timeObject &expected, const timeObject &actual)
+{
+    TEST_ASSERT_EQUAL_UINT8(expected.year, actual.year);
+    TEST_ASSERT_EQUAL_UINT8(expected.month, actual.month);
+    TEST_ASSERT_EQUAL_UINT8(expected.day, actual.day);
+    TEST_ASSERT_EQUAL_UINT8(expected.hour, actual.hour);
+    TEST_ASSERT_EQUAL_UINT8(expected.minute, actual.minute);
+    TEST_ASSERT_EQUAL_UINT8(expected.second, actual.second);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_epoch_origin(void)
+{
+    TEST_ASSERT_EQUAL_INT32(0, daysFromCivil(2000, 1, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, fromCalendar(at(0, 1, 1)));
+    assertCalendar(at(0, 1, 1), toCalendar(0));
+    TEST_ASSERT_EQUAL_INT32(-1, daysFromCivil(1999, 12, 31));
+}
+
+void test_every_day_matches_reference(void)
+{
+    // 2000-01-01 .. 2135-12-31, the whole range a 32-bit epoch_t holds in full years
+    int32_t days = 0;
+    for (int y = 2000; y < 2136; y++)
+    {
+        uint16_t yday = 1;
+        for (uint8_t m = 1; m <= 12; m++)
+        {
+            for (uint8_t d = 1; d <= referenceMonthDays(y, m); d++, days++, yday++)
+            {
+                TEST_ASSERT_EQUAL_INT32(days, daysFromCivil(y, m, d));
+
+                int16_t cy;
+                uint8_t cm, cd;
+                civilFromDays(days, cy, cm, cd);
+                if (cy != y || cm != m || cd != d)
+                    TEST_FAIL_MESSAGE("civilFromDays disagrees with the reference");
+
+                if (dayOfYear(days * SECONDS_PER_DAY + 43200) != yday)
+                    TEST_FAIL_MESSAGE("dayOfYear disagrees with the reference");
+            }
+        }
+    }
+}
+
+void test_leap_years(void)
+{
+    TEST_ASSERT_TRUE(isLeapYear(2000)); // divisible by 400
+    TEST_ASSERT_TRUE(isLeapYear(2024));
+    TEST_ASSERT_FALSE(isLeapYear(2025));
+    TEST_ASSERT_FALSE(isLeapYear(2100)); // divisible by 100 only
+    TEST_ASSERT_TRUE(isLeapYear(2400));
+
+    TEST_ASSERT_EQUAL_UINT8(29, daysInMonth(2024, 2));
+    TEST_ASSERT_EQUAL_UINT8(28, daysInMonth(2025, 2));
+    TEST_ASSERT_EQUAL_UINT8(28, daysInMonth(2100, 2));
+    TEST_ASSERT_EQUAL_UINT8(29, daysInMonth(2000, 2));
+
+    // Feb 28 -> Feb 29 -> Mar 1 in a leap year, Feb 28 -> Mar 1 otherwise
+    epoch_t feb28 = fromCalendar(at(24, 2, 28, 23, 59, 59));
+    assertCalendar(at(24, 2, 29), toCalendar(feb28 + 1));
+    assertCalendar(at(24, 3, 1), toCalendar(feb28 + 1 + SECONDS_PER_DAY));
+    assertCalendar(at(25, 3, 1), toCalendar(fromCalendar(at(25, 2, 28, 23, 59, 59)) + 1));
+    assertCalendar(at(100, 3, 1), toCalendar(fromCalendar(at(100, 2, 28, 23, 59, 59)) + 1));
+
+    TEST_ASSERT_EQUAL_UINT16(366, dayOfYear(fromCalendar(at(24, 12, 31))));
+    TEST_ASSERT_EQUAL_UINT16(365, dayOfYear(fromCalendar(at(25, 12, 31))));
+    TEST_ASSERT_EQUAL_UINT16(60, dayOfYear(fromCalendar(at(24, 2, 29))));
+    TEST_ASSERT_EQUAL_UINT16(60, dayOfYear(fromCalendar(at(25, 3, 1))));
+}
+
+void test_month_boundaries(void)
+{
+    for (uint8_t m = 1; m <= 12; m++)
+    {
+        uint8_t last = daysInMonth(2025, m);
+        epoch_t end = fromCalendar(at(25, m, last, 23, 59, 59));
+        assertCalendar(at(25, m, last, 23, 59, 59), toCalendar(end));
+        timeObject next = m == 12 ? at(26, 1, 1) : at(25, m + 1, 1);
+        assertCalendar(next, toCalendar(end + 1));
+    }
+}
+
+void test_round_trip_time_of_day(void)
+{
+    // Odd step so every hour, minute and second shows up across the span
+    epoch_t start = fromCalendar(at(25, 1, 1));
+    for (epoch_t e = start; e < start + 3 * SECONDS_PER_DAY; e += 7)
+        TEST_ASSERT_EQUAL_UINT32(e, fromCalendar(toCalendar(e)));
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fractionalHour(start));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 13.5f, fractionalHour(start + 13 * 3600 + 30 * 60));
+}
+
+void test_last_full_epoch_second(void)
+{
+    epoch_t max = 0xFFFFFFFFUL; // 2136-02-07 06:28:15
+    assertCalendar(at(136, 2, 7, 6, 28, 15), toCalendar(max));
+    TEST_ASSERT_EQUAL_UINT32(max, fromCalendar(toCalendar(max)));
+}
+
+void test_time_zone_crosses_midnight_and_year(void)
+{
+    TimeZone jakarta = {7 * 60};
+    epoch_t utc = fromCalendar(at(25, 12, 31, 20, 0, 0));
+    assertCalendar(at(26, 1, 1, 3, 0, 0), toCalendar(jakarta.toLocal(utc)));
+    TEST_ASSERT_EQUAL_UINT32(utc, jakarta.toUtc(jakarta.toLocal(utc)));
+
+    TimeZone west = {-150}; // -02:30
+    epoch_t utc2 = fromCalendar(at(25, 3, 1, 1, 0, 0));
+    assertCalendar(at(25, 2, 28, 22, 30, 0), toCalendar(west.toLocal(utc2)));
+}
+
+static const TimeZone WIB = {7 * 60};
+
+void test_sun_tracker_day_of_year(void)
+{
+    SunTracker sun(WIB);
+    TEST_ASSERT_EQUAL_INT(1, sun.calculateDayOfYear(1, 1, 25));
+    TEST_ASSERT_EQUAL_INT(232, sun.calculateDayOfYear(20, 8, 25));
+    TEST_ASSERT_EQUAL_INT(233, sun.calculateDayOfYear(20, 8, 24));
+    TEST_ASSERT_EQUAL_INT(366, sun.calculateDayOfYear(31, 12, 24));
+}
+
+void test_sun_tracker_takes_the_time_service_zone(void)
+{
+    // The zone moves the local clock and the standard meridian together, so a UTC
+    // instant gives the same sun whichever zone the RTC keeps
+    SunTracker wib(WIB);
+    SunTracker utc(TimeZone{0});
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, wib.getTimezone());
+
+    epoch_t morning = fromCalendar(at(25, 8, 20, 2, 0, 0)); // 09:00 WIB
+    wib.update(morning);
+    utc.update(morning);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, utc.getAzimuth(), wib.getAzimuth());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, utc.getElevation(), wib.getElevation());
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, wib.getElevation());
+}
+
+void test_makeshift_clock_rolls_into_next_month(void)
+{
+    RTCMakeshift makeshift;
+    makeshift.begin();
+    // 5 simulated minutes per second: 12 days from 2025-08-20 06:00 is 2025-09-01 06:00
+    for (uint16_t i = 0; i < 12 * 24 * 12; i++)
+    {
+        hostAdvanceMillis(1000);
+        makeshift.update();
+    }
+    assertCalendar(at(25, 9, 1, 6, 0, 0), makeshift.getData());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_epoch_origin);
+    RUN_TEST(test_every_day_matches_reference);
+    RUN_TEST(test_leap_years);
+    RUN_TEST(test_month_boundaries);
+    RUN_TEST(test_round_trip_time_of_day);
+    RUN_TEST(test_last_full_epoch_second);
+    RUN_TEST(test_time_zone_crosses_midnight_and_year);
+    RUN_TEST(test_sun_tracker_day_of_year);
+    RUN_TEST(test_sun_tracker_takes_the_time_service_zone);
+    RUN_TEST(test_makeshift_clock_rolls_into_next_month);
+    return UNITY_END();
+}
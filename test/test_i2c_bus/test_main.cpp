@@ -0,0 +1,374 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "twi_model.h"
+#include "print_buffer.h"
+#include "i2c_bus.h"
+#include "lcd_bus.h"
+#include "sensor_mpu.h"
+
+static const uint8_t DEVICE_ADDR = 0x50;
+static const uint8_t LCD_ADDR = 0x27;
+
+static I2CBus *bus;
+static I2CSupervisor *supervisor;
+static RegisterFileDevice device;
+static ByteLogDevice expander;
+
+// Completion order across transactions
+static uint8_t completed[16];
+static uint8_t completedStatus[16];
+static uint8_t completedCount;
+
+static void onDone(void *context, uint8_t status)
+{
+    if (completedCount < sizeof(completed))
+    {
+        completed[completedCount] = (uint8_t)(uintptr_t)context;
+        completedStatus[completedCount] = status;
+        completedCount++;
+    }
+}
+
+static I2CTransaction transaction(uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, bool read,
+                                  I2CPriority priority, uint8_t tag)
+{
+    I2CTransaction t = {address, reg, data, length, read, priority, onDone, (void *)(uintptr_t)tag};
+    return t;
+}
+
+// Poll the bus like loop() does until it is idle; returns the number of service() calls
+static uint16_t drain(uint32_t stepMicros = 20)
+{
+    uint16_t calls = 0;
+    while (bus->pending() && calls < 10000)
+    {
+        bus->service();
+        hostAdvanceMicros(stepMicros);
+        calls++;
+    }
+    return calls;
+}
+
+void setUp(void)
+{
+    hostI2C().detachAll();
+    hostI2C().attach(DEVICE_ADDR, &device);
+    hostI2C().attach(LCD_ADDR, &expander);
+    device = RegisterFileDevice();
+    expander = ByteLogDevice();
+    hostTwi().install();
+    static I2CBus busInstance;
+    static I2CSupervisor supervisorInstance;
+    busInstance = I2CBus();
+    supervisorInstance = I2CSupervisor();
+    bus = &busInstance;
+    supervisor = &supervisorInstance;
+    bus->begin(2000);
+    bus->setSupervisor(supervisor);
+    completedCount = 0;
+}
+
+void tearDown(void)
+{
+    hostTwi().uninstall();
+}
+
+void test_read_runs_without_blocking(void)
+{
+    for (uint8_t i = 0; i < 6; i++)
+        device.regs[0x10 + i] = 0xA0 + i;
+
+    uint8_t data[6] = {0};
+    TEST_ASSERT_TRUE(bus->submit(transaction(DEVICE_ADDR, 0x10, data, 6, true, I2CPriority::NORMAL, 1)));
+
+    // The first call only issues START; nothing has completed on the wire yet
+    uint32_t before = micros();
+    TEST_ASSERT_TRUE(bus->service());
+    TEST_ASSERT_EQUAL_UINT32(before, micros());
+    TEST_ASSERT_EQUAL_UINT8(0, completedCount);
+
+    // 1 START + SLA+W + reg + repeated START + SLA+R + 6 bytes: many polls, each short
+    uint16_t calls = drain();
+    TEST_ASSERT_GREATER_THAN(10, calls);
+    TEST_ASSERT_EQUAL_UINT8(1, completedCount);
+    TEST_ASSERT_EQUAL_UINT8(0, completedStatus[0]);
+    for (uint8_t i = 0; i < 6; i++)
+        TEST_ASSERT_EQUAL_HEX8(0xA0 + i, data[i]);
+    TEST_ASSERT_EQUAL_UINT16(2, hostTwi().starts);
+    TEST_ASSERT_EQUAL_UINT16(1, hostTwi().stops);
+
+    const I2CSupervisor::DeviceStats *stats = supervisor->getStats(DEVICE_ADDR);
+    TEST_ASSERT_NOT_NULL(stats);
+    TEST_ASSERT_EQUAL_UINT16(1, stats->transactions);
+    TEST_ASSERT_EQUAL_UINT16(0, stats->nacks);
+}
+
+void test_write_stores_register_data(void)
+{
+    uint8_t data[3] = {1, 2, 3};
+    bus->submit(transaction(DEVICE_ADDR, 0x20, data, 3, false, I2CPriority::NORMAL, 1));
+    drain();
+    TEST_ASSERT_EQUAL_UINT8(1, completedCount);
+    TEST_ASSERT_EQUAL_UINT8(0, completedStatus[0]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, device.regs + 0x20, 3);
+    TEST_ASSERT_EQUAL_UINT16(1, hostTwi().starts); // no repeated START for a write
+}
+
+void test_urgent_overtakes_queued_background(void)
+{
+    uint8_t lcd[3][3] = {{0}};
+    uint8_t imu[6];
+    for (uint8_t i = 0; i < 3; i++)
+        bus->submit(transaction(LCD_ADDR, 0x08, lcd[i], 3, false, I2CPriority::BACKGROUND, 10 + i));
+
+    // First LCD write goes on the wire, then the IMU read arrives
+    bus->service();
+    hostAdvanceMicros(100);
+    bus->service();
+    bus->submit(transaction(DEVICE_ADDR, 0x3B, imu, 6, true, I2CPriority::URGENT, 1));
+    bus->submit(transaction(DEVICE_ADDR, 0x00, imu, 6, true, I2CPriority::NORMAL, 2));
+    drain();
+
+    // The LCD byte in flight finishes, then the IMU goes before the RTC and the other LCD bytes
+    uint8_t expected[] = {10, 1, 2, 11, 12};
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), completedCount);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, completed, sizeof(expected));
+}
+
+void test_fifo_within_priority_across_sequence_wrap(void)
+{
+    uint8_t data[1];
+    // Push the 8-bit sequence counter close to wrapping
+    for (uint16_t i = 0; i < 250; i++)
+    {
+        bus->submit(transaction(DEVICE_ADDR, 0, data, 1, false, I2CPriority::NORMAL, 0));
+        drain();
+    }
+    completedCount = 0;
+    for (uint8_t i = 0; i < I2CBus::QUEUE_SIZE; i++)
+        bus->submit(transaction(DEVICE_ADDR, 0, data, 1, false, I2CPriority::NORMAL, i));
+    drain();
+    TEST_ASSERT_EQUAL_UINT8(I2CBus::QUEUE_SIZE, completedCount);
+    for (uint8_t i = 0; i < I2CBus::QUEUE_SIZE; i++)
+        TEST_ASSERT_EQUAL_UINT8(i, completed[i]);
+}
+
+void test_address_nack_reports_status_2(void)
+{
+    uint8_t data[2];
+    bus->submit(transaction(0x11, 0x00, data, 2, true, I2CPriority::NORMAL, 1));
+    drain();
+    TEST_ASSERT_EQUAL_UINT8(1, completedCount);
+    TEST_ASSERT_EQUAL_UINT8(2, completedStatus[0]);
+    TEST_ASSERT_EQUAL_UINT16(1, supervisor->getStats(0x11)->nacks);
+    TEST_ASSERT_EQUAL_UINT16(1, hostTwi().stops); // bus released
+}
+
+void test_nack_during_stop_does_not_recover_the_bus(void)
+{
+    // I2CBus reports the NACK right after setting TWSTO, while SDA may still read low
+    hostPins().level[SDA_PIN] = LOW;
+    uint8_t data[2];
+    bus->submit(transaction(0x11, 0x00, data, 2, true, I2CPriority::NORMAL, 1));
+    bus->submit(transaction(DEVICE_ADDR, 0x00, data, 1, false, I2CPriority::NORMAL, 2));
+    drain();
+    TEST_ASSERT_EQUAL_UINT8(2, completedCount);
+    TEST_ASSERT_EQUAL_UINT8(2, completedStatus[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, completedStatus[1]);
+    TEST_ASSERT_EQUAL_UINT16(0, supervisor->getRecoveries());
+    TEST_ASSERT_EQUAL_UINT16(0, hostTwi().resets);
+
+    // A timeout with SDA low is a stuck bus
+    supervisor->record(DEVICE_ADDR, 5, micros());
+    TEST_ASSERT_EQUAL_UINT16(1, supervisor->getRecoveries());
+    hostPins().level[SDA_PIN] = HIGH;
+}
+
+void test_stuck_device_times_out_and_bus_moves_on(void)
+{
+    uint8_t data[2];
+    device.holdsClock = true;
+    bus->submit(transaction(DEVICE_ADDR, 0x00, data, 2, true, I2CPriority::URGENT, 1));
+    bus->submit(transaction(LCD_ADDR, 0x08, data, 1, false, I2CPriority::BACKGROUND, 2));
+    drain(100);
+    TEST_ASSERT_EQUAL_UINT8(2, completedCount);
+    TEST_ASSERT_EQUAL_UINT8(5, completedStatus[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, completedStatus[1]);
+    TEST_ASSERT_EQUAL_UINT16(1, hostTwi().resets);
+    TEST_ASSERT_EQUAL_UINT16(1, supervisor->getStats(DEVICE_ADDR)->timeouts);
+}
+
+void test_full_queue_drops(void)
+{
+    uint8_t data[1];
+    for (uint8_t i = 0; i < I2CBus::QUEUE_SIZE; i++)
+        TEST_ASSERT_TRUE(bus->submit(transaction(DEVICE_ADDR, 0, data, 1, false, I2CPriority::NORMAL, i)));
+    TEST_ASSERT_EQUAL_UINT8(0, bus->available());
+    TEST_ASSERT_FALSE(bus->submit(transaction(DEVICE_ADDR, 0, data, 1, false, I2CPriority::NORMAL, 99)));
+    TEST_ASSERT_EQUAL_UINT16(1, bus->getDropped());
+
+    // The transaction on the wire no longer takes a queue slot
+    bus->service();
+    TEST_ASSERT_EQUAL_UINT8(1, bus->available());
+    TEST_ASSERT_EQUAL_UINT8(I2CBus::QUEUE_SIZE, bus->pending());
+}
+
+// Rebuild the LCD bytes from the expander writes: E falls on the second and fourth byte
+static uint8_t decodeLcd(const uint8_t *log, uint16_t length, uint8_t *out, uint8_t *rs)
+{
+    uint8_t count = 0;
+    for (uint16_t i = 0; i + 3 < length; i += 4)
+    {
+        TEST_ASSERT_EQUAL_HEX8(0x04, log[i] & 0x04);     // E high
+        TEST_ASSERT_EQUAL_HEX8(0x00, log[i + 1] & 0x04); // E low, high nibble latched
+        TEST_ASSERT_EQUAL_HEX8(0x04, log[i + 2] & 0x04);
+        TEST_ASSERT_EQUAL_HEX8(0x00, log[i + 3] & 0x04);
+        out[count] = (log[i + 1] & 0xF0) | (log[i + 3] >> 4);
+        rs[count] = log[i + 1] & 0x01;
+        count++;
+    }
+    return count;
+}
+
+void test_lcd_bytes_go_out_as_expander_writes(void)
+{
+    LcdBus lcd(*bus, LCD_ADDR);
+    lcd.setCursor(3, 2);
+    lcd.print("Hi");
+    drain();
+
+    TEST_ASSERT_EQUAL_UINT16(3, expander.transfers);
+    TEST_ASSERT_EQUAL_UINT16(12, expander.length);
+    uint8_t bytes[3], rs[3];
+    TEST_ASSERT_EQUAL_UINT8(3, decodeLcd(expander.log, expander.length, bytes, rs));
+    TEST_ASSERT_EQUAL_HEX8(0x80 | (0x14 + 3), bytes[0]); // DDRAM address of row 2
+    TEST_ASSERT_EQUAL_UINT8(0, rs[0]);
+    TEST_ASSERT_EQUAL_HEX8('H', bytes[1]);
+    TEST_ASSERT_EQUAL_HEX8('i', bytes[2]);
+    TEST_ASSERT_EQUAL_UINT8(1, rs[1]);
+    for (uint16_t i = 0; i < expander.length; i++)
+        TEST_ASSERT_EQUAL_HEX8(0x08, expander.log[i] & 0x08); // backlight stays on
+    TEST_ASSERT_FALSE(lcd.consumeLost());
+}
+
+void test_lcd_leaves_room_for_sensor_reads(void)
+{
+    LcdBus lcd(*bus, LCD_ADDR);
+    TEST_ASSERT_EQUAL_UINT8(LcdBus::SLOTS, lcd.room());
+    for (uint8_t i = 0; i < LcdBus::SLOTS; i++)
+        lcd.write('a' + i);
+    TEST_ASSERT_EQUAL_UINT8(0, lcd.room());
+    TEST_ASSERT_GREATER_OR_EQUAL(LcdBus::RESERVED, bus->available());
+
+    // One more is dropped and reported, so the caller can redraw
+    lcd.write('z');
+    TEST_ASSERT_TRUE(lcd.consumeLost());
+    TEST_ASSERT_FALSE(lcd.consumeLost());
+    drain();
+    TEST_ASSERT_EQUAL_UINT8(LcdBus::SLOTS, lcd.room());
+    TEST_ASSERT_EQUAL_UINT16(LcdBus::SLOTS * 4, expander.length);
+}
+
+void test_lcd_failure_is_reported(void)
+{
+    LcdBus lcd(*bus, LCD_ADDR);
+    hostI2C().attach(LCD_ADDR, nullptr); // backpack unplugged
+    lcd.write('x');
+    drain();
+    TEST_ASSERT_TRUE(lcd.consumeLost());
+    TEST_ASSERT_EQUAL_UINT8(LcdBus::SLOTS, lcd.room());
+}
+
+void test_imu_sample_overtakes_lcd_backlog(void)
+{
+    static RegisterFileDevice mpuRegs;
+    mpuRegs = RegisterFileDevice();
+    hostI2C().attach(0x68, &mpuRegs);
+    int16_t values[7] = {1000, -2000, 16384, 0, 131, -262, 0};
+    for (uint8_t i = 0; i < 7; i++)
+    {
+        mpuRegs.regs[0x3B + 2 * i] = (uint16_t)values[i] >> 8;
+        mpuRegs.regs[0x3C + 2 * i] = values[i] & 0xFF;
+    }
+
+    SensorMPU mpu;
+    mpu.begin();
+    LcdBus lcd(*bus, LCD_ADDR);
+    for (uint8_t i = 0; i < LcdBus::SLOTS; i++)
+        lcd.write('0' + i);
+    bus->service(); // first LCD byte on the wire
+
+    mpu.requestUpdate(*bus);
+    TEST_ASSERT_FALSE(mpu.consumeFresh());
+
+    // The sample lands after one LCD byte, not after all of them
+    uint16_t calls = 0;
+    while (!mpu.consumeFresh() && calls++ < 1000)
+    {
+        bus->service();
+        hostAdvanceMicros(20);
+    }
+    TEST_ASSERT_EQUAL_UINT16(1, expander.transfers);
+    TEST_ASSERT_EQUAL_FLOAT(1000, mpu.getAccelX());
+    TEST_ASSERT_EQUAL_FLOAT(16384, mpu.getAccelZ());
+    TEST_ASSERT_EQUAL_FLOAT(1.0, mpu.getGyroX());
+    TEST_ASSERT_EQUAL_FLOAT(-2.0, mpu.getGyroY());
+    drain();
+    TEST_ASSERT_EQUAL_UINT16(LcdBus::SLOTS, expander.transfers);
+}
+
+void test_timeout_clears_the_wire_flag(void)
+{
+    // A library transfer timed out; recording it must not leave the flag for the next observe()
+    Wire.beginTransmission(DEVICE_ADDR);
+    device.holdsClock = true;
+    TEST_ASSERT_EQUAL_UINT8(5, Wire.endTransmission());
+    TEST_ASSERT_TRUE(Wire.getWireTimeoutFlag());
+    supervisor->record(DEVICE_ADDR, 5, micros());
+    TEST_ASSERT_FALSE(Wire.getWireTimeoutFlag());
+
+    device.holdsClock = false;
+    supervisor->observe(DEVICE_ADDR, micros(), true);
+    const I2CSupervisor::DeviceStats *stats = supervisor->getStats(DEVICE_ADDR);
+    TEST_ASSERT_EQUAL_UINT16(2, stats->transactions);
+    TEST_ASSERT_EQUAL_UINT16(1, stats->timeouts);
+}
+
+void test_dump_lists_each_device_histogram(void)
+{
+    uint32_t start = micros();
+    hostAdvanceMicros(700); // <1 ms bucket
+    supervisor->record(0x68, 0, start);
+    start = micros();
+    hostAdvanceMicros(40000); // >=32 ms bucket
+    supervisor->record(0x68, 5, start);
+    supervisor->record(0x0E, 2, micros());
+
+    PrintBuffer out;
+    supervisor->dump(out);
+    TEST_ASSERT_EQUAL_STRING("i2c addr n nack timeout max_us <0.5ms <1 <2 <4 <8 <16 <32 >=32\r\n"
+                             "0x68 2 0 1 40000 0 1 0 0 0 0 0 1\r\n"
+                             "0x0E 1 1 0 0 1 0 0 0 0 0 0 0\r\n"
+                             "i2c recoveries 0\r\n",
+                             out.text);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_read_runs_without_blocking);
+    RUN_TEST(test_write_stores_register_data);
+    RUN_TEST(test_urgent_overtakes_queued_background);
+    RUN_TEST(test_fifo_within_priority_across_sequence_wrap);
+    RUN_TEST(test_address_nack_reports_status_2);
+    RUN_TEST(test_nack_during_stop_does_not_recover_the_bus);
+    RUN_TEST(test_stuck_device_times_out_and_bus_moves_on);
+    RUN_TEST(test_full_queue_drops);
+    RUN_TEST(test_lcd_bytes_go_out_as_expander_writes);
+    RUN_TEST(test_lcd_leaves_room_for_sensor_reads);
+    RUN_TEST(test_lcd_failure_is_reported);
+    RUN_TEST(test_imu_sample_overtakes_lcd_backlog);
+    RUN_TEST(test_timeout_clears_the_wire_flag);
+    RUN_TEST(test_dump_lists_each_device_histogram);
+    return UNITY_END();
+}
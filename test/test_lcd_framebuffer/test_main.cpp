@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "twi_model.h"
+#include "i2c_bus.h"
+#include "lcd_bus.h"
+#include "lcd_emulator.h"
+#include "lcd_framebuffer.h"
+#include "user_interface.h"
+
+static const uint8_t FRAMES = 60; // one minute of the 1 Hz UI task
+
+static I2CBus *bus;
+static UserInterface *ui;
+static ByteLogDevice expander;
+
+// A minute on the AUTO screen: the LDR average wanders, the pose creeps along
+static void drawAutomatic(uint8_t frame)
+{
+    ui->showAutomatic(180 + frame % 3, 12.5f + frame * 0.01f, -3.25f, ModeSelection::MANUAL);
+}
+
+// What the UI did before the framebuffer: clear and print every line, every second.
+// Taken from the screen the framebuffer produced, so both paths show the same text.
+static void legacyRedraw(LcdEmulator &lcd, const LcdEmulator &screen)
+{
+    lcd.clear();
+    for (uint8_t row = 0; row < LcdEmulator::ROWS; row++)
+    {
+        uint8_t length = LcdEmulator::COLS;
+        while (length > 0 && screen.charAt(length - 1, row) == ' ')
+            length--;
+        if (length == 0)
+            continue;
+        lcd.setCursor(0, row);
+        for (uint8_t col = 0; col < length; col++)
+            lcd.write(screen.charAt(col, row));
+    }
+}
+
+static void drain()
+{
+    for (uint16_t calls = 0; bus->pending() && calls < 10000; calls++)
+    {
+        bus->service();
+        hostAdvanceMicros(20);
+    }
+}
+
+void setUp(void)
+{
+    hostI2C().detachAll();
+    expander = ByteLogDevice();
+    hostI2C().attach(LCD_ADDR, &expander);
+    hostTwi().install();
+    static I2CBus busInstance;
+    busInstance = I2CBus();
+    bus = &busInstance;
+    bus->begin(2000);
+    delete ui;
+    ui = new UserInterface(*bus);
+    ui->init();
+    ui->getDevice().resetCounters();
+}
+
+void tearDown(void)
+{
+    hostTwi().uninstall();
+}
+
+void test_unchanged_frame_sends_nothing(void)
+{
+    drawAutomatic(0);
+    ui->flush();
+    ui->getDevice().resetCounters();
+
+    drawAutomatic(0);
+    TEST_ASSERT_EQUAL_UINT8(0, ui->getPendingChars());
+    TEST_ASSERT_EQUAL_UINT8(0, ui->flush());
+    TEST_ASSERT_EQUAL_UINT32(0, ui->getDevice().getBusBytes());
+}
+
+void test_bus_bytes_per_frame_before_and_after(void)
+{
+    LcdEmulator legacy(LCD_ADDR, 20, 4);
+    legacy.begin();
+    uint32_t before = 0;
+    uint32_t after = 0;
+    uint32_t firstFrame = 0;
+
+    for (uint8_t frame = 0; frame < FRAMES; frame++)
+    {
+        drawAutomatic(frame);
+        ui->getDevice().resetCounters();
+        ui->flush();
+        uint32_t bytes = ui->getDevice().getBusBytes();
+        if (frame == 0)
+            firstFrame = bytes;
+        else
+            after += bytes;
+
+        legacy.resetCounters();
+        legacyRedraw(legacy, ui->getDevice());
+        if (frame > 0)
+            before += legacy.getBusBytes();
+
+        for (uint8_t row = 0; row < LcdEmulator::ROWS; row++)
+        {
+            for (uint8_t col = 0; col < LcdEmulator::COLS; col++)
+                TEST_ASSERT_EQUAL_CHAR(legacy.charAt(col, row), ui->getDevice().charAt(col, row));
+        }
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "LCD_I2C bus bytes per frame: %lu full redraw, %lu through the framebuffer (first frame %lu)",
+             (unsigned long)(before / (FRAMES - 1)), (unsigned long)(after / (FRAMES - 1)), (unsigned long)firstFrame);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN_UINT32(before / 10, after);
+}
+
+void test_lcd_bus_bytes_on_the_wire(void)
+{
+    // The real display path: framebuffer -> LcdBus -> I2CBus -> PCF8574
+    LcdFramebuffer fb;
+    LcdBus lcd(*bus, LCD_ADDR);
+    const char *text = "Mode: AUTO";
+
+    fb.setCursor(0, 0);
+    fb.print(text);
+    uint16_t chars = 0;
+    while (fb.pending())
+    {
+        chars += fb.flush(lcd, lcd.room() / 2);
+        drain();
+    }
+    // Nothing was shown yet, so all 80 cells go out once, with a setCursor per row
+    TEST_ASSERT_EQUAL_UINT16(80, chars);
+    uint16_t fullFrame = expander.length;
+
+    // Change one value in place: only its cells and one setCursor go out
+    expander = ByteLogDevice();
+    fb.setCursor(6, 0);
+    fb.print("MANU");
+    while (fb.pending())
+    {
+        fb.flush(lcd, lcd.room() / 2);
+        drain();
+    }
+    TEST_ASSERT_EQUAL_UINT16(5, expander.transfers);  // setCursor + 4 characters
+    TEST_ASSERT_EQUAL_UINT16(5 * 4, expander.length); // 4 expander bytes per LCD byte
+
+    char line[120];
+    snprintf(line, sizeof(line), "LcdBus expander bytes: %u for a full frame, %u for a 4 character change",
+             fullFrame, expander.length);
+    TEST_MESSAGE(line);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_bus_bytes_per_frame_before_and_after);
+    RUN_TEST(test_lcd_bus_bytes_on_the_wire);
+    return UNITY_END();
+}
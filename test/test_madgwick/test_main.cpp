@@ -0,0 +1,161 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include "madgwick_imu.h"
+
+static MadgwickIMU fusion;
+
+// What a level-mounted sensor reads at a roll/pitch pose (same convention as tiltFromAccel)
+static ModelIMU atPose(float roll, float pitch, float rollRate = 0, float pitchRate = 0)
+{
+    float r = roll * DEG_TO_RAD;
+    float p = pitch * DEG_TO_RAD;
+    ModelIMU imu;
+    imu.xa = -sin(p);
+    imu.ya = cos(p) * sin(r);
+    imu.za = cos(p) * cos(r);
+    imu.xg = rollRate;
+    imu.yg = pitchRate;
+    imu.zg = 0;
+    return imu;
+}
+
+// Samples until roll is within tolerance of target, holding the pose
+static uint16_t samplesToConverge(float sampleHz, float target, float tolerance)
+{
+    fusion = MadgwickIMU();
+    fusion.begin(sampleHz);
+    fusion.update(atPose(0, 0)); // seeds level
+    for (uint16_t n = 1; n < 10000; n++)
+    {
+        fusion.update(atPose(target, 0));
+        if (fabs(fusion.getRoll() - target) < tolerance)
+            return n;
+    }
+    return 0xFFFF;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_first_sample_seeds_the_pose(void)
+{
+    fusion = MadgwickIMU();
+    fusion.begin(10);
+    TEST_ASSERT_FALSE(fusion.isSeeded());
+    fusion.update(atPose(25, -12));
+    TEST_ASSERT_TRUE(fusion.isSeeded());
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 25, fusion.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -12, fusion.getPitch());
+}
+
+void test_zero_accel_is_ignored(void)
+{
+    fusion = MadgwickIMU();
+    fusion.begin(10);
+    ModelIMU none;
+    fusion.update(none);
+    TEST_ASSERT_FALSE(fusion.isSeeded());
+}
+
+void test_accel_step_converges_without_limit_cycle(void)
+{
+    // 20° step with a still gyro, e.g. the tracker moved while the gyro was unavailable
+    uint16_t n = samplesToConverge(10, 20, 0.5);
+    TEST_ASSERT_LESS_THAN(200, n); // 20 s at 10 Hz, beta 0.1
+
+    // Settles on the pose instead of circling it at beta / rate
+    for (uint16_t i = 0; i < 300; i++)
+        fusion.update(atPose(20, 0));
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 20, fusion.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 0, fusion.getPitch());
+}
+
+void test_convergence_time_does_not_depend_on_rate(void)
+{
+    // The step is integrated over 1 / rate, so seconds to converge stay about the same
+    float seconds10 = samplesToConverge(10, 20, 0.5) / 10.0f;
+    float seconds50 = samplesToConverge(50, 20, 0.5) / 50.0f;
+    float seconds100 = samplesToConverge(100, 20, 0.5) / 100.0f;
+    char line[96];
+    snprintf(line, sizeof(line), "20 deg step to 0.5 deg: %.1f s @10 Hz, %.1f s @50 Hz, %.1f s @100 Hz",
+             seconds10, seconds50, seconds100);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_FLOAT_WITHIN(seconds10 * 0.25, seconds10, seconds50);
+    TEST_ASSERT_FLOAT_WITHIN(seconds10 * 0.25, seconds10, seconds100);
+}
+
+void test_gyro_tracks_a_motor_move(void)
+{
+    // Roll at 5 °/s for 8 s with gyro and accel agreeing: the fused angle follows
+    // the move instead of lagging by the accel correction time
+    fusion = MadgwickIMU();
+    fusion.begin(10);
+    fusion.update(atPose(0, 0));
+    float worst = 0;
+    for (uint16_t i = 1; i <= 80; i++)
+    {
+        float roll = i * 0.5f;
+        fusion.update(atPose(roll, 0, 5, 0));
+        worst = max(worst, (float)fabs(fusion.getRoll() - roll));
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0, worst);
+}
+
+void test_gyro_bias_is_held_off_by_the_accel(void)
+{
+    fusion = MadgwickIMU();
+    fusion.begin(10);
+    fusion.update(atPose(10, 5));
+    for (uint16_t i = 0; i < 3000; i++)
+        fusion.update(atPose(10, 5, 0.3, -0.3)); // still, with 0.3 °/s bias on both axes
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 10, fusion.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 5, fusion.getPitch());
+}
+
+static double nowNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void test_benchmark_update_cost_against_rate(void)
+{
+    const uint32_t N = 200000;
+    static ModelIMU poses[64];
+    for (uint8_t i = 0; i < 64; i++)
+        poses[i] = atPose(30 * sin(i * 0.1), 10 * cos(i * 0.1), 3 * cos(i * 0.1), -1 * sin(i * 0.1));
+
+    fusion = MadgwickIMU();
+    fusion.begin(10);
+    fusion.update(poses[0]);
+    double start = nowNanos();
+    for (uint32_t i = 0; i < N; i++)
+        fusion.update(poses[i & 63]);
+    double perUpdate = (nowNanos() - start) / N;
+
+    // The share of time fusion takes grows linearly with the rate; on the Nano the
+    // PROBE_FUSION profiler histogram gives the per-update cost to put in here
+    char line[128];
+    snprintf(line, sizeof(line), "update: %.0f ns on this host; load %.4f%% @10 Hz, %.4f%% @50 Hz, %.4f%% @100 Hz",
+             perUpdate, perUpdate * 10 / 1e7, perUpdate * 50 / 1e7, perUpdate * 100 / 1e7);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(isfinite(fusion.getRoll()));
+    TEST_ASSERT_LESS_THAN_FLOAT(20000, perUpdate); // no libm-heavy path crept in (trig only when seeding)
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_seeds_the_pose);
+    RUN_TEST(test_zero_accel_is_ignored);
+    RUN_TEST(test_accel_step_converges_without_limit_cycle);
+    RUN_TEST(test_convergence_time_does_not_depend_on_rate);
+    RUN_TEST(test_gyro_tracks_a_motor_move);
+    RUN_TEST(test_gyro_bias_is_held_off_by_the_accel);
+    RUN_TEST(test_benchmark_update_cost_against_rate);
+    return UNITY_END();
+}
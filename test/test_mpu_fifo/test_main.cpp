@@ -0,0 +1,298 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "twi_model.h"
+#include "i2c_bus.h"
+#include "sensor_mpu.h"
+#include "madgwick_imu.h"
+
+/**
+ * @brief MPU-6050 registers with a working FIFO: FIFO_R_W pops without moving the
+ * register pointer, FIFO_COUNT follows the queue, USER_CTRL FIFO_RESET empties it
+ * and INT_STATUS clears on read.
+ */
+class Mpu6050Model : public RegisterFileDevice
+{
+public:
+    static const uint16_t CAPACITY = 1024;
+    uint8_t fifo[CAPACITY];
+    uint16_t head = 0;
+    uint16_t count = 0;
+    uint16_t resets = 0;
+
+    void push(const int16_t values[6])
+    {
+        for (uint8_t i = 0; i < 12; i++)
+        {
+            uint8_t b = i % 2 == 0 ? (uint16_t)values[i / 2] >> 8 : values[i / 2] & 0xFF;
+            if (count == CAPACITY)
+            {
+                // Oldest byte is lost, as on the part
+                head = (head + 1) % CAPACITY;
+                count--;
+                regs[0x3A] |= 0x10; // FIFO_OFLOW_INT
+            }
+            fifo[(head + count) % CAPACITY] = b;
+            count++;
+        }
+    }
+
+    uint8_t read() override
+    {
+        if (pointer == 0x74)
+        {
+            if (count == 0)
+                return 0xFF;
+            uint8_t b = fifo[head];
+            head = (head + 1) % CAPACITY;
+            count--;
+            return b;
+        }
+        return RegisterFileDevice::read();
+    }
+
+protected:
+    uint8_t onRead(uint8_t reg) override
+    {
+        if (reg == 0x72)
+            return count >> 8;
+        if (reg == 0x73)
+            return count & 0xFF;
+        if (reg == 0x3A)
+        {
+            uint8_t status = regs[0x3A];
+            regs[0x3A] = 0;
+            return status;
+        }
+        return regs[reg];
+    }
+
+    void onWrite(uint8_t reg, uint8_t value) override
+    {
+        if (reg == 0x6A && (value & 0x04))
+        {
+            head = 0;
+            count = 0;
+            resets++;
+            value &= ~0x04; // self-clearing
+        }
+        regs[reg] = value;
+    }
+};
+
+static Mpu6050Model model;
+static I2CBus *bus;
+static SensorMPU *mpu = nullptr;
+
+static ModelIMU samples[32];
+static uint8_t sampleCount;
+
+static void onSample(const ModelIMU &sample)
+{
+    if (sampleCount < 32)
+        samples[sampleCount] = sample;
+    sampleCount++;
+}
+
+static void pushFrames(uint8_t n, int16_t base = 0)
+{
+    for (uint8_t i = 0; i < n; i++)
+    {
+        int16_t frame[6] = {(int16_t)(base + i), -100, 16384, 131, (int16_t)(-262 - i), 0};
+        model.push(frame);
+    }
+}
+
+// Run loop()'s part: request, then poll the bus until the drain is over
+static bool drain()
+{
+    mpu->requestUpdate(*bus);
+    for (uint16_t i = 0; i < 5000 && bus->pending(); i++)
+    {
+        bus->service();
+        hostAdvanceMicros(20);
+    }
+    return mpu->consumeFresh();
+}
+
+void setUp(void)
+{
+    model = Mpu6050Model();
+    hostI2C().detachAll();
+    hostI2C().attach(0x68, &model);
+    hostTwi().install();
+
+    static I2CBus busInstance;
+    busInstance = I2CBus();
+    bus = &busInstance;
+    bus->begin(2000);
+
+    delete mpu;
+    mpu = new SensorMPU();
+    mpu->beginFifo(99);
+    mpu->setSampleHandler(onSample);
+    mpu->update(); // drop an INT left over from the previous test
+    sampleCount = 0;
+}
+
+void tearDown(void)
+{
+    hostTwi().uninstall();
+}
+
+void test_begin_fifo_configures_the_sensor(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(99, model.regs[0x19]);   // SMPLRT_DIV: 1 kHz / 100
+    TEST_ASSERT_EQUAL_HEX8(0x78, model.regs[0x23]); // gyro XYZ + accel into the FIFO
+    TEST_ASSERT_EQUAL_HEX8(0x01, model.regs[0x38]); // DATA_RDY interrupt
+    TEST_ASSERT_EQUAL_HEX8(0x40, model.regs[0x6A]); // FIFO enabled after the reset
+    TEST_ASSERT_NOT_NULL(hostPins().isr[0]);
+}
+
+void test_parse_fifo_frame_is_big_endian_signed(void)
+{
+    const uint8_t frame[12] = {0x12, 0x34, 0xFF, 0xFE, 0x80, 0x00, 0x7F, 0xFF, 0x00, 0x00, 0x00, 0x83};
+    int16_t raw[6];
+    SensorMPU::parseFifoFrame(frame, raw);
+    TEST_ASSERT_EQUAL_INT16(0x1234, raw[0]);
+    TEST_ASSERT_EQUAL_INT16(-2, raw[1]);
+    TEST_ASSERT_EQUAL_INT16(-32768, raw[2]);
+    TEST_ASSERT_EQUAL_INT16(32767, raw[3]);
+    TEST_ASSERT_EQUAL_INT16(0, raw[4]);
+    TEST_ASSERT_EQUAL_INT16(131, raw[5]);
+}
+
+void test_no_bus_traffic_without_interrupt(void)
+{
+    pushFrames(2);
+    uint16_t reads = model.readTransfers;
+    TEST_ASSERT_FALSE(drain());
+    TEST_ASSERT_EQUAL_UINT16(reads, model.readTransfers);
+    TEST_ASSERT_EQUAL_UINT8(0, sampleCount);
+}
+
+void test_every_frame_reaches_the_handler_in_order(void)
+{
+    pushFrames(3, 10);
+    hostRaiseInterrupt(0);
+    TEST_ASSERT_TRUE(drain());
+
+    TEST_ASSERT_EQUAL_UINT8(3, sampleCount);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(10 + i, samples[i].xa);
+        TEST_ASSERT_EQUAL_FLOAT(-100, samples[i].ya);
+        TEST_ASSERT_EQUAL_FLOAT(16384, samples[i].za);
+        TEST_ASSERT_EQUAL_FLOAT(1.0, samples[i].xg); // 131 LSB per °/s
+        TEST_ASSERT_EQUAL_FLOAT((-262 - i) / 131.0, samples[i].yg);
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, mpu->getSamplesDrained());
+    TEST_ASSERT_EQUAL_UINT16(0, model.count);
+
+    // The getters report the batch average
+    TEST_ASSERT_EQUAL_FLOAT(11, mpu->getAccelX());
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -0.35, mpu->getAccelRoll()); // atan2(-100, 16384) in degrees
+}
+
+void test_long_backlog_is_drained_over_several_passes(void)
+{
+    pushFrames(11);
+    hostRaiseInterrupt(0);
+    TEST_ASSERT_TRUE(drain());
+    TEST_ASSERT_EQUAL_UINT8(8, sampleCount); // one pass is bounded
+    TEST_ASSERT_EQUAL_UINT16(3 * 12, model.count);
+
+    // The rest goes on the next call, without waiting for another INT
+    TEST_ASSERT_TRUE(drain());
+    TEST_ASSERT_EQUAL_UINT8(11, sampleCount);
+    for (uint8_t i = 0; i < 11; i++)
+        TEST_ASSERT_EQUAL_FLOAT(i, samples[i].xa);
+}
+
+void test_overflow_resets_the_fifo_and_drops_the_frames(void)
+{
+    pushFrames(90); // 1080 bytes into 1024
+    TEST_ASSERT_EQUAL_HEX8(0x10, model.regs[0x3A] & 0x10);
+    uint16_t resets = model.resets;
+    hostRaiseInterrupt(0);
+    TEST_ASSERT_FALSE(drain());
+
+    TEST_ASSERT_EQUAL_UINT8(0, sampleCount);
+    TEST_ASSERT_EQUAL_UINT16(1, mpu->getFifoOverflows());
+    TEST_ASSERT_EQUAL_UINT16(resets + 1, model.resets);
+    TEST_ASSERT_EQUAL_HEX8(0x40, model.regs[0x6A]); // and re-enabled
+    TEST_ASSERT_EQUAL_UINT16(0, model.count);
+
+    // Back in step afterwards
+    pushFrames(2);
+    hostRaiseInterrupt(0);
+    TEST_ASSERT_TRUE(drain());
+    TEST_ASSERT_EQUAL_UINT8(2, sampleCount);
+}
+
+void test_misaligned_count_resets_the_fifo(void)
+{
+    pushFrames(2);
+    model.fifo[(model.head + model.count) % Mpu6050Model::CAPACITY] = 0;
+    model.count++; // a stray byte: frame boundaries unknown
+    hostRaiseInterrupt(0);
+    TEST_ASSERT_FALSE(drain());
+    TEST_ASSERT_EQUAL_UINT8(0, sampleCount);
+    TEST_ASSERT_EQUAL_UINT16(1, mpu->getFifoOverflows());
+    TEST_ASSERT_EQUAL_UINT16(0, model.count);
+}
+
+void test_blocking_update_drains_the_same_way(void)
+{
+    pushFrames(3, 5);
+    hostRaiseInterrupt(0);
+    TEST_ASSERT_TRUE(mpu->update());
+    TEST_ASSERT_EQUAL_UINT8(3, sampleCount);
+    TEST_ASSERT_EQUAL_FLOAT(6, mpu->getAccelX());
+}
+
+static MadgwickIMU *fusion;
+static uint8_t fusionSteps;
+
+static void stepFusion(const ModelIMU &sample)
+{
+    fusion->update(sample);
+    fusionSteps++;
+}
+
+void test_each_sample_is_one_fusion_step(void)
+{
+    static MadgwickIMU filter;
+    filter = MadgwickIMU();
+    filter.begin(10);
+    fusion = &filter;
+    fusionSteps = 0;
+    mpu->setSampleHandler(stepFusion);
+
+    // 20 s of a steady 10° roll at 10 Hz, drained in bursts of 5
+    int16_t frame[6] = {0, (int16_t)(16384 * sin(10 * DEG_TO_RAD)), (int16_t)(16384 * cos(10 * DEG_TO_RAD)), 0, 0, 0};
+    for (uint8_t burst = 0; burst < 40; burst++)
+    {
+        for (uint8_t i = 0; i < 5; i++)
+            model.push(frame);
+        hostRaiseInterrupt(0);
+        drain();
+    }
+    TEST_ASSERT_EQUAL_UINT8(200, fusionSteps);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 10, filter.getRoll());
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 0, filter.getPitch());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_fifo_configures_the_sensor);
+    RUN_TEST(test_parse_fifo_frame_is_big_endian_signed);
+    RUN_TEST(test_no_bus_traffic_without_interrupt);
+    RUN_TEST(test_every_frame_reaches_the_handler_in_order);
+    RUN_TEST(test_long_backlog_is_drained_over_several_passes);
+    RUN_TEST(test_overflow_resets_the_fifo_and_drops_the_frames);
+    RUN_TEST(test_misaligned_count_resets_the_fifo);
+    RUN_TEST(test_blocking_update_drains_the_same_way);
+    RUN_TEST(test_each_sample_is_one_fusion_step);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "night_schedule.h"
+
+// The firmware's night settings (src/main.cpp, include/power_down.h)
+static const uint8_t WAKE_SECONDS = 8;
+static const uint16_t NIGHT_MAX_SLEEP = 3600;
+static const uint32_t NIGHT_IDLE_MS = 120000;
+
+// Awake time per event: a watchdog wake is the oscillator start-up and a look at the
+// encoder ring, an RTC check a blocking 7 byte read at 100 kHz and the resync
+static const uint32_t WAKE_MS = 2;
+static const uint32_t RTC_CHECK_MS = 5;
+
+static const epoch_t EVENING = daysFromCivil(2025, 1, 1) * SECONDS_PER_DAY + NIGHT_START_HOUR * 3600UL; // local
+static const uint32_t NIGHT_MS = (24UL + NIGHT_END_HOUR - NIGHT_START_HOUR) * 3600000UL;
+
+static timeObject at(uint8_t hour, uint8_t minute, uint8_t second)
+{
+    timeObject t = {second, minute, hour, 1, 1, 25};
+    return t;
+}
+
+struct NightRun
+{
+    uint32_t awakeMs;
+    uint32_t wakes;
+    uint32_t rtcChecks;
+    int32_t overshootMs; // how long after NIGHT_END_HOUR the last sleep ended
+};
+
+// nightSleep() from main.cpp against a watchdog whose period is off by errorPercent
+static NightRun simulateNight(int8_t errorPercent)
+{
+    NightRun run = {NIGHT_IDLE_MS, 0, 0, 0};
+    uint32_t periodMs = WAKE_SECONDS * (1000UL + errorPercent * 10L);
+    uint32_t now = NIGHT_IDLE_MS; // ms since 20:00; awake until idle, then asleep
+
+    timeObject t = toCalendar(EVENING + now / 1000);
+    while (isNight(t))
+    {
+        uint16_t periods = nightSleepPeriods(t, WAKE_SECONDS, NIGHT_MAX_SLEEP);
+        for (uint16_t i = 0; i < periods; i++)
+        {
+            now += periodMs + WAKE_MS;
+            run.wakes++;
+            run.awakeMs += WAKE_MS;
+        }
+        now += RTC_CHECK_MS;
+        run.rtcChecks++;
+        run.awakeMs += RTC_CHECK_MS;
+        t = toCalendar(EVENING + now / 1000);
+    }
+    run.overshootMs = (int32_t)(now - NIGHT_MS);
+    return run;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_night_boundaries(void)
+{
+    TEST_ASSERT_FALSE(isNight(at(19, 59, 59)));
+    TEST_ASSERT_TRUE(isNight(at(20, 0, 0)));
+    TEST_ASSERT_TRUE(isNight(at(0, 0, 0)));
+    TEST_ASSERT_TRUE(isNight(at(3, 59, 59)));
+    TEST_ASSERT_FALSE(isNight(at(4, 0, 0)));
+    TEST_ASSERT_FALSE(isNight(at(12, 0, 0)));
+}
+
+void test_seconds_until_morning(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(8 * 3600UL, secondsUntilMorning(at(20, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT32(4 * 3600UL, secondsUntilMorning(at(0, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT32(3600UL + 1, secondsUntilMorning(at(2, 59, 59)));
+    TEST_ASSERT_EQUAL_UINT32(1, secondsUntilMorning(at(3, 59, 59)));
+}
+
+void test_sleep_periods(void)
+{
+    // Capped at an hour between RTC reads
+    TEST_ASSERT_EQUAL_UINT16(450, nightSleepPeriods(at(20, 0, 0), WAKE_SECONDS, NIGHT_MAX_SLEEP));
+    // 600 s left: plan 540 s
+    TEST_ASSERT_EQUAL_UINT16(67, nightSleepPeriods(at(3, 50, 0), WAKE_SECONDS, NIGHT_MAX_SLEEP));
+    // Never zero, or the loop would spin awake until morning
+    TEST_ASSERT_EQUAL_UINT16(1, nightSleepPeriods(at(3, 59, 58), WAKE_SECONDS, NIGHT_MAX_SLEEP));
+}
+
+void test_night_duty_cycle(void)
+{
+    static const int8_t ERRORS[] = {-10, 0, 10};
+    NightRun nominal = simulateNight(0);
+
+    for (uint8_t i = 0; i < sizeof(ERRORS); i++)
+    {
+        NightRun run = simulateNight(ERRORS[i]);
+        // Up by morning: one slow watchdog period late at most, never early
+        TEST_ASSERT_GREATER_OR_EQUAL_INT32(0, run.overshootMs);
+        TEST_ASSERT_LESS_OR_EQUAL_INT32(WAKE_SECONDS * 1100L + RTC_CHECK_MS + WAKE_MS, run.overshootMs);
+        // Awake well under 1% of the night, the idle minutes included
+        TEST_ASSERT_LESS_THAN_UINT32(NIGHT_MS / 100, run.awakeMs);
+
+        char line[160];
+        snprintf(line, sizeof(line), "watchdog %+d%%: %lu wakes, %lu RTC reads, awake %lu ms, up %ld ms after 04:00",
+                 ERRORS[i], (unsigned long)run.wakes, (unsigned long)run.rtcChecks,
+                 (unsigned long)run.awakeMs, (long)run.overshootMs);
+        TEST_MESSAGE(line);
+    }
+
+    // Before: loop() spun and the 20 ms control task ran all night
+    char line[160];
+    snprintf(line, sizeof(line), "night duty cycle: 100%% awake before, %.3f%% with power-down (%.0fx less)",
+             100.0 * nominal.awakeMs / NIGHT_MS, (double)NIGHT_MS / nominal.awakeMs);
+    TEST_MESSAGE(line);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_night_boundaries);
+    RUN_TEST(test_seconds_until_morning);
+    RUN_TEST(test_sleep_periods);
+    RUN_TEST(test_night_duty_cycle);
+    return UNITY_END();
+}
@@ -0,0 +1,172 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "eeprom_writer.h"
+#include "rtc_drift.h"
+
+static const float RATE = 0.004f; // deg/s, sun model X rate near noon
+
+static EepromWriter *writer;
+
+static void finishWrites()
+{
+    for (uint16_t i = 0; writer->busy() && i < 10000; i++)
+    {
+        writer->service();
+        hostAdvanceMicros(500);
+    }
+    TEST_ASSERT_FALSE(writer->busy());
+}
+
+// A noon window of observations with the RTC offsetSeconds behind the sun
+static bool observeDay(RtcDriftEstimator &drift, uint16_t day, float offsetSeconds)
+{
+    bool changed = false;
+    epoch_t noon = day * SECONDS_PER_DAY + 12 * 3600UL;
+    for (uint8_t i = 0; i < 20; i++)
+    {
+        epoch_t t = noon + i * RtcDriftEstimator::OBSERVATION_INTERVAL;
+        changed |= drift.observe(t, 10.0f + offsetSeconds * RATE, 10.0f, RATE);
+    }
+    return changed;
+}
+
+void setUp(void)
+{
+    hostEeprom().erase();
+    delete writer;
+    writer = new EepromWriter();
+}
+
+void tearDown(void) {}
+
+void test_no_record_starts_at_zero(void)
+{
+    RtcDriftEstimator drift;
+    TEST_ASSERT_FALSE(drift.begin());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, drift.getPpm());
+    TEST_ASSERT_FALSE(drift.needsSave());
+}
+
+void test_baseline_survives_a_reset(void)
+{
+    RtcDriftEstimator drift;
+    drift.begin();
+    observeDay(drift, 100, 0.0f);
+    TEST_ASSERT_FALSE(drift.needsSave());
+    observeDay(drift, 101, 0.0f); // closes day 100: the reference
+    TEST_ASSERT_TRUE(drift.needsSave());
+    TEST_ASSERT_TRUE(drift.save(*writer));
+    TEST_ASSERT_FALSE(drift.needsSave());
+    finishWrites();
+
+    // Reset; a week after the reference the RTC has fallen 6.048 s behind: 10 ppm
+    RtcDriftEstimator rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    observeDay(rebooted, 107, 6.048f);
+    TEST_ASSERT_TRUE(observeDay(rebooted, 108, 6.048f));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, RtcDriftEstimator::GAIN * 10.0f, rebooted.getPpm());
+    TEST_ASSERT_TRUE(rebooted.needsSave());
+
+    TEST_ASSERT_TRUE(rebooted.save(*writer));
+    finishWrites();
+    RtcDriftEstimator again;
+    TEST_ASSERT_TRUE(again.begin());
+    TEST_ASSERT_EQUAL_FLOAT(rebooted.getPpm(), again.getPpm());
+}
+
+void test_version_1_record_is_taken_over(void)
+{
+    // version, f32 ppm, crc: the layout before the reference was stored
+    uint8_t v1[6] = {1};
+    float ppm = -12.5f;
+    memcpy(&v1[1], &ppm, sizeof(ppm));
+    v1[5] = crc8(v1, 5);
+    for (uint8_t i = 0; i < sizeof(v1); i++)
+        EEPROM.write(EEPROM_RTC_DRIFT_ADDR + i, v1[i]);
+
+    RtcDriftEstimator drift;
+    TEST_ASSERT_TRUE(drift.begin());
+    TEST_ASSERT_EQUAL_FLOAT(-12.5f, drift.getPpm());
+    TEST_ASSERT_TRUE(drift.needsSave()); // rewritten as version 2
+
+    TEST_ASSERT_TRUE(drift.save(*writer));
+    finishWrites();
+    TEST_ASSERT_EQUAL_UINT8(2, EEPROM.read(EEPROM_RTC_DRIFT_ADDR));
+    RtcDriftEstimator again;
+    TEST_ASSERT_TRUE(again.begin());
+    TEST_ASSERT_EQUAL_FLOAT(-12.5f, again.getPpm());
+    TEST_ASSERT_FALSE(again.needsSave());
+}
+
+void test_corrupt_record_is_ignored(void)
+{
+    RtcDriftEstimator drift;
+    drift.begin();
+    observeDay(drift, 100, 0.0f);
+    observeDay(drift, 101, 0.0f);
+    drift.save(*writer);
+    finishWrites();
+    EEPROM.write(EEPROM_RTC_DRIFT_ADDR + 3, EEPROM.read(EEPROM_RTC_DRIFT_ADDR + 3) ^ 0x10);
+
+    RtcDriftEstimator rebooted;
+    TEST_ASSERT_FALSE(rebooted.begin());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rebooted.getPpm());
+}
+
+void test_record_fits_its_region(void)
+{
+    RtcDriftEstimator drift;
+    drift.begin();
+    observeDay(drift, 100, 0.0f);
+    observeDay(drift, 101, 0.0f);
+    drift.save(*writer);
+    finishWrites();
+
+    // 14 bytes from EEPROM_RTC_DRIFT_ADDR, nothing at or past the state ring
+    for (uint16_t a = 0; a < HostEeprom::SIZE; a++)
+    {
+        bool inRecord = a >= EEPROM_RTC_DRIFT_ADDR && a < EEPROM_RTC_DRIFT_ADDR + 14;
+        if (!inRecord && hostEeprom().writes[a] != 0)
+            TEST_FAIL_MESSAGE("drift record wrote outside its region");
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_INT(EEPROM_STATE_ADDR, EEPROM_RTC_DRIFT_ADDR + 14);
+}
+
+void test_rejected_observations_are_rate_limited(void)
+{
+    RtcDriftEstimator drift;
+    drift.begin();
+    epoch_t morning = 100 * SECONDS_PER_DAY + 8 * 3600UL;
+
+    // observeDrift() from the 20 ms control task for ten minutes, away from noon:
+    // every observation is rejected for its low X rate
+    uint16_t runs = 0;
+    for (uint32_t tick = 0; tick < 10 * 60 * 50UL; tick++)
+    {
+        epoch_t t = morning + tick / 50;
+        if (!drift.wantsObservation(t))
+            continue;
+        runs++; // two sun model evaluations in observeDrift()
+        drift.observe(t, 10.0f, 10.0f, RtcDriftEstimator::MIN_X_RATE / 2);
+    }
+    TEST_ASSERT_EQUAL_UINT16(10, runs);
+
+    // The same for a reading too far off to be the sun
+    epoch_t noon = 100 * SECONDS_PER_DAY + 12 * 3600UL;
+    TEST_ASSERT_TRUE(drift.wantsObservation(noon));
+    drift.observe(noon, 40.0f, 10.0f, RATE);
+    TEST_ASSERT_FALSE(drift.wantsObservation(noon + RtcDriftEstimator::OBSERVATION_INTERVAL - 1));
+    TEST_ASSERT_TRUE(drift.wantsObservation(noon + RtcDriftEstimator::OBSERVATION_INTERVAL));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_record_starts_at_zero);
+    RUN_TEST(test_baseline_survives_a_reset);
+    RUN_TEST(test_version_1_record_is_taken_over);
+    RUN_TEST(test_corrupt_record_is_ignored);
+    RUN_TEST(test_record_fits_its_region);
+    RUN_TEST(test_rejected_observations_are_rate_limited);
+    return UNITY_END();
+}
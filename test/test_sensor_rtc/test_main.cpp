@@ -0,0 +1,265 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "twi_model.h"
+#include "i2c_bus.h"
+#include "sensor_rtc.h"
+#include "time_service.h"
+
+static const uint8_t RTC_ADDR = 0x68;
+
+static I2CBus *bus;
+static SensorRTC *rtc;
+static RegisterFileDevice ds3231;
+
+// Seconds .. year registers, BCD as the DS3231 holds them
+static void setRegisters(uint8_t sec, uint8_t min, uint8_t hour, uint8_t dow, uint8_t day, uint8_t month, uint8_t year)
+{
+    uint8_t regs[] = {sec, min, hour, dow, day, month, year};
+    memcpy(ds3231.regs, regs, sizeof(regs));
+}
+
+static void drain()
+{
+    for (uint16_t calls = 0; bus->pending() && calls < 10000; calls++)
+    {
+        bus->service();
+        hostAdvanceMicros(20);
+    }
+}
+
+// Queue one read of the time registers and run it; true if the sample was accepted
+static bool readOnce()
+{
+    rtc->requestUpdate(*bus);
+    drain();
+    return rtc->consumeFresh();
+}
+
+void setUp(void)
+{
+    hostI2C().detachAll();
+    ds3231 = RegisterFileDevice();
+    hostI2C().attach(RTC_ADDR, &ds3231);
+    hostTwi().install();
+    static I2CBus busInstance;
+    busInstance = I2CBus();
+    bus = &busInstance;
+    bus->begin(2000);
+    delete rtc;
+    rtc = new SensorRTC();
+
+    // 2025-08-20 21:03:00, a Wednesday
+    setRegisters(0x00, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25);
+}
+
+void tearDown(void)
+{
+    hostTwi().uninstall();
+}
+
+void test_valid_read_is_decoded(void)
+{
+    TEST_ASSERT_TRUE(readOnce());
+    timeObject t = rtc->getData();
+    TEST_ASSERT_EQUAL_UINT8(0, t.second);
+    TEST_ASSERT_EQUAL_UINT8(3, t.minute);
+    TEST_ASSERT_EQUAL_UINT8(21, t.hour);
+    TEST_ASSERT_EQUAL_UINT8(20, t.day);
+    TEST_ASSERT_EQUAL_UINT8(8, t.month);
+    TEST_ASSERT_EQUAL_UINT8(25, t.year);
+    TEST_ASSERT_EQUAL_UINT16(0, rtc->getRejected());
+}
+
+void test_status_bits_are_masked(void)
+{
+    // DS1307 CH bit on seconds, DS3231 century bit on the month
+    setRegisters(0x80 | 0x59, 0x59, 0x23, 0x07, 0x31, 0x80 | 0x12, 0x99);
+    TEST_ASSERT_TRUE(readOnce());
+    timeObject t = rtc->getData();
+    TEST_ASSERT_EQUAL_UINT8(59, t.second);
+    TEST_ASSERT_EQUAL_UINT8(12, t.month);
+    TEST_ASSERT_EQUAL_UINT8(99, t.year);
+}
+
+void test_out_of_range_fields_are_rejected(void)
+{
+    TEST_ASSERT_TRUE(readOnce());
+    const uint8_t good[] = {0x00, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25};
+    // register, bad value
+    const uint8_t cases[][2] = {
+        {0, 0x60}, // second 60
+        {1, 0x60}, // minute 60
+        {2, 0x24}, // hour 24
+        {2, 0x52}, // 12h mode flag
+        {3, 0x00}, // day of week 0
+        {4, 0x00}, // day 0
+        {4, 0x32}, // day 32
+        {5, 0x00}, // month 0
+        {5, 0x13}, // month 13
+        {6, 0xA0}, // year 100
+    };
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        memcpy(ds3231.regs, good, sizeof(good));
+        ds3231.regs[cases[i][0]] = cases[i][1];
+        TEST_ASSERT_FALSE_MESSAGE(readOnce(), "bad field accepted");
+    }
+    TEST_ASSERT_EQUAL_UINT16(sizeof(cases) / sizeof(cases[0]), rtc->getRejected());
+
+    // The last good time survives
+    timeObject t = rtc->getData();
+    TEST_ASSERT_EQUAL_UINT8(20, t.day);
+    TEST_ASSERT_EQUAL_UINT8(21, t.hour);
+}
+
+void test_non_bcd_nibbles_are_rejected(void)
+{
+    // 0x1A minutes would decode to 20 and pass a plain range check
+    setRegisters(0x00, 0x1A, 0x21, 0x04, 0x20, 0x08, 0x25);
+    TEST_ASSERT_FALSE(readOnce());
+    setRegisters(0x00, 0x03, 0x0F, 0x04, 0x20, 0x08, 0x25);
+    TEST_ASSERT_FALSE(readOnce());
+    setRegisters(0x00, 0x03, 0x21, 0x04, 0x20, 0x08, 0x2C);
+    TEST_ASSERT_FALSE(readOnce());
+    TEST_ASSERT_EQUAL_UINT16(3, rtc->getRejected());
+}
+
+void test_day_must_exist_in_month(void)
+{
+    setRegisters(0x00, 0x00, 0x12, 0x05, 0x29, 0x02, 0x24); // 2024-02-29, leap year
+    TEST_ASSERT_TRUE(readOnce());
+    setRegisters(0x00, 0x00, 0x12, 0x06, 0x29, 0x02, 0x25); // 2025-02-29
+    TEST_ASSERT_FALSE(readOnce());
+    setRegisters(0x00, 0x00, 0x12, 0x05, 0x31, 0x04, 0x25); // April 31
+    TEST_ASSERT_FALSE(readOnce());
+    setRegisters(0x00, 0x00, 0x12, 0x05, 0x31, 0x12, 0x25); // December 31
+    TEST_ASSERT_TRUE(readOnce());
+    setRegisters(0x00, 0x00, 0x12, 0x03, 0x29, 0x02, 0x00); // 2000-02-29, divisible by 400
+    TEST_ASSERT_TRUE(readOnce());
+}
+
+void test_blocking_update_rejects_invalid_time(void)
+{
+    TEST_ASSERT_TRUE(rtc->update());
+    setRegisters(0x00, 0x00, 0x25, 0x04, 0x20, 0x08, 0x25);
+    TEST_ASSERT_FALSE(rtc->update());
+    TEST_ASSERT_EQUAL_UINT8(21, rtc->getData().hour);
+    TEST_ASSERT_EQUAL_UINT16(1, rtc->getRejected());
+}
+
+void test_time_service_does_not_rebase_on_garbage(void)
+{
+    TimeZone utc = {0};
+    TimeService time(*rtc, utc);
+    time.begin(1000);
+    epoch_t base = time.epochSeconds();
+    TEST_ASSERT_EQUAL_UINT32(fromCalendar(rtc->getData()), base);
+
+    // An all-ones read, as from a bus glitch, would be 2165-..; it must not move the clock
+    memset(ds3231.regs, 0xFF, 7);
+    hostAdvanceMillis(1000);
+    time.update(*bus);
+    drain();
+    time.update(*bus);
+    TEST_ASSERT_EQUAL_UINT32(base + 1, time.epochSeconds());
+    TEST_ASSERT_EQUAL_UINT16(1, rtc->getRejected());
+
+    // Blocking resync, as after a power-down sleep, keeps the old base as well
+    hostAdvanceMillis(1000);
+    time.resync();
+    TEST_ASSERT_EQUAL_UINT32(base + 2, time.epochSeconds());
+
+    // A good read afterwards is taken
+    setRegisters(0x30, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25);
+    hostAdvanceMillis(1000);
+    time.update(*bus);
+    drain();
+    time.update(*bus);
+    TEST_ASSERT_EQUAL_UINT32(base + 30, time.epochSeconds());
+}
+
+void test_drift_step_is_a_queued_write(void)
+{
+    TimeZone utc = {0};
+    TimeService time(*rtc, utc);
+    time.begin(1000);
+    epoch_t base = time.epochSeconds();
+    time.setDriftPpm(100000); // 0.1 s/s, a 2 s step after 20 s
+
+    setRegisters(0x20, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25);
+    hostAdvanceMillis(20000);
+    time.update(*bus);
+    drain();
+
+    // The rebase queues the step and returns without touching the bus
+    uint16_t writes = ds3231.writeTransfers;
+    uint32_t before = micros();
+    time.update(*bus);
+    TEST_ASSERT_EQUAL_UINT32(before, micros());
+    TEST_ASSERT_EQUAL_UINT16(writes, ds3231.writeTransfers);
+    TEST_ASSERT_EQUAL_UINT8(1, bus->pending());
+    TEST_ASSERT_EQUAL_UINT32(base + 22, time.epochSeconds());
+
+    drain();
+    const uint8_t expected[] = {0x22, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, ds3231.regs, sizeof(expected));
+}
+
+void test_adjust_carries_across_midnight(void)
+{
+    setRegisters(0x59, 0x59, 0x23, 0x07, 0x31, 0x12, 0x25); // Saturday 2025-12-31 23:59:59
+    TEST_ASSERT_TRUE(readOnce());
+    TEST_ASSERT_TRUE(rtc->requestAdjust(*bus, 2));
+    TEST_ASSERT_FALSE(rtc->requestAdjust(*bus, 2)); // one step on the bus at a time
+    drain();
+    const uint8_t expected[] = {0x01, 0x00, 0x00, 0x05, 0x01, 0x01, 0x26}; // Thursday 2026-01-01
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, ds3231.regs, sizeof(expected));
+    TEST_ASSERT_TRUE(rtc->requestAdjust(*bus, -2));
+}
+
+void test_no_adjust_before_a_valid_read(void)
+{
+    TEST_ASSERT_FALSE(rtc->requestAdjust(*bus, 1));
+    TEST_ASSERT_EQUAL_UINT8(0, bus->pending());
+}
+
+void test_blocking_resync_defers_the_step(void)
+{
+    TimeZone utc = {0};
+    TimeService time(*rtc, utc);
+    time.begin(1000);
+    time.setDriftPpm(100000);
+
+    setRegisters(0x20, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25);
+    hostAdvanceMillis(20000);
+    uint16_t writes = ds3231.writeTransfers;
+    time.resync();
+    TEST_ASSERT_EQUAL_UINT8(0, bus->pending());
+    TEST_ASSERT_EQUAL_UINT16(writes + 1, ds3231.writeTransfers); // the register pointer for the read only
+
+    // The next queued read carries the step
+    setRegisters(0x30, 0x03, 0x21, 0x04, 0x20, 0x08, 0x25);
+    hostAdvanceMillis(10000);
+    time.update(*bus);
+    drain();
+    time.update(*bus);
+    drain();
+    TEST_ASSERT_EQUAL_HEX8(0x33, ds3231.regs[0]); // 2 s held over plus 1 s for these 10
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_valid_read_is_decoded);
+    RUN_TEST(test_status_bits_are_masked);
+    RUN_TEST(test_out_of_range_fields_are_rejected);
+    RUN_TEST(test_non_bcd_nibbles_are_rejected);
+    RUN_TEST(test_day_must_exist_in_month);
+    RUN_TEST(test_blocking_update_rejects_invalid_time);
+    RUN_TEST(test_time_service_does_not_rebase_on_garbage);
+    RUN_TEST(test_drift_step_is_a_queued_write);
+    RUN_TEST(test_adjust_carries_across_midnight);
+    RUN_TEST(test_no_adjust_before_a_valid_read);
+    RUN_TEST(test_blocking_resync_defers_the_step);
+    return UNITY_END();
+}
@@ -0,0 +1,405 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "print_buffer.h"
+#include "eeprom_writer.h"
+#include "control_tuning.h"
+#include "serial_commands.h"
+#include "telemetry_log.h"
+
+// Parameter ids, in TuningTable::PARAMS order
+static const uint8_t ID_KP_X = 0;
+static const uint8_t ID_MIN_SPEED = 3;
+static const uint8_t ID_MAX_SPEED = 4;
+
+static ControlTuning tuning;
+static TuningTable table(tuning);
+static EepromWriter *writer;
+static SerialCommands *commands;
+static ImuCalibration calibration;
+static TwoPointCapture *capture;
+
+// Replies as the host tool sees them
+static FrameReader replies;
+static uint8_t replyType;
+static uint8_t replyData[FrameWriter::MAX_PAYLOAD];
+static uint8_t replyLength;
+static uint16_t replyOffset;
+
+static void statusDump(Print &out)
+{
+    out.print(F("status ok\n"));
+}
+
+// Encode a request as tools/tune.py does and hand it to the firmware's port
+static void send(uint8_t type, const uint8_t *payload = nullptr, uint8_t length = 0)
+{
+    static HardwareSerial host;
+    host.hostClear();
+    FrameWriter frame;
+    frame.begin(type);
+    for (uint8_t i = 0; i < length; i++)
+        frame.put8(payload[i]);
+    frame.end(host);
+    Serial.hostReceive(host.tx, host.txLength);
+}
+
+// Next reply frame the firmware sent, false if there is none
+static bool nextReply()
+{
+    while (replyOffset < Serial.txLength)
+    {
+        if (replies.feed(Serial.tx[replyOffset++]))
+        {
+            replyType = replies.type();
+            replyLength = replies.length();
+            memcpy(replyData, replies.data(), replyLength);
+            return true;
+        }
+    }
+    return false;
+}
+
+// One request, one serviced loop pass, one reply
+static bool exchange(uint8_t type, const uint8_t *payload = nullptr, uint8_t length = 0)
+{
+    Serial.hostDrain();
+    send(type, payload, length);
+    commands->service();
+    return nextReply();
+}
+
+static float replyFloat(uint8_t offset)
+{
+    float value;
+    memcpy(&value, &replyData[offset], sizeof(value));
+    return value;
+}
+
+static float setParam(uint8_t id, float value)
+{
+    uint8_t payload[5] = {id};
+    memcpy(&payload[1], &value, sizeof(value));
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SET, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_GET, replyType);
+    TEST_ASSERT_EQUAL_UINT8(id, replyData[0]);
+    return replyFloat(1);
+}
+
+static void assertError(uint8_t request, uint8_t error)
+{
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY_ERROR, replyType);
+    TEST_ASSERT_EQUAL_HEX8(request, replyData[0]);
+    TEST_ASSERT_EQUAL_UINT8(error, replyData[1]);
+}
+
+// Let loop() run until the background EEPROM writes are out
+static void finishWrites()
+{
+    for (uint16_t i = 0; writer->busy() && i < 10000; i++)
+    {
+        writer->service();
+        hostAdvanceMicros(500);
+    }
+    TEST_ASSERT_FALSE(writer->busy());
+}
+
+void setUp(void)
+{
+    hostEeprom().erase();
+    Serial.hostClear();
+    replies = FrameReader();
+    replyOffset = 0;
+    tuning = ControlTuning();
+    calibration.setDefaults();
+    delete writer;
+    delete commands;
+    delete capture;
+    writer = new EepromWriter();
+    commands = new SerialCommands(Serial, table, *writer);
+    capture = new TwoPointCapture();
+}
+
+void tearDown(void) {}
+
+void test_describe_get_and_set(void)
+{
+    uint8_t id = ID_MAX_SPEED;
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_DESCRIBE, &id, 1));
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_DESCRIBE, replyType);
+    TEST_ASSERT_EQUAL_UINT8(ID_MAX_SPEED, replyData[0]);
+    TEST_ASSERT_EQUAL_UINT8(table.count(), replyData[1]);
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, replyFloat(2));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, replyFloat(6));
+    TEST_ASSERT_EQUAL_FLOAT(255.0f, replyFloat(10));
+    TEST_ASSERT_EQUAL_UINT8(14 + 9, replyLength);
+    TEST_ASSERT_EQUAL_MEMORY("max_speed", &replyData[14], 9);
+
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, setParam(ID_KP_X, 42.5f));
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, tuning.kpX);
+
+    id = ID_KP_X;
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_GET, &id, 1));
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_GET, replyType);
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, replyFloat(1));
+
+    // Out of range is clamped and the reply says what was applied
+    TEST_ASSERT_EQUAL_FLOAT(200.0f, setParam(ID_KP_X, 1000.0f));
+}
+
+void test_bad_requests_get_errors(void)
+{
+    uint8_t id = 200;
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_GET, &id, 1));
+    assertError(SerialCommands::CMD_GET, SerialCommands::ERROR_ID);
+
+    uint8_t shortSet[3] = {ID_KP_X, 0, 0};
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SET, shortSet, sizeof(shortSet)));
+    assertError(SerialCommands::CMD_SET, SerialCommands::ERROR_VALUE);
+
+    float nan = NAN;
+    uint8_t nanSet[5] = {ID_KP_X};
+    memcpy(&nanSet[1], &nan, sizeof(nan));
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SET, nanSet, sizeof(nanSet)));
+    assertError(SerialCommands::CMD_SET, SerialCommands::ERROR_VALUE);
+
+    TEST_ASSERT_TRUE(exchange(0x3C));
+    assertError(0x3C, SerialCommands::ERROR_COMMAND);
+
+    // PROFILE needs a status writer
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_PROFILE));
+    assertError(SerialCommands::CMD_PROFILE, SerialCommands::ERROR_COMMAND);
+}
+
+void test_corrupt_frame_is_ignored(void)
+{
+    static const uint8_t garbage[] = {0x03, 0x11, 0x7E, 0x55, 0x00};
+    Serial.hostReceive(garbage, sizeof(garbage));
+    uint8_t id = ID_KP_X;
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_GET, &id, 1));
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_GET, replyType);
+    TEST_ASSERT_FALSE(nextReply()); // nothing for the garbage
+}
+
+void test_profile_writes_status_text(void)
+{
+    commands->setStatusDump(statusDump);
+    Serial.hostDrain();
+    send(SerialCommands::CMD_PROFILE);
+    commands->service();
+    Serial.tx[Serial.txLength] = '\0';
+    TEST_ASSERT_EQUAL_STRING("status ok\n", (const char *)Serial.tx);
+}
+
+void test_speed_range_cannot_invert(void)
+{
+    // Defaults: min 75, max 180
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, setParam(ID_MIN_SPEED, 200.0f));
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, tuning.minSpeed);
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, setParam(ID_MAX_SPEED, 100.0f));
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, tuning.maxSpeed);
+
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, setParam(ID_MIN_SPEED, 60.0f));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, setParam(ID_MAX_SPEED, 100.0f));
+    TEST_ASSERT_TRUE(tuning.minSpeed <= tuning.maxSpeed);
+}
+
+void test_save_does_not_block(void)
+{
+    setParam(ID_KP_X, 33.0f);
+
+    uint32_t before = micros();
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SAVE));
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_SAVE, replyType);
+    TEST_ASSERT_EQUAL_UINT32(before, micros()); // queued, nothing written yet
+    TEST_ASSERT_TRUE(writer->busy());
+    TEST_ASSERT_TRUE(writer->pending(EEPROM_TUNING_ADDR));
+
+    // Each loop pass writes one byte at most and never waits for the EEPROM
+    uint16_t passes = 0;
+    while (writer->busy())
+    {
+        uint32_t start = micros();
+        uint32_t writes = hostEeprom().totalWrites;
+        writer->service();
+        TEST_ASSERT_EQUAL_UINT32(start, micros());
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(writes + 1, hostEeprom().totalWrites);
+        hostAdvanceMicros(1000);
+        passes++;
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(sizeof(ControlTuning), passes);
+
+    // A fresh boot loads it back
+    ControlTuning loaded;
+    TuningTable reboot(loaded);
+    TEST_ASSERT_TRUE(reboot.begin());
+    TEST_ASSERT_EQUAL_FLOAT(33.0f, loaded.kpX);
+}
+
+void test_unchanged_bytes_are_skipped(void)
+{
+    TEST_ASSERT_TRUE(table.save(*writer));
+    finishWrites();
+    uint32_t writes = hostEeprom().totalWrites;
+
+    TEST_ASSERT_TRUE(table.save(*writer));
+    finishWrites();
+    TEST_ASSERT_EQUAL_UINT32(writes, hostEeprom().totalWrites);
+
+    // One float changed: its bytes and the CRC, not the whole record
+    tuning.ldrStep = 0.5f;
+    TEST_ASSERT_TRUE(table.save(*writer));
+    finishWrites();
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(writes + 5, hostEeprom().totalWrites);
+}
+
+void test_save_reports_busy_when_writer_is_full(void)
+{
+    uint8_t filler[EepromWriter::CAPACITY - 10] = {0};
+    TEST_ASSERT_TRUE(writer->write(600, filler, sizeof(filler)));
+
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SAVE));
+    assertError(SerialCommands::CMD_SAVE, SerialCommands::ERROR_BUSY);
+
+    finishWrites();
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SAVE));
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_SAVE, replyType);
+}
+
+void test_writer_shares_eeprom_with_telemetry(void)
+{
+    TelemetryLog log(EEPROM_TELEMETRY_ADDR, EEPROM_TELEMETRY_SIZE);
+    log.begin(300);
+    TelemetrySample sample = {1000, 1.0f, 2.0f, 3.0f, 4.0f, 50, 0, 0};
+    TEST_ASSERT_TRUE(log.log(sample));
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_SAVE));
+
+    // loop() services both; neither may wait on a write the other started
+    for (uint16_t i = 0; (log.busy() || writer->busy()) && i < 10000; i++)
+    {
+        uint32_t start = micros();
+        log.service();
+        writer->service();
+        TEST_ASSERT_EQUAL_UINT32(start, micros());
+        hostAdvanceMicros(500);
+    }
+    TEST_ASSERT_FALSE(log.busy());
+    TEST_ASSERT_FALSE(writer->busy());
+
+    ControlTuning loaded;
+    TuningTable reboot(loaded);
+    TEST_ASSERT_TRUE(reboot.begin());
+}
+
+void test_inverted_record_loads_defaults(void)
+{
+    tuning.minSpeed = 200; // only possible by writing the struct directly
+    tuning.maxSpeed = 100;
+    TEST_ASSERT_TRUE(table.save(*writer));
+    finishWrites();
+
+    ControlTuning loaded;
+    TuningTable reboot(loaded);
+    TEST_ASSERT_FALSE(reboot.begin());
+    TEST_ASSERT_EQUAL_FLOAT(75.0f, loaded.minSpeed);
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, loaded.maxSpeed);
+}
+
+static uint8_t calibrate(uint8_t action, float roll = 0, float pitch = 0)
+{
+    uint8_t payload[9] = {action};
+    memcpy(&payload[1], &roll, sizeof(roll));
+    memcpy(&payload[5], &pitch, sizeof(pitch));
+    TEST_ASSERT_TRUE(exchange(SerialCommands::CMD_CALIBRATE, payload, action <= 1 ? 9 : 1));
+    if (replyType == SerialCommands::REPLY_ERROR)
+        return replyData[1];
+    TEST_ASSERT_EQUAL_HEX8(SerialCommands::REPLY | SerialCommands::CMD_CALIBRATE, replyType);
+    TEST_ASSERT_EQUAL_UINT8(action, replyData[0]);
+    return 0;
+}
+
+// The sensor task's share of a capture: SAMPLES fused samples around a mean
+static void holdPose(float rawRoll, float rawPitch)
+{
+    for (uint8_t i = 0; i < TwoPointCapture::SAMPLES; i++)
+    {
+        float noise = (i % 2 ? 0.2f : -0.2f);
+        capture->add(rawRoll + noise, rawPitch - noise);
+    }
+}
+
+void test_calibrate_needs_a_capture(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(SerialCommands::ERROR_COMMAND, calibrate(SerialCommands::CALIBRATE_STATUS));
+}
+
+void test_two_point_calibration(void)
+{
+    commands->setCalibration(capture, &calibration);
+
+    // Raw roll reads 1.1x + 0.5 of the true angle, raw pitch 0.9x - 1
+    TEST_ASSERT_EQUAL_UINT8(0, calibrate(SerialCommands::CALIBRATE_POINT_0, 0.0f, 0.0f));
+    TEST_ASSERT_EQUAL_HEX8(0x80, replyData[1]);
+    holdPose(0.5f, -1.0f);
+    TEST_ASSERT_EQUAL_UINT8(0, calibrate(SerialCommands::CALIBRATE_STATUS));
+    TEST_ASSERT_EQUAL_HEX8(0x01, replyData[1]);
+
+    TEST_ASSERT_EQUAL_UINT8(0, calibrate(SerialCommands::CALIBRATE_POINT_1, 30.0f, -20.0f));
+    TEST_ASSERT_EQUAL_UINT8(SerialCommands::ERROR_BUSY, calibrate(SerialCommands::CALIBRATE_SOLVE));
+    holdPose(33.5f, -19.0f);
+
+    TEST_ASSERT_EQUAL_UINT8(0, calibrate(SerialCommands::CALIBRATE_SOLVE));
+    TEST_ASSERT_EQUAL_HEX8(0x03, replyData[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f / 1.1f, replyFloat(2));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -0.5f / 1.1f, replyFloat(6));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f / 0.9f, replyFloat(10));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f / 0.9f, replyFloat(14));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 30.0f, calibration.roll.apply(33.5f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -20.0f, calibration.pitch.apply(-19.0f));
+
+    // Saved in the background, loaded on the next boot
+    TEST_ASSERT_TRUE(writer->pending(EEPROM_IMU_CAL_ADDR));
+    finishWrites();
+    ImuCalibration rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_FLOAT(calibration.roll.scale, rebooted.roll.scale);
+    TEST_ASSERT_EQUAL_FLOAT(calibration.pitch.offset, rebooted.pitch.offset);
+}
+
+void test_calibration_rejects_bad_captures(void)
+{
+    commands->setCalibration(capture, &calibration);
+    float rollScale = calibration.roll.scale;
+
+    // Only one point
+    calibrate(SerialCommands::CALIBRATE_POINT_0, 0.0f, 0.0f);
+    holdPose(0.0f, 0.0f);
+    TEST_ASSERT_EQUAL_UINT8(SerialCommands::ERROR_VALUE, calibrate(SerialCommands::CALIBRATE_SOLVE));
+
+    // Second pose the same as the first on pitch
+    calibrate(SerialCommands::CALIBRATE_POINT_1, 30.0f, 0.0f);
+    holdPose(30.0f, 0.3f);
+    TEST_ASSERT_EQUAL_UINT8(SerialCommands::ERROR_VALUE, calibrate(SerialCommands::CALIBRATE_SOLVE));
+
+    TEST_ASSERT_EQUAL_UINT8(SerialCommands::ERROR_VALUE, calibrate(7));
+    TEST_ASSERT_EQUAL_FLOAT(rollScale, calibration.roll.scale);
+    TEST_ASSERT_FALSE(writer->busy());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_describe_get_and_set);
+    RUN_TEST(test_bad_requests_get_errors);
+    RUN_TEST(test_corrupt_frame_is_ignored);
+    RUN_TEST(test_profile_writes_status_text);
+    RUN_TEST(test_speed_range_cannot_invert);
+    RUN_TEST(test_save_does_not_block);
+    RUN_TEST(test_unchanged_bytes_are_skipped);
+    RUN_TEST(test_save_reports_busy_when_writer_is_full);
+    RUN_TEST(test_writer_shares_eeprom_with_telemetry);
+    RUN_TEST(test_inverted_record_loads_defaults);
+    RUN_TEST(test_calibrate_needs_a_capture);
+    RUN_TEST(test_two_point_calibration);
+    RUN_TEST(test_calibration_rejects_bad_captures);
+    return UNITY_END();
+}
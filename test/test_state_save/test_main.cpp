@@ -0,0 +1,287 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "eeprom_ring.h"
+#include "state_save.h"
+
+static const int RING_ADDR = 100;
+static const int RING_SIZE = 60; // 10 slots of a 6 byte record
+
+struct Sample
+{
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+};
+
+static int slotAddress(uint8_t slot)
+{
+    return RING_ADDR + slot * (3 + sizeof(Sample)); // version, sequence, value, crc
+}
+
+static EepromWriter *writer;
+
+static Sample sample(uint8_t n)
+{
+    Sample s = {n, (uint8_t)(n * 3), (uint8_t)~n};
+    return s;
+}
+
+static void finishWrites()
+{
+    for (uint16_t i = 0; writer->busy() && i < 10000; i++)
+    {
+        writer->service();
+        hostAdvanceMicros(500);
+    }
+    TEST_ASSERT_FALSE(writer->busy());
+}
+
+// Queue a save and let the writer put it out
+static bool save(EepromRing<Sample> &ring, const Sample &value)
+{
+    bool queued = ring.save(value, *writer);
+    finishWrites();
+    return queued;
+}
+
+void setUp(void)
+{
+    hostEeprom().erase();
+    delete writer;
+    writer = new EepromWriter();
+}
+
+void tearDown(void) {}
+
+void test_empty_ring_loads_nothing(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s = sample(42);
+    TEST_ASSERT_EQUAL_UINT8(10, ring.getSlots());
+    TEST_ASSERT_FALSE(ring.load(s));
+    TEST_ASSERT_EQUAL_UINT8(42, s.a); // untouched
+}
+
+void test_newest_record_survives_a_reset_across_wraps(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+    // Past 255 saves, so the sequence number wraps as well as the slot
+    for (uint16_t n = 1; n <= 300; n++)
+        TEST_ASSERT_TRUE(save(ring, sample(n)));
+
+    EepromRing<Sample> rebooted(RING_ADDR, RING_SIZE, 1);
+    TEST_ASSERT_TRUE(rebooted.load(s));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)300, s.a);
+
+    // and it carries on from there
+    TEST_ASSERT_TRUE(save(rebooted, sample(7)));
+    EepromRing<Sample> again(RING_ADDR, RING_SIZE, 1);
+    TEST_ASSERT_TRUE(again.load(s));
+    TEST_ASSERT_EQUAL_UINT8(7, s.a);
+}
+
+void test_torn_write_falls_back_to_the_previous_record(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+    for (uint8_t n = 1; n <= 5; n++)
+        save(ring, sample(n));
+
+    // Reset halfway through the sixth save: version and sequence written, the rest not
+    EEPROM.write(slotAddress(5), 1);
+    EEPROM.write(slotAddress(5) + 1, 6);
+
+    EepromRing<Sample> rebooted(RING_ADDR, RING_SIZE, 1);
+    TEST_ASSERT_TRUE(rebooted.load(s));
+    TEST_ASSERT_EQUAL_UINT8(5, s.a);
+
+    // A bit flip in the newest complete record falls back one more
+    EEPROM.write(slotAddress(4) + 3, EEPROM.read(slotAddress(4) + 3) ^ 0x01);
+    EepromRing<Sample> flipped(RING_ADDR, RING_SIZE, 1);
+    TEST_ASSERT_TRUE(flipped.load(s));
+    TEST_ASSERT_EQUAL_UINT8(4, s.a);
+}
+
+void test_other_version_is_ignored(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+    save(ring, sample(9));
+
+    EepromRing<Sample> newer(RING_ADDR, RING_SIZE, 2);
+    TEST_ASSERT_FALSE(newer.load(s));
+}
+
+void test_unchanged_value_writes_nothing(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+    save(ring, sample(3));
+    uint32_t writes = hostEeprom().totalWrites;
+    TEST_ASSERT_FALSE(save(ring, sample(3)));
+    TEST_ASSERT_EQUAL_UINT32(writes, hostEeprom().totalWrites);
+}
+
+void test_writes_are_spread_over_the_slots(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+    const uint16_t SAVES = 1200;
+    for (uint16_t n = 0; n < SAVES; n++)
+        save(ring, sample(n));
+
+    uint32_t worst = 0;
+    for (int a = RING_ADDR; a < RING_ADDR + RING_SIZE; a++)
+        worst = max(worst, hostEeprom().writes[a]);
+    // A fixed location would take every save; 10 slots take a tenth each
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(SAVES / 10, worst);
+
+    char line[100];
+    snprintf(line, sizeof(line), "%u saves: worst cell written %lu times, a fixed location %u",
+             SAVES, (unsigned long)worst, SAVES);
+    TEST_MESSAGE(line);
+}
+
+void test_version_1_state_is_moved_into_the_ring(void)
+{
+    // AppState::MANUAL, ManualSelection::Y, in edit, x 12, y -5 at bytes 0..4
+    const uint8_t v1[5] = {2, 1, 1, 12, (uint8_t)-5};
+    for (uint8_t i = 0; i < 5; i++)
+        EEPROM.write(i, v1[i]);
+
+    StateSave state(*writer);
+    TEST_ASSERT_TRUE(state.initialization());
+    finishWrites();
+    SystemStructure s = state.getState();
+    TEST_ASSERT_EQUAL_UINT8(AppState::MANUAL, s.state);
+    TEST_ASSERT_EQUAL_UINT8(ManualSelection::Y, s.selection);
+    TEST_ASSERT_TRUE(s.inEditMode);
+    TEST_ASSERT_EQUAL_INT(12, s.xVal);
+    TEST_ASSERT_EQUAL_INT(-5, s.yVal);
+    for (uint8_t i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.read(i));
+
+    // The next boot reads the ring
+    StateSave rebooted(*writer);
+    TEST_ASSERT_TRUE(rebooted.initialization());
+    TEST_ASSERT_EQUAL_INT(-5, rebooted.getState().yVal);
+}
+
+void test_invalid_version_1_state_is_erased(void)
+{
+    const uint8_t v1[5] = {7, 9, 0, 0, 0};
+    for (uint8_t i = 0; i < 5; i++)
+        EEPROM.write(i, v1[i]);
+
+    StateSave state(*writer);
+    TEST_ASSERT_FALSE(state.initialization());
+    finishWrites();
+    TEST_ASSERT_EQUAL_UINT8(AppState::AUTOMATIC, state.getState().state);
+    for (uint8_t i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.read(i));
+}
+
+void test_erased_version_1_area_is_not_written(void)
+{
+    StateSave state(*writer);
+    TEST_ASSERT_FALSE(state.initialization());
+    TEST_ASSERT_FALSE(writer->busy());
+    for (uint8_t i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_UINT32(0, hostEeprom().writes[i]);
+}
+
+void test_save_does_not_block(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+
+    uint32_t start = micros();
+    TEST_ASSERT_TRUE(ring.save(sample(1), *writer));
+    TEST_ASSERT_EQUAL_UINT32(start, micros()); // queued, no EEPROM wait
+    TEST_ASSERT_EQUAL_UINT32(0, hostEeprom().totalWrites);
+    TEST_ASSERT_TRUE(ring.saving());
+
+    // One save in flight: the next waits for it instead of taking a slot
+    TEST_ASSERT_FALSE(ring.save(sample(2), *writer));
+
+    // Each service() starts at most one byte write and returns
+    while (writer->busy())
+    {
+        uint32_t before = micros();
+        writer->service();
+        TEST_ASSERT_EQUAL_UINT32(before, micros());
+        hostAdvanceMicros(500);
+    }
+    TEST_ASSERT_FALSE(ring.saving());
+    TEST_ASSERT_EQUAL_UINT16(1, ring.getSaves());
+    TEST_ASSERT_TRUE(save(ring, sample(2)));
+}
+
+void test_reset_before_the_write_finishes_keeps_the_previous_record(void)
+{
+    EepromRing<Sample> ring(RING_ADDR, RING_SIZE, 1);
+    Sample s;
+    ring.load(s);
+    save(ring, sample(1));
+
+    // Reset three bytes into the next record
+    ring.save(sample(2), *writer);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        writer->service();
+        hostAdvanceMicros(4000);
+    }
+    TEST_ASSERT_TRUE(ring.saving());
+
+    EepromRing<Sample> rebooted(RING_ADDR, RING_SIZE, 1);
+    TEST_ASSERT_TRUE(rebooted.load(s));
+    TEST_ASSERT_EQUAL_UINT8(1, s.a);
+}
+
+void test_state_is_kept_until_it_is_queued(void)
+{
+    StateSave state(*writer);
+    state.initialization();
+    SystemStructure changed = state.getState();
+    changed.xVal = 20;
+
+    // Fill the writer: the state is not taken, so the caller retries
+    uint8_t filler[EepromWriter::CAPACITY] = {};
+    TEST_ASSERT_TRUE(writer->write(900, filler, sizeof(filler)));
+    TEST_ASSERT_FALSE(state.updateState(changed));
+    TEST_ASSERT_EQUAL_INT(0, state.getState().xVal);
+
+    finishWrites();
+    TEST_ASSERT_TRUE(state.updateState(changed));
+    TEST_ASSERT_EQUAL_INT(20, state.getState().xVal);
+    finishWrites();
+
+    StateSave rebooted(*writer);
+    TEST_ASSERT_TRUE(rebooted.initialization());
+    TEST_ASSERT_EQUAL_INT(20, rebooted.getState().xVal);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_ring_loads_nothing);
+    RUN_TEST(test_newest_record_survives_a_reset_across_wraps);
+    RUN_TEST(test_torn_write_falls_back_to_the_previous_record);
+    RUN_TEST(test_other_version_is_ignored);
+    RUN_TEST(test_unchanged_value_writes_nothing);
+    RUN_TEST(test_writes_are_spread_over_the_slots);
+    RUN_TEST(test_version_1_state_is_moved_into_the_ring);
+    RUN_TEST(test_invalid_version_1_state_is_erased);
+    RUN_TEST(test_erased_version_1_area_is_not_written);
+    RUN_TEST(test_save_does_not_block);
+    RUN_TEST(test_reset_before_the_write_finishes_keeps_the_previous_record);
+    RUN_TEST(test_state_is_kept_until_it_is_queued);
+    return UNITY_END();
+}
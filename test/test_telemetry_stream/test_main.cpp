@@ -0,0 +1,265 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "serial_frame.h"
+#include "telemetry_stream.h"
+
+// Payload offsets of a TYPE_SAMPLE record, as documented in telemetry_stream.h
+static const uint8_t AT_SEQUENCE = 0;
+static const uint8_t AT_MILLIS = 1;
+static const uint8_t AT_EPOCH = 5;
+static const uint8_t AT_POSE_X = 9;
+static const uint8_t AT_POSE_Y = 11;
+static const uint8_t AT_SETPOINT_X = 13;
+static const uint8_t AT_SETPOINT_Y = 15;
+static const uint8_t AT_LDR = 17;
+static const uint8_t AT_DUTY_X = 29;
+static const uint8_t AT_DUTY_Y = 31;
+static const uint8_t AT_MODE = 33;
+static const uint8_t AT_TASKS = 34;
+
+static FrameReader *reader;
+
+// Feed everything the port sent to the reader; true if exactly one good frame came out
+static bool decodeSent(HardwareSerial &port)
+{
+    uint8_t frames = 0;
+    for (uint16_t i = 0; i < port.txLength; i++)
+    {
+        if (reader->feed(port.tx[i]))
+            frames++;
+    }
+    port.hostClear();
+    return frames == 1;
+}
+
+static uint32_t nextRandom()
+{
+    static uint32_t state = 12345;
+    state = state * 1103515245UL + 12345UL;
+    return state >> 16;
+}
+
+static void busyTask() { hostAdvanceMicros(1500); }
+static void quickTask() { hostAdvanceMicros(200); }
+
+void setUp(void)
+{
+    Serial.hostClear();
+    delete reader;
+    reader = new FrameReader();
+}
+
+void tearDown(void) {}
+
+void test_frames_of_every_length_round_trip(void)
+{
+    FrameWriter frame;
+    uint8_t payload[FrameWriter::MAX_PAYLOAD];
+    const uint8_t MAX = FrameWriter::MAX_PAYLOAD - 2; // type and CRC take the rest
+
+    for (uint16_t round = 0; round < 20; round++)
+    {
+        for (uint8_t length = 0; length <= MAX; length++)
+        {
+            uint8_t type = nextRandom();
+            frame.begin(type);
+            for (uint8_t i = 0; i < length; i++)
+            {
+                // Plenty of zeros and 0xFF runs, the cases COBS has to get right
+                uint8_t r = nextRandom();
+                payload[i] = r < 64 ? 0 : (r < 96 ? 0xFF : nextRandom());
+                frame.put8(payload[i]);
+            }
+            TEST_ASSERT_TRUE(frame.end(Serial));
+
+            // The only zero on the wire is the delimiter at the end
+            TEST_ASSERT_EQUAL_UINT16(length + 4, Serial.txLength);
+            for (uint16_t i = 0; i + 1 < Serial.txLength; i++)
+                TEST_ASSERT_NOT_EQUAL(0, Serial.tx[i]);
+            TEST_ASSERT_EQUAL_HEX8(0, Serial.tx[Serial.txLength - 1]);
+
+            TEST_ASSERT_TRUE(decodeSent(Serial));
+            TEST_ASSERT_EQUAL_HEX8(type, reader->type());
+            TEST_ASSERT_EQUAL_UINT8(length, reader->length());
+            if (length)
+                TEST_ASSERT_EQUAL_HEX8_ARRAY(payload, reader->data(), length);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, reader->getErrors());
+}
+
+void test_fields_round_trip(void)
+{
+    FrameWriter frame;
+    frame.begin(0x42);
+    frame.put8(0);
+    frame.put16(0xBEEF);
+    frame.put32(0xDEADBEEF);
+    frame.putFloat(-1234.5625f);
+    frame.putAngle(-45.678f);
+    frame.putAngle(1000.0f); // saturates
+    TEST_ASSERT_TRUE(frame.end(Serial));
+
+    TEST_ASSERT_TRUE(decodeSent(Serial));
+    TEST_ASSERT_EQUAL_HEX8(0x42, reader->type());
+    TEST_ASSERT_EQUAL_UINT8(15, reader->length());
+    TEST_ASSERT_EQUAL_HEX8(0, reader->get8(0));
+    TEST_ASSERT_EQUAL_HEX16(0xBEEF, reader->get16(1));
+    TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, reader->get32(3));
+    TEST_ASSERT_EQUAL_FLOAT(-1234.5625f, reader->getFloat(7));
+    TEST_ASSERT_EQUAL_INT16(-4568, (int16_t)reader->get16(11));
+    TEST_ASSERT_EQUAL_INT16(32767, (int16_t)reader->get16(13));
+}
+
+void test_overlong_frame_is_not_sent(void)
+{
+    FrameWriter frame;
+    frame.begin(1);
+    for (uint8_t i = 0; i < FrameWriter::MAX_PAYLOAD - 1; i++)
+        frame.put8(i);
+    TEST_ASSERT_FALSE(frame.end(Serial));
+    TEST_ASSERT_EQUAL_UINT16(0, Serial.txLength);
+}
+
+void test_reader_resynchronises_after_garbage_and_corruption(void)
+{
+    FrameWriter frame;
+
+    // Joined mid-frame: the tail of something, then a good frame
+    const uint8_t tail[] = {0x33, 0x07, 0x99, 0x00};
+    for (uint8_t i = 0; i < sizeof(tail); i++)
+        TEST_ASSERT_FALSE(reader->feed(tail[i]));
+    TEST_ASSERT_EQUAL_UINT16(1, reader->getErrors());
+
+    frame.begin(7);
+    frame.put32(0x01020304);
+    frame.end(Serial);
+    TEST_ASSERT_TRUE(decodeSent(Serial));
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, reader->get32(0));
+
+    // A flipped bit fails the CRC; the frame after it is fine
+    frame.begin(7);
+    frame.put32(0x05060708);
+    frame.end(Serial);
+    Serial.tx[3] ^= 0x10;
+    TEST_ASSERT_FALSE(decodeSent(Serial));
+    TEST_ASSERT_EQUAL_UINT16(2, reader->getErrors());
+
+    frame.begin(7);
+    frame.put32(0x090A0B0C);
+    frame.end(Serial);
+    TEST_ASSERT_TRUE(decodeSent(Serial));
+    TEST_ASSERT_EQUAL_HEX32(0x090A0B0C, reader->get32(0));
+}
+
+void test_sample_round_trip(void)
+{
+    TaskMonitor tasks;
+    Task control(20), sensors(100);
+    uint8_t idControl = tasks.add("control");
+    uint8_t idSensors = tasks.add("sensors");
+    tasks.run(idControl, control, quickTask);
+    tasks.run(idSensors, sensors, busyTask);
+
+    TelemetryStream stream(Serial);
+    stream.begin(100);
+    StreamSample s;
+    s.millis = 86400123UL;
+    s.time = 815443200UL;
+    s.poseX = -12.345f;
+    s.poseY = 30.0f;
+    s.setpointX = -12.5f;
+    s.setpointY = 29.99f;
+    const uint16_t ldr[6] = {0, 1023, 512, 256, 0, 700};
+    memcpy(s.ldr, ldr, sizeof(ldr));
+    s.dutyX = -180;
+    s.dutyY = 75;
+    s.mode = 2;    // AppState::MANUAL
+    s.faults = 0x05;
+
+    for (uint8_t sequence = 0; sequence < 3; sequence++)
+    {
+        TEST_ASSERT_TRUE(stream.send(s, tasks));
+        TEST_ASSERT_TRUE(decodeSent(Serial));
+        Serial.hostDrain();
+
+        TEST_ASSERT_EQUAL_HEX8(TelemetryStream::TYPE_SAMPLE, reader->type());
+        TEST_ASSERT_EQUAL_UINT8(AT_TASKS + 1 + 2 * 4, reader->length());
+        TEST_ASSERT_EQUAL_UINT8(sequence, reader->get8(AT_SEQUENCE));
+        TEST_ASSERT_EQUAL_UINT32(86400123UL, reader->get32(AT_MILLIS));
+        TEST_ASSERT_EQUAL_UINT32(815443200UL, reader->get32(AT_EPOCH));
+        TEST_ASSERT_EQUAL_INT16(-1235, (int16_t)reader->get16(AT_POSE_X)); // 0.01° steps
+        TEST_ASSERT_EQUAL_INT16(3000, (int16_t)reader->get16(AT_POSE_Y));
+        TEST_ASSERT_EQUAL_INT16(-1250, (int16_t)reader->get16(AT_SETPOINT_X));
+        TEST_ASSERT_EQUAL_INT16(2999, (int16_t)reader->get16(AT_SETPOINT_Y));
+        for (uint8_t i = 0; i < 6; i++)
+            TEST_ASSERT_EQUAL_UINT16(ldr[i], reader->get16(AT_LDR + 2 * i));
+        TEST_ASSERT_EQUAL_INT16(-180, (int16_t)reader->get16(AT_DUTY_X));
+        TEST_ASSERT_EQUAL_INT16(75, (int16_t)reader->get16(AT_DUTY_Y));
+        TEST_ASSERT_EQUAL_UINT8(2, reader->get8(AT_MODE) >> 6);
+        TEST_ASSERT_EQUAL_HEX8(0x05, reader->get8(AT_MODE) & 0x3F);
+
+        TEST_ASSERT_EQUAL_UINT8(2, reader->get8(AT_TASKS));
+        TEST_ASSERT_EQUAL_UINT16(200, reader->get16(AT_TASKS + 1));  // control avg
+        TEST_ASSERT_EQUAL_UINT16(200, reader->get16(AT_TASKS + 3));  // control max
+        TEST_ASSERT_EQUAL_UINT16(1500, reader->get16(AT_TASKS + 5)); // sensors avg
+        TEST_ASSERT_EQUAL_UINT16(1500, reader->get16(AT_TASKS + 7)); // sensors max
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, stream.getDropped());
+}
+
+void test_full_task_table_fits_one_frame(void)
+{
+    TaskMonitor tasks;
+    Task task(10);
+    static const char *names[TaskMonitor::MAX_TASKS] = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    for (uint8_t i = 0; i < TaskMonitor::MAX_TASKS; i++)
+        tasks.run(tasks.add(names[i]), task, busyTask);
+
+    TelemetryStream stream(Serial);
+    StreamSample s = {};
+    TEST_ASSERT_TRUE(stream.send(s, tasks));
+    TEST_ASSERT_TRUE(decodeSent(Serial));
+    TEST_ASSERT_EQUAL_UINT8(TelemetryStream::MAX_TASKS, reader->get8(AT_TASKS));
+    TEST_ASSERT_EQUAL_UINT8(AT_TASKS + 1 + 4 * TelemetryStream::MAX_TASKS, reader->length());
+}
+
+void test_sample_is_dropped_while_the_port_is_busy(void)
+{
+    TaskMonitor tasks;
+    TelemetryStream stream(Serial);
+    StreamSample s = {};
+
+    TEST_ASSERT_TRUE(stream.send(s, tasks));
+    // The first frame is still in the transmit buffer: the second is dropped, not waited for
+    TEST_ASSERT_FALSE(stream.send(s, tasks));
+    TEST_ASSERT_EQUAL_UINT16(1, stream.getDropped());
+
+    Serial.hostDrain();
+    TEST_ASSERT_TRUE(stream.send(s, tasks));
+
+    // Sequence 0 and 2 on the wire: the gap tells the decoder one frame was lost
+    uint8_t sequences[2];
+    uint8_t frames = 0;
+    for (uint16_t i = 0; i < Serial.txLength; i++)
+    {
+        if (reader->feed(Serial.tx[i]) && frames < 2)
+            sequences[frames++] = reader->get8(AT_SEQUENCE);
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, frames);
+    TEST_ASSERT_EQUAL_UINT8(0, sequences[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, sequences[1]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_of_every_length_round_trip);
+    RUN_TEST(test_fields_round_trip);
+    RUN_TEST(test_overlong_frame_is_not_sent);
+    RUN_TEST(test_reader_resynchronises_after_garbage_and_corruption);
+    RUN_TEST(test_sample_round_trip);
+    RUN_TEST(test_full_task_table_fits_one_frame);
+    RUN_TEST(test_sample_is_dropped_while_the_port_is_busy);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include "tilt.h"
+
+// Degrees between two angles, across the ±180° wrap
+static double angleError(double a, double b)
+{
+    double d = fmod(a - b + 540.0, 360.0) - 180.0;
+    return fabs(d);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_fast_inv_sqrt_relative_error(void)
+{
+    double worst = 0;
+    for (double x = 1e-6; x < 1e9; x *= 1.001)
+    {
+        double exact = 1.0 / sqrt(x);
+        worst = fmax(worst, fabs(fastInvSqrt(x) - exact) / exact);
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(0.002, worst); // ~0.2% as documented
+}
+
+void test_fast_sqrt_relative_error(void)
+{
+    double worst = 0;
+    for (double x = 1e-6; x < 1e9; x *= 1.001)
+    {
+        double exact = sqrt(x);
+        worst = fmax(worst, fabs(fastSqrt(x) - exact) / exact);
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(1e-5, worst);
+    TEST_ASSERT_EQUAL_FLOAT(0, fastSqrt(0));
+    TEST_ASSERT_EQUAL_FLOAT(0, fastSqrt(-1));
+}
+
+void test_fast_atan2_full_circle(void)
+{
+    double worst = 0;
+    for (uint32_t i = 0; i < 360000; i++)
+    {
+        double a = i * (2 * M_PI / 360000);
+        for (double r = 0.001; r < 5e4; r *= 31.6)
+        {
+            float y = r * sin(a), x = r * cos(a);
+            worst = fmax(worst, angleError(fastAtan2Deg(y, x), atan2((double)y, (double)x) * RAD_TO_DEG));
+        }
+    }
+    char line[64];
+    snprintf(line, sizeof(line), "fastAtan2Deg max error %.5f deg", worst);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.001, worst);
+}
+
+void test_fast_atan2_axes_and_origin(void)
+{
+    TEST_ASSERT_EQUAL_FLOAT(0, fastAtan2Deg(0, 0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, fastAtan2Deg(0, 1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 90, fastAtan2Deg(1, 0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 180, fabs(fastAtan2Deg(0, -1)));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, -90, fastAtan2Deg(-1, 0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 45, fastAtan2Deg(3, 3));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, -135, fastAtan2Deg(-3, -3));
+}
+
+// Reference: the double-precision code tiltFromAccel replaced
+static void referenceTilt(double ax, double ay, double az, double &roll, double &pitch)
+{
+    roll = atan2(ay, az) * 180.0 / M_PI;
+    pitch = atan2(-ax, sqrt(ay * ay + az * az)) * 180.0 / M_PI;
+}
+
+void test_tilt_from_raw_full_count_sweep(void)
+{
+    // Every raw reading a 16-bit accelerometer can give on a 1 g sphere of any scale
+    double worstRoll = 0, worstPitch = 0;
+    for (int32_t scale = 2048; scale <= 32767; scale *= 2)
+    {
+        for (int16_t rollDeg = -180; rollDeg < 180; rollDeg += 1)
+        {
+            for (int16_t pitchDeg = -89; pitchDeg <= 89; pitchDeg += 1)
+            {
+                double r = rollDeg * M_PI / 180, p = pitchDeg * M_PI / 180;
+                int16_t ax = lround(-sin(p) * scale);
+                int16_t ay = lround(cos(p) * sin(r) * scale);
+                int16_t az = lround(cos(p) * cos(r) * scale);
+
+                float roll, pitch;
+                double refRoll, refPitch;
+                tiltFromRaw(ax, ay, az, roll, pitch);
+                referenceTilt(ax, ay, az, refRoll, refPitch);
+                worstRoll = fmax(worstRoll, angleError(roll, refRoll));
+                worstPitch = fmax(worstPitch, angleError(pitch, refPitch));
+            }
+        }
+    }
+    char line[80];
+    snprintf(line, sizeof(line), "tiltFromRaw max error roll %.5f deg, pitch %.5f deg", worstRoll, worstPitch);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.001, worstRoll);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.001, worstPitch);
+}
+
+void test_tilt_from_raw_extremes(void)
+{
+    float roll, pitch;
+    tiltFromRaw(-32768, 32767, -32768, roll, pitch); // no overflow in y² + z²
+    double refRoll, refPitch;
+    referenceTilt(-32768, 32767, -32768, refRoll, refPitch);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, refRoll, roll);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, refPitch, pitch);
+
+    tiltFromRaw(0, 0, 0, roll, pitch); // free fall: defined, not NaN
+    TEST_ASSERT_EQUAL_FLOAT(0, roll);
+    TEST_ASSERT_EQUAL_FLOAT(0, pitch);
+}
+
+void test_tilt_from_accel_in_ms2(void)
+{
+    double worst = 0;
+    for (int16_t rollDeg = -180; rollDeg < 180; rollDeg += 3)
+    {
+        for (int16_t pitchDeg = -89; pitchDeg <= 89; pitchDeg += 1)
+        {
+            double r = rollDeg * M_PI / 180, p = pitchDeg * M_PI / 180;
+            float ax = -sin(p) * 9.80665, ay = cos(p) * sin(r) * 9.80665, az = cos(p) * cos(r) * 9.80665;
+            float roll, pitch;
+            double refRoll, refPitch;
+            tiltFromAccel(ax, ay, az, roll, pitch);
+            referenceTilt(ax, ay, az, refRoll, refPitch);
+            worst = fmax(worst, fmax(angleError(roll, refRoll), angleError(pitch, refPitch)));
+        }
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(0.001, worst);
+}
+
+static double nowNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void test_benchmark_against_libm(void)
+{
+    const uint32_t N = 1000000;
+    static int16_t samples[256][3];
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        samples[i][0] = lround(8000 * sin(i * 0.05));
+        samples[i][1] = lround(8000 * cos(i * 0.07));
+        samples[i][2] = lround(16000 * cos(i * 0.03));
+    }
+
+    volatile float sink = 0;
+    float roll, pitch;
+    double start = nowNanos();
+    for (uint32_t i = 0; i < N; i++)
+    {
+        const int16_t *s = samples[i & 255];
+        tiltFromRaw(s[0], s[1], s[2], roll, pitch);
+        sink = sink + roll + pitch;
+    }
+    double fast = (nowNanos() - start) / N;
+
+    start = nowNanos();
+    for (uint32_t i = 0; i < N; i++)
+    {
+        const int16_t *s = samples[i & 255];
+        double r, p;
+        referenceTilt(s[0], s[1], s[2], r, p);
+        sink = sink + r + p;
+    }
+    double reference = (nowNanos() - start) / N;
+
+    // On the host libm has hardware help; on the AVR the soft-float double path is
+    // what tiltFromRaw saves on every MPU sample
+    char line[96];
+    snprintf(line, sizeof(line), "tilt per sample on this host: %.1f ns fast, %.1f ns libm double", fast, reference);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE(isfinite(sink));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_inv_sqrt_relative_error);
+    RUN_TEST(test_fast_sqrt_relative_error);
+    RUN_TEST(test_fast_atan2_full_circle);
+    RUN_TEST(test_fast_atan2_axes_and_origin);
+    RUN_TEST(test_tilt_from_raw_full_count_sweep);
+    RUN_TEST(test_tilt_from_raw_extremes);
+    RUN_TEST(test_tilt_from_accel_in_ms2);
+    RUN_TEST(test_benchmark_against_libm);
+    return UNITY_END();
+}
@@ -0,0 +1,115 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <new>
+#include "line_format.h"
+#include "user_interface.h"
+
+// Every heap allocation in this program is counted. On the Nano each String the UI
+// built was a malloc/free pair on a 2 KB heap shared with the stack; redraws must
+// not make any.
+static uint32_t allocations = 0;
+
+#ifdef __GLIBC__
+// C allocations as well, e.g. from a library String
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *p, size_t size);
+extern "C" void *malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+extern "C" void *calloc(size_t count, size_t size)
+{
+    allocations++;
+    return __libc_calloc(count, size);
+}
+extern "C" void *realloc(void *p, size_t size)
+{
+    allocations++;
+    return __libc_realloc(p, size);
+}
+static const bool COUNTS_MALLOC = true;
+#else
+static const bool COUNTS_MALLOC = false;
+#endif
+
+void *operator new(size_t size)
+{
+    if (!COUNTS_MALLOC) // otherwise malloc below counts it
+        allocations++;
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static I2CBus bus;
+static UserInterface *ui;
+
+void setUp(void)
+{
+    static UserInterface instance(bus);
+    ui = &instance;
+    ui->init();
+}
+
+void tearDown(void) {}
+
+void test_counter_sees_allocations(void)
+{
+    uint32_t before = allocations;
+    int *p = new int(3);
+    delete p;
+    void *q = malloc(16);
+    free(q);
+    TEST_ASSERT_EQUAL_UINT32(before + (COUNTS_MALLOC ? 2 : 1), allocations);
+}
+
+void test_line_format_does_not_allocate(void)
+{
+    char line[LcdFramebuffer::COLS + 1];
+    uint32_t before = allocations;
+    for (int i = -500; i < 500; i++)
+        LineFormat(line, sizeof(line)).character('>').text("X:").integer(i).fixed(i * 0.37f).text("*");
+    TEST_ASSERT_EQUAL_UINT32(before, allocations);
+}
+
+void test_redraw_of_every_screen_does_not_allocate(void)
+{
+    timeObject now = {30, 15, 9, 20, 8, 25};
+    uint32_t before = allocations;
+    for (uint8_t frame = 0; frame < 100; frame++)
+    {
+        float x = -45.0f + frame * 0.9f;
+        float y = 30.0f - frame * 0.6f;
+        ui->showAutomatic(frame * 2, x, y, frame % 2 ? ModeSelection::MANUAL : ModeSelection::AUTOMATIC_SINGLE_AXIS);
+        ui->flush();
+        ui->showManual(frame, 255 - frame, 10, 20, frame - 50, 50 - frame, x, y,
+                       static_cast<ManualSelection>(frame % 3), frame % 5 == 0);
+        ui->flush(8);
+        ui->flush();
+        ui->showAutomaticSingleAxis(x, y, frame % 4 == 0, static_cast<AutomaticSingleAxisSelection>(frame % 3));
+        ui->flush();
+        now.second = frame % 60;
+        ui->showDebugLDR(frame, frame + 1, frame + 2, frame + 3, now, frame % 2);
+        ui->flush();
+        ui->setBacklight(frame % 2);
+    }
+    TEST_ASSERT_EQUAL_UINT32(before, allocations);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_sees_allocations);
+    RUN_TEST(test_line_format_does_not_allocate);
+    RUN_TEST(test_redraw_of_every_screen_does_not_allocate);
+    return UNITY_END();
+}
@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "print_buffer.h"
+#include "user_interface.h"
+
+// Snapshots of every screen as the 20x4 LCD shows it, one '|'-framed line per row.
+// A change to a screen layout has to change its snapshot here too.
+
+static I2CBus bus;
+static UserInterface *ui;
+static PrintBuffer screen;
+
+// Flush the frame to the emulator and compare what it shows with the snapshot
+static void assertScreen(const char *expected)
+{
+    while (ui->getPendingChars())
+        ui->flush();
+    screen.clear();
+    ui->getDevice().dump(screen);
+    if (strcmp(expected, screen.text) != 0)
+    {
+        TEST_MESSAGE(screen.text);
+        TEST_FAIL_MESSAGE("screen differs from its snapshot");
+    }
+}
+
+void setUp(void)
+{
+    delete ui;
+    ui = new UserInterface(bus);
+    ui->init();
+}
+
+void tearDown(void) {}
+
+void test_automatic(void)
+{
+    ui->showAutomatic(182, 12.5f, -3.25f, ModeSelection::MANUAL);
+    assertScreen("|Mode: AUTO          |\r\n"
+                 "|Sun:182             |\r\n"
+                 "|X:12.50   Y:-3.25   |\r\n"
+                 "|>MANUAL   AUTO-1    |\r\n");
+
+    ui->showAutomatic(7, -45.0f, 0.0f, ModeSelection::AUTOMATIC_SINGLE_AXIS);
+    assertScreen("|Mode: AUTO          |\r\n"
+                 "|Sun:7               |\r\n"
+                 "|X:-45.00  Y:0.00    |\r\n"
+                 "| MANUAL  >AUTO-1    |\r\n");
+}
+
+void test_manual(void)
+{
+    ui->showManual(10, 20, 30, 40, 15, -7, 14.75f, -2.5f, ManualSelection::X, false);
+    assertScreen("|Mode: MANUAL        |\r\n"
+                 "|>X:15   X=14.75     |\r\n"
+                 "| Y:-7   Y=-2.50     |\r\n"
+                 "| Back               |\r\n");
+
+    ui->showManual(10, 20, 30, 40, 15, -7, 14.75f, -2.5f, ManualSelection::Y, true);
+    assertScreen("|Mode: MANUAL        |\r\n"
+                 "| X:15   X=14.75     |\r\n"
+                 "|>Y:-7*  Y=-2.50     |\r\n"
+                 "| Back               |\r\n");
+
+    ui->showManual(10, 20, 30, 40, 15, -7, 14.75f, -2.5f, ManualSelection::BACK, false);
+    assertScreen("|Mode: MANUAL        |\r\n"
+                 "| X:15   X=14.75     |\r\n"
+                 "| Y:-7   Y=-2.50     |\r\n"
+                 "|>Back               |\r\n");
+}
+
+void test_automatic_single_axis(void)
+{
+    ui->showAutomaticSingleAxis(33.1f, -0.25f, false, AutomaticSingleAxisSelection::X);
+    assertScreen("|Mode: AUTO 1 Axis   |\r\n"
+                 "|>X:33.10            |\r\n"
+                 "| Y:-0.25            |\r\n"
+                 "| Back               |\r\n");
+
+    ui->showAutomaticSingleAxis(33.1f, -0.25f, true, AutomaticSingleAxisSelection::Y);
+    assertScreen("|Mode: AUTO 1 Axis   |\r\n"
+                 "| X:33.10            |\r\n"
+                 "|>Y:-0.25*           |\r\n"
+                 "| Back               |\r\n");
+}
+
+void test_debug_ldr(void)
+{
+    timeObject now = {5, 30, 14, 20, 8, 25};
+    ui->showDebugLDR(101, 202, 33, 4, now, true);
+    assertScreen("|14:30:5 20/8/25    *|\r\n"
+                 "|                    |\r\n"
+                 "|West:101  South:202 |\r\n"
+                 "|East:33   North:4   |\r\n");
+
+    ui->showDebugLDR(101, 202, 33, 4, now, false);
+    assertScreen("|14:30:5 20/8/25     |\r\n"
+                 "|                    |\r\n"
+                 "|West:101  South:202 |\r\n"
+                 "|East:33   North:4   |\r\n");
+}
+
+void test_switching_screens_leaves_nothing_behind(void)
+{
+    timeObject now = {59, 59, 23, 31, 12, 99};
+    ui->showDebugLDR(255, 255, 255, 255, now, true);
+    assertScreen("|23:59:59 31/12/99  *|\r\n"
+                 "|                    |\r\n"
+                 "|West:255  South:255 |\r\n"
+                 "|East:255  North:255 |\r\n");
+
+    ui->showAutomaticSingleAxis(1.0f, 2.0f, false, AutomaticSingleAxisSelection::BACK);
+    assertScreen("|Mode: AUTO 1 Axis   |\r\n"
+                 "| X:1.00             |\r\n"
+                 "| Y:2.00             |\r\n"
+                 "|>Back               |\r\n");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_automatic);
+    RUN_TEST(test_manual);
+    RUN_TEST(test_automatic_single_axis);
+    RUN_TEST(test_debug_ldr);
+    RUN_TEST(test_switching_screens_leaves_nothing_behind);
+    return UNITY_END();
+}
@@ -0,0 +1,190 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "user_input.h"
+
+// PB3 CLK, PB4 DT, PB5 SW, all pulled up: a pressed button reads 0
+static const uint8_t CLK = _BV(3);
+static const uint8_t DT = _BV(4);
+static const uint8_t SW = _BV(5);
+
+static UserInput *input;
+
+// Change the port and run the pin change vector, as the hardware would
+static void setPins(uint8_t pins)
+{
+    PINB = pins;
+    PCINT0_vect();
+}
+
+static void setButton(bool down)
+{
+    setPins(down ? (PINB & ~SW) : (PINB | SW));
+}
+
+// One detent clockwise: two quarter steps, one ring entry
+static void detent()
+{
+    uint8_t pins = PINB;
+    if ((pins & (CLK | DT)) == (CLK | DT))
+    {
+        setPins(pins & ~DT);
+        setPins(pins & ~(CLK | DT));
+    }
+    else
+    {
+        setPins(pins | DT);
+        setPins(pins | CLK | DT);
+    }
+    hostAdvanceMillis(5);
+}
+
+// Run update() every ms for a while and keep the button events
+static uint8_t collect(uint16_t ms, InputEventType *types, uint8_t capacity)
+{
+    uint8_t count = 0;
+    for (uint16_t i = 0; i < ms; i++)
+    {
+        input->update();
+        InputEvent e;
+        while (input->poll(e))
+        {
+            if (e.type != InputEventType::ROTATE && count < capacity)
+                types[count++] = e.type;
+        }
+        hostAdvanceMillis(1);
+    }
+    return count;
+}
+
+void setUp(void)
+{
+    PINB = CLK | DT | SW;
+    delete input;
+    input = new UserInput();
+    input->init();
+}
+
+void tearDown(void) {}
+
+void test_press_and_release(void)
+{
+    InputEventType types[8];
+    setButton(true);
+    TEST_ASSERT_EQUAL_UINT8(1, collect(100, types, 8));
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::PRESS, types[0]);
+    setButton(false);
+    TEST_ASSERT_EQUAL_UINT8(1, collect(100, types, 8));
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::RELEASE, types[0]);
+}
+
+void test_press_lost_to_a_full_ring_is_recovered(void)
+{
+    // loop() blocked while the knob turns and fills the ring, then the button goes down
+    for (uint8_t i = 0; i < 15; i++)
+        detent();
+    setButton(true);
+    TEST_ASSERT_GREATER_THAN_UINT8(0, input->getOverflows());
+
+    InputEventType types[8];
+    TEST_ASSERT_EQUAL_UINT8(1, collect(100, types, 8));
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::PRESS, types[0]);
+    TEST_ASSERT_FALSE(input->hasPendingEdges());
+}
+
+void test_release_lost_to_a_full_ring_is_recovered(void)
+{
+    InputEventType types[8];
+    setButton(true);
+    collect(100, types, 8);
+
+    for (uint8_t i = 0; i < 15; i++)
+        detent();
+    setButton(false);
+
+    // Without the pin read back the button would stay down and turn into a LONG_PRESS
+    TEST_ASSERT_EQUAL_UINT8(2, collect(1000, types, 8));
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::RELEASE, types[0]);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::CLICK, types[1]);
+}
+
+static void click(uint16_t holdMs)
+{
+    setButton(true);
+    hostAdvanceMillis(holdMs);
+    setButton(false);
+}
+
+void test_click_waits_out_the_double_click_window(void)
+{
+    InputEventType types[8];
+    click(80);
+    TEST_ASSERT_EQUAL_UINT8(2, collect(340, types, 8)); // PRESS, RELEASE
+    TEST_ASSERT_EQUAL_UINT8(1, collect(20, types, 8));
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::CLICK, types[0]);
+}
+
+void test_double_click_sends_no_click(void)
+{
+    InputEventType types[8];
+    click(80);
+    collect(200, types, 8);
+    click(80);
+    uint8_t count = collect(1000, types, 8);
+    TEST_ASSERT_EQUAL_UINT8(3, count);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::PRESS, types[0]);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::DOUBLE_CLICK, types[1]);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::RELEASE, types[2]);
+}
+
+void test_slow_clicks_are_two_clicks(void)
+{
+    InputEventType types[8];
+    click(80);
+    uint8_t count = collect(400, types, 8);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::CLICK, types[count - 1]);
+    click(80);
+    count = collect(400, types, 8);
+    TEST_ASSERT_EQUAL_UINT8(3, count);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::CLICK, types[2]);
+}
+
+void test_click_during_a_blocked_loop(void)
+{
+    // Both clicks happen while loop() is stuck; the edges carry their own times
+    InputEventType types[8];
+    click(80);
+    hostAdvanceMillis(500);
+    click(80);
+    hostAdvanceMillis(50);
+    uint8_t count = collect(400, types, 8);
+    TEST_ASSERT_EQUAL_UINT8(6, count);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::RELEASE, types[1]);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::CLICK, types[2]);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::PRESS, types[3]);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::CLICK, types[5]);
+}
+
+void test_long_press_sends_no_click(void)
+{
+    InputEventType types[8];
+    setButton(true);
+    collect(900, types, 8);
+    setButton(false);
+    uint8_t count = collect(1000, types, 8);
+    TEST_ASSERT_EQUAL_UINT8(1, count);
+    TEST_ASSERT_EQUAL_UINT8(InputEventType::RELEASE, types[0]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_press_and_release);
+    RUN_TEST(test_press_lost_to_a_full_ring_is_recovered);
+    RUN_TEST(test_release_lost_to_a_full_ring_is_recovered);
+    RUN_TEST(test_click_waits_out_the_double_click_window);
+    RUN_TEST(test_double_click_sends_no_click);
+    RUN_TEST(test_slow_clicks_are_two_clicks);
+    RUN_TEST(test_click_during_a_blocked_loop);
+    RUN_TEST(test_long_press_sends_no_click);
+    return UNITY_END();
+}
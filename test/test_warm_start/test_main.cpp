@@ -0,0 +1,146 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "control_system.h"
+#include "sensor_ldr.h"
+#include "warm_start.h"
+
+// The firmware's rates (src/main.cpp)
+static const uint8_t IMU_SAMPLE_HZ = 10;
+static const uint8_t SENS_INTERVAL = 100;
+static const uint8_t CONTROL_INTERVAL = 20;
+
+// Plant: a linear actuator per axis at SLEW deg/s on full PWM, and an IMU whose first
+// sample comes IMU_START_MS after boot (sensor power-up, or the bus still recovering)
+static const float SLEW = 2.0f;
+static const uint16_t IMU_START_MS = 300;
+
+// A watchdog reset while holding on the sun: the saved pose is where the frame stands
+static const float SUN_X = 30.0f;
+static const float SUN_Y = 10.0f;
+static const float POSE_X = 30.05f;
+static const float POSE_Y = 10.02f;
+
+static I2CBus bus;
+
+struct Boot
+{
+    uint32_t trackMs; // boot until both axes are within deadZone, as bootToTrackMillis
+    int16_t peakDuty; // largest PWM commanded on the way
+};
+
+// setup()'s restoreState() and the sensor and control tasks against the simulated frame
+static Boot boot(bool restored)
+{
+    SimulatedIMU imu;
+    MadgwickIMU fusion;
+    LowPassFilter roll, pitch;
+    ControlSystem control;
+    driverX.stop();
+    driverY.stop();
+
+    float poseX = POSE_X, poseY = POSE_Y;
+    imu.setAngles(poseX, poseY);
+    fusion.begin(IMU_SAMPLE_HZ);
+    seedPose(imu, fusion, roll, pitch, restored, POSE_X, POSE_Y);
+    float angleMain = roll.value();
+    float angleSecond = pitch.value();
+
+    Boot result = {0xFFFFFFFF, 0};
+    for (uint32_t t = 0; t < 60000; t++)
+    {
+        if (t == IMU_START_MS)
+            imu.begin();
+        if (fusion.due())
+            imu.requestUpdate(bus);
+        if (imu.consumeFresh())
+            fusion.update(imu.getModelIMU());
+
+        if (t % SENS_INTERVAL == 0 && fusion.isSeeded())
+        {
+            angleMain = roll.reading(fusion.getRoll());
+            angleSecond = pitch.reading(fusion.getPitch());
+        }
+        if (t % CONTROL_INTERVAL == 0)
+        {
+            if (fabs(SUN_X - angleMain) <= control.getTuning().deadZone &&
+                fabs(SUN_Y - angleSecond) <= control.getTuning().deadZone)
+            {
+                result.trackMs = t;
+                break;
+            }
+            control.runManual(SUN_X, SUN_Y, angleMain, angleSecond);
+            result.peakDuty = max(result.peakDuty, (int16_t)max(abs(driverX.getDuty()), abs(driverY.getDuty())));
+        }
+
+        poseX += driverX.getDuty() / 255.0f * SLEW / 1000;
+        poseY += driverY.getDuty() / 255.0f * SLEW / 1000;
+        imu.setAngles(poseX, poseY);
+        hostAdvanceMillis(1);
+    }
+    return result;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_warm_start_tracks_sooner_than_a_cold_start(void)
+{
+    Boot cold = boot(false);
+    Boot warm = boot(true);
+
+    TEST_ASSERT_NOT_EQUAL(0xFFFFFFFF, cold.trackMs);
+    // On the sun from the first control pass, and the motors never ran
+    TEST_ASSERT_LESS_THAN_UINT32(1000, warm.trackMs);
+    TEST_ASSERT_LESS_THAN_UINT32(cold.trackMs, warm.trackMs);
+    TEST_ASSERT_EQUAL_INT16(0, warm.peakDuty);
+    // The cold start drives blind from 0 until the IMU is up, then comes back
+    TEST_ASSERT_GREATER_THAN_INT16(0, cold.peakDuty);
+
+    char line[120];
+    snprintf(line, sizeof(line), "boot to tracking: cold %lu ms (peak PWM %d), warm %lu ms (peak PWM %d)",
+             (unsigned long)cold.trackMs, cold.peakDuty, (unsigned long)warm.trackMs, warm.peakDuty);
+    TEST_MESSAGE(line);
+}
+
+void test_imu_sample_at_boot_wins_over_the_saved_pose(void)
+{
+    SimulatedIMU imu;
+    MadgwickIMU fusion;
+    LowPassFilter roll, pitch;
+    imu.begin();
+    imu.setAngles(-20, 5);
+    fusion.begin(IMU_SAMPLE_HZ);
+
+    // The frame was moved by hand while off: the saved pose is stale
+    seedPose(imu, fusion, roll, pitch, true, POSE_X, POSE_Y);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -20, roll.value());
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 5, pitch.value());
+}
+
+void test_ldr_filters_start_from_the_first_read(void)
+{
+    byte pins[6] = {A0, A1, A2, A3, A6, A7};
+    SensorLDR ldr(pins);
+    LowPassFilter lp[4];
+    ldr.begin();
+    hostPins().analog[A0] = 180;
+    hostPins().analog[A1] = 175;
+    hostPins().analog[A2] = 90;
+    hostPins().analog[A3] = 60;
+
+    seedLdr(ldr, lp, 4);
+    TEST_ASSERT_EQUAL_FLOAT(180, lp[0].value());
+    TEST_ASSERT_EQUAL_FLOAT(60, lp[3].value());
+    // No settling from 0: the next reading of the same light leaves it there
+    TEST_ASSERT_EQUAL_FLOAT(175, lp[1].reading(175));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_warm_start_tracks_sooner_than_a_cold_start);
+    RUN_TEST(test_imu_sample_at_boot_wins_over_the_saved_pose);
+    RUN_TEST(test_ldr_filters_start_from_the_first_read);
+    return UNITY_END();
+}
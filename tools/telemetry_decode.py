@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Decode the EEPROM telemetry ring written by include/telemetry_log.h.
+
+Input is either the hex text printed by TelemetryLog::dump() (captured from the
+serial monitor) or a raw binary image of the ring region. Output is CSV on stdout,
+oldest record first.
+
+    python tools/telemetry_decode.py capture.txt > overnight.csv
+"""
+
+import argparse
+import datetime
+import re
+import sys
+
+RECORD_SIZE = 8
+TIME_UNIT = 4  # s per SAMPLE time step
+SEQUENCE_MODULO = 127
+NO_HEADER = 0xFF
+EPOCH_2000 = datetime.datetime(2000, 1, 1, tzinfo=datetime.timezone.utc)
+
+MODES = {0: "AUTOMATIC", 1: "AUTOMATIC_1_AXIS", 2: "MANUAL"}
+FAULTS = {0x01: "IMU", 0x02: "I2C", 0x04: "OVERRUN"}
+TASKS = {0: "control", 1: "input", 2: "sensors", 3: "ui", 4: "state", 0x7F: "loop"}  # TaskWatchdog ids
+
+
+def read_ring(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    text = data.decode("ascii", errors="ignore")
+    tokens = re.findall(r"\b[0-9A-Fa-f]{2}\b", text)
+    # A dump is nothing but two-digit hex tokens; anything else is a binary image
+    if tokens and len(tokens) * 3 >= len(text.strip()):
+        return bytes(int(t, 16) for t in tokens)
+    return data
+
+
+def ordered_records(ring):
+    slots = [ring[i:i + RECORD_SIZE] for i in range(0, len(ring) - RECORD_SIZE + 1, RECORD_SIZE)]
+
+    # Same search as TelemetryLog::begin(): the newest record ends the run of
+    # consecutive sequence numbers
+    newest, newest_seq = None, None
+    for i, rec in enumerate(slots):
+        if rec[0] == NO_HEADER:
+            continue
+        seq = rec[0] & 0x7F
+        if newest is None or seq == (newest_seq + 1) % SEQUENCE_MODULO:
+            newest, newest_seq = i, seq
+    if newest is None:
+        return []
+
+    # Walk back from the newest while the sequence keeps counting down
+    out = [slots[newest]]
+    seq = newest_seq
+    i = newest
+    for _ in range(len(slots) - 1):
+        i = (i - 1) % len(slots)
+        rec = slots[i]
+        if rec[0] == NO_HEADER or rec[0] & 0x7F != (seq - 1) % SEQUENCE_MODULO:
+            break
+        out.append(rec)
+        seq = rec[0] & 0x7F
+    out.reverse()
+    return out
+
+
+def signed(b):
+    return b - 256 if b > 127 else b
+
+
+def decode(records, tz_minutes):
+    tz = datetime.timezone(datetime.timedelta(minutes=tz_minutes))
+    t = None
+    rows = []
+    for rec in records:
+        mode_faults = rec[7] if not rec[0] & 0x80 else rec[5]
+        mode = MODES.get(mode_faults >> 6, str(mode_faults >> 6))
+        faults = "|".join(name for bit, name in FAULTS.items() if mode_faults & bit)
+
+        if rec[0] & 0x80:
+            t = int.from_bytes(rec[1:5], "little")
+            note = "boot" if rec[6] == 1 else ""
+            if rec[6] == 1 and rec[7] & 0x80:
+                task = rec[7] & 0x7F
+                note += " after watchdog reset in " + TASKS.get(task, "task %d" % task)
+            rows.append(["KEY", stamp(t, tz), "", "", "", "", "", mode, faults, note])
+            continue
+
+        if t is not None:
+            t += rec[1] * TIME_UNIT
+        rows.append(["SAMPLE", stamp(t, tz),
+                     signed(rec[2]) / 2, signed(rec[3]) / 2,
+                     signed(rec[4]) / 2, signed(rec[5]) / 2,
+                     rec[6], mode, faults, ""])
+    return rows
+
+
+def stamp(t, tz):
+    if t is None:
+        return ""  # samples before the oldest surviving KEY have no absolute time
+    return (EPOCH_2000 + datetime.timedelta(seconds=t)).astimezone(tz).isoformat()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="dump() text capture or binary ring image")
+    parser.add_argument("--tz", type=int, default=7 * 60, help="local offset in minutes for timestamps (default WIB)")
+    args = parser.parse_args()
+
+    rows = decode(ordered_records(read_ring(args.input)), args.tz)
+    print("type,time,pose_x,pose_y,setpoint_x,setpoint_y,ldr,mode,faults,note")
+    for row in rows:
+        print(",".join(str(v) for v in row))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""Decode the binary serial telemetry written by include/telemetry_stream.h.
+
+Input is a raw capture of the serial port (a file, or a port read live with
+pyserial). Frames are COBS encoded and end in 0x00; frames that fail the CRC or
+do not parse are counted and skipped. Output is one row per sample, as CSV, or
+as Parquet when the output name ends in .parquet and pyarrow is installed.
+
+    python tools/telemetry_stream.py capture.bin -o run.csv
+    python tools/telemetry_stream.py --port /dev/ttyUSB0 -o run.parquet
+"""
+
+import argparse
+import csv
+import datetime
+import struct
+import sys
+
+TYPE_SAMPLE = 0x01
+EPOCH_2000 = datetime.datetime(2000, 1, 1, tzinfo=datetime.timezone.utc)
+
+MODES = {0: "AUTOMATIC", 1: "AUTOMATIC_1_AXIS", 2: "MANUAL"}
+FAULTS = {0x01: "IMU", 0x02: "I2C", 0x04: "OVERRUN"}
+# Registration order in setup(); frames carry timings only, not names
+TASKS = ["control", "input", "sensors", "ui", "state", "task5"]
+
+SAMPLE_HEAD = struct.Struct("<BII4h6H2hBB")
+
+
+def crc8(data):
+    """CRC-8/MAXIM, same as include/crc8.h."""
+    crc = 0
+    for b in data:
+        for _ in range(8):
+            mix = (crc ^ b) & 0x01
+            crc >>= 1
+            if mix:
+                crc ^= 0x8C
+            b >>= 1
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def frames(chunks):
+    """Yield the raw COBS frames between delimiters, across chunk boundaries."""
+    pending = bytearray()
+    for chunk in chunks:
+        pending += chunk
+        while True:
+            end = pending.find(0)
+            if end < 0:
+                break
+            if end:
+                yield bytes(pending[:end])
+            del pending[:end + 1]
+
+
+def parse_sample(body, columns):
+    fields = SAMPLE_HEAD.unpack_from(body)
+    seq, ms, epoch = fields[0:3]
+    angles = [v / 100 for v in fields[3:7]]
+    ldr = fields[7:13]
+    duty = fields[13:15]
+    mode_faults, count = fields[15:17]
+
+    row = {
+        "seq": seq,
+        "millis": ms,
+        "time": (EPOCH_2000 + datetime.timedelta(seconds=epoch)).isoformat(),
+        "pose_x": angles[0],
+        "pose_y": angles[1],
+        "setpoint_x": angles[2],
+        "setpoint_y": angles[3],
+    }
+    for i, v in enumerate(ldr):
+        row["ldr%d" % i] = v
+    row["duty_x"], row["duty_y"] = duty
+    row["mode"] = MODES.get(mode_faults >> 6, str(mode_faults >> 6))
+    row["faults"] = "|".join(name for bit, name in FAULTS.items() if mode_faults & bit)
+
+    offset = SAMPLE_HEAD.size
+    if len(body) != offset + 4 * count:
+        raise ValueError("task count does not match frame length")
+    for i in range(count):
+        avg, peak = struct.unpack_from("<HH", body, offset + 4 * i)
+        name = TASKS[i] if i < len(TASKS) else "task%d" % i
+        row[name + "_avg_us"] = avg
+        row[name + "_max_us"] = peak
+    for key in row:
+        if key not in columns:
+            columns.append(key)
+    return row
+
+
+def decode(chunks, stats):
+    columns = []
+    rows = []
+    last_seq = None
+    for raw in frames(chunks):
+        data = cobs_decode(raw)
+        if data is None or len(data) < 2 or crc8(data[:-1]) != data[-1]:
+            stats["bad"] += 1
+            continue
+        if data[0] != TYPE_SAMPLE:
+            stats["other"] += 1
+            continue
+        try:
+            row = parse_sample(data[1:-1], columns)
+        except (struct.error, ValueError):
+            stats["bad"] += 1
+            continue
+        if last_seq is not None:
+            stats["lost"] += (row["seq"] - last_seq - 1) % 256
+        last_seq = row["seq"]
+        rows.append(row)
+    return columns, rows
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        while True:
+            chunk = f.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def read_port(port, baud, seconds):
+    import serial  # pyserial, only needed for live capture
+    import time
+    deadline = time.monotonic() + seconds if seconds else None
+    with serial.Serial(port, baud, timeout=0.5) as s:
+        try:
+            while deadline is None or time.monotonic() < deadline:
+                yield s.read(256)
+        except KeyboardInterrupt:
+            return
+
+
+def write_csv(out, columns, rows):
+    writer = csv.DictWriter(out, fieldnames=columns)
+    writer.writeheader()
+    writer.writerows(rows)
+
+
+def write_parquet(path, columns, rows):
+    import pyarrow as pa
+    import pyarrow.parquet as pq
+    table = pa.table({c: [r.get(c) for r in rows] for c in columns})
+    pq.write_table(table, path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", help="raw serial capture")
+    parser.add_argument("--port", help="read live from this serial port instead (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--seconds", type=float, default=0, help="stop a live capture after this long (default: Ctrl-C)")
+    parser.add_argument("-o", "--output", help=".csv or .parquet file (default: CSV on stdout)")
+    args = parser.parse_args()
+
+    if bool(args.input) == bool(args.port):
+        parser.error("give either a capture file or --port")
+    chunks = read_port(args.port, args.baud, args.seconds) if args.port else read_file(args.input)
+
+    stats = {"bad": 0, "other": 0, "lost": 0}
+    columns, rows = decode(chunks, stats)
+
+    if args.output and args.output.endswith(".parquet"):
+        try:
+            write_parquet(args.output, columns, rows)
+        except ImportError:
+            print("pyarrow is not installed, write a .csv instead", file=sys.stderr)
+            return 1
+    elif args.output:
+        with open(args.output, "w", newline="") as f:
+            write_csv(f, columns, rows)
+    else:
+        write_csv(sys.stdout, columns, rows)
+
+    print("%d samples, %d lost, %d bad frames, %d other frames" %
+          (len(rows), stats["lost"], stats["bad"], stats["other"]), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
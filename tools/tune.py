@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""Read and write the tracker's control tuning over serial (include/serial_commands.h).
+
+Needs a build with -D SERIAL_COMMANDS and pyserial on the host. Parameters are
+addressed by name; the table is read from the device, so new parameters need no
+change here. SET changes RAM only; run save to keep the values across resets.
+
+    python tools/tune.py --port /dev/ttyUSB0 list
+    python tools/tune.py --port /dev/ttyUSB0 set kp_x 24
+    python tools/tune.py --port /dev/ttyUSB0 save
+    python tools/tune.py --port /dev/ttyUSB0 calibrate 0 0 30 -20
+
+calibrate walks through the two-orientation IMU calibration: hold the tracker at
+the first pose (roll, pitch in degrees, e.g. from an inclinometer), press Enter,
+wait, then the same for the second pose. The scale and offset solved from the two
+are saved to EEPROM. Switch the tracker to manual first so it holds still.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+from telemetry_stream import cobs_decode, crc8
+
+CMD_DESCRIBE = 0x10
+CMD_GET = 0x11
+CMD_SET = 0x12
+CMD_SAVE = 0x13
+CMD_DEFAULTS = 0x14
+CMD_PROFILE = 0x15
+CMD_CALIBRATE = 0x16
+CALIBRATE_STATUS = 2
+CALIBRATE_SOLVE = 3
+CAPTURING = 0x80
+REPLY = 0x80
+REPLY_ERROR = 0x7F
+ERRORS = {1: "unknown command", 2: "no such parameter", 3: "bad value", 4: "busy, try again"}
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_at = 0
+    for b in data:
+        if b == 0:
+            out[code_at] = len(out) - code_at
+            code_at = len(out)
+            out.append(0)
+        else:
+            out.append(b)
+    out[code_at] = len(out) - code_at
+    out.append(0)
+    return bytes(out)
+
+
+class DeviceError(Exception):
+    pass
+
+
+class Link:
+    """Request/reply over any port with read(n) and write(bytes)."""
+
+    def __init__(self, port, timeout=0.5, retries=3):
+        self.port = port
+        self.timeout = timeout
+        self.retries = retries
+        self.pending = bytearray()
+
+    def send(self, kind, payload=b""):
+        frame = bytes([kind]) + payload
+        self.port.write(cobs_encode(frame + bytes([crc8(frame)])))
+
+    def receive(self, deadline):
+        """Next good frame as (type, payload), or None at the deadline."""
+        while time.monotonic() < deadline:
+            end = self.pending.find(0)
+            if end < 0:
+                self.pending += self.port.read(64)
+                continue
+            raw = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            data = cobs_decode(raw) if raw else None
+            if data and len(data) >= 2 and crc8(data[:-1]) == data[-1]:
+                return data[0], data[1:-1]
+        return None
+
+    def request(self, kind, payload=b""):
+        # Telemetry frames may be interleaved, and a reply is dropped when the
+        # device's transmit buffer is full, so wait for ours and retry
+        for _ in range(self.retries):
+            self.send(kind, payload)
+            deadline = time.monotonic() + self.timeout
+            while True:
+                frame = self.receive(deadline)
+                if frame is None:
+                    break
+                reply, body = frame
+                if reply == REPLY_ERROR and body[:1] == bytes([kind]):
+                    raise DeviceError(ERRORS.get(body[1], "error %d" % body[1]))
+                if reply == REPLY | kind or (kind == CMD_SET and reply == REPLY | CMD_GET):
+                    return body
+        raise DeviceError("no reply")
+
+
+def describe(link, pid):
+    body = link.request(CMD_DESCRIBE, bytes([pid]))
+    pid, count, value, lo, hi = struct.unpack_from("<BBfff", body)
+    return {"id": pid, "count": count, "value": value, "min": lo, "max": hi,
+            "name": body[14:].decode("ascii")}
+
+
+def table(link):
+    first = describe(link, 0)
+    params = [first] + [describe(link, i) for i in range(1, first["count"])]
+    return {p["name"]: p for p in params}
+
+
+def lookup(params, name):
+    if name not in params:
+        raise DeviceError("unknown parameter %s, try list" % name)
+    return params[name]["id"]
+
+
+def calibrate(link, poses):
+    for point, (roll, pitch) in enumerate(poses):
+        input("hold the tracker at roll %g, pitch %g and press Enter " % (roll, pitch))
+        link.request(CMD_CALIBRATE, struct.pack("<Bff", point, roll, pitch))
+        # The device averages one sample per sensor pass, ~5 s
+        while link.request(CMD_CALIBRATE, bytes([CALIBRATE_STATUS]))[1] & CAPTURING:
+            time.sleep(0.5)
+    body = link.request(CMD_CALIBRATE, bytes([CALIBRATE_SOLVE]))
+    roll_scale, roll_offset, pitch_scale, pitch_offset = struct.unpack_from("<ffff", body, 2)
+    print("roll  = raw * %.4f %+.3f" % (roll_scale, roll_offset))
+    print("pitch = raw * %.4f %+.3f" % (pitch_scale, pitch_offset))
+    print("saved")
+
+
+def run(link, args):
+    if args.command == "list":
+        for p in table(link).values():
+            print("%-15s %10.4g   [%g .. %g]" % (p["name"], p["value"], p["min"], p["max"]))
+    elif args.command == "get":
+        pid = lookup(table(link), args.name)
+        print("%.6g" % struct.unpack_from("<Bf", link.request(CMD_GET, bytes([pid])))[1])
+    elif args.command == "set":
+        pid = lookup(table(link), args.name)
+        body = link.request(CMD_SET, struct.pack("<Bf", pid, args.value))
+        applied = struct.unpack_from("<Bf", body)[1]
+        print("%s = %.6g%s" % (args.name, applied, "" if abs(applied - args.value) < 1e-6 else " (clamped)"))
+    elif args.command == "save":
+        link.request(CMD_SAVE)
+        print("saved")
+    elif args.command == "defaults":
+        link.request(CMD_DEFAULTS)
+        print("defaults loaded, save to keep them")
+    elif args.command == "calibrate":
+        calibrate(link, [(args.roll1, args.pitch1), (args.roll2, args.pitch2)])
+    elif args.command == "profile":
+        link.send(CMD_PROFILE)
+        time.sleep(0.2)
+        sys.stdout.write(link.port.read(4096).decode("ascii", errors="replace"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True)
+    parser.add_argument("--baud", type=int, default=115200)
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("list", help="all parameters with value and range")
+    sub.add_parser("get").add_argument("name")
+    p = sub.add_parser("set")
+    p.add_argument("name")
+    p.add_argument("value", type=float)
+    sub.add_parser("save", help="write the current values to EEPROM")
+    sub.add_parser("defaults", help="restore the built-in values in RAM")
+    p = sub.add_parser("calibrate", help="two-pose IMU calibration, saved to EEPROM")
+    for name in ("roll1", "pitch1", "roll2", "pitch2"):
+        p.add_argument(name, type=float)
+    sub.add_parser("profile", help="print the status text: I2C device stats, profiler histograms with -D PROFILE")
+    args = parser.parse_args()
+
+    import serial  # pyserial
+    with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+        time.sleep(2)  # opening the port resets the Nano
+        port.reset_input_buffer()
+        try:
+            run(Link(port), args)
+        except DeviceError as e:
+            print("error: %s" % e, file=sys.stderr)
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())